@@ -0,0 +1,100 @@
+// BigNum arithmetic, decimal output and binary serialization across operand sizes. The
+// argument is the number of decimal digits per operand; results are written into a reused
+// BigNum so the timings measure the kernels rather than the allocator.
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+
+#include "bignum.h"
+
+namespace {
+
+std::string randomDigits(size_t count, std::mt19937_64& gen) {
+    std::string s(count, '0');
+    s[0] = static_cast<char>('1' + gen() % 9);
+    for (size_t i = 1; i < count; ++i) {
+        s[i] = static_cast<char>('0' + gen() % 10);
+    }
+    return s;
+}
+
+void setDigitsProcessed(benchmark::State& state) {
+    state.counters["digits/s"] = benchmark::Counter(static_cast<double>(state.range(0)),
+                                                    benchmark::Counter::kIsIterationInvariantRate);
+}
+
+void BM_BigNumAdd(benchmark::State& state) {
+    std::mt19937_64 gen(1);
+    BigNum a(randomDigits(state.range(0), gen)), b(randomDigits(state.range(0), gen));
+    BigNum r = a + b;
+    for (auto _ : state) {
+        r = a + b;
+        benchmark::DoNotOptimize(r);
+    }
+    setDigitsProcessed(state);
+}
+BENCHMARK(BM_BigNumAdd)->RangeMultiplier(10)->Range(100, 1000000);
+
+void BM_BigNumSub(benchmark::State& state) {
+    std::mt19937_64 gen(2);
+    BigNum a(randomDigits(state.range(0), gen)), b(randomDigits(state.range(0) - 1, gen));
+    BigNum r = a - b;
+    for (auto _ : state) {
+        r = a - b;
+        benchmark::DoNotOptimize(r);
+    }
+    setDigitsProcessed(state);
+}
+BENCHMARK(BM_BigNumSub)->RangeMultiplier(10)->Range(100, 1000000);
+
+void BM_BigNumMul(benchmark::State& state) {
+    std::mt19937_64 gen(3);
+    BigNum a(randomDigits(state.range(0), gen)), b(randomDigits(state.range(0), gen));
+    BigNum r = a * b;
+    for (auto _ : state) {
+        r = a * b;
+        benchmark::DoNotOptimize(r);
+    }
+    setDigitsProcessed(state);
+}
+BENCHMARK(BM_BigNumMul)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMicrosecond);
+
+void BM_BigNumToString(benchmark::State& state) {
+    std::mt19937_64 gen(4);
+    BigNum a(randomDigits(state.range(0), gen));
+    for (auto _ : state) {
+        std::string text = a.toString();
+        benchmark::DoNotOptimize(text);
+    }
+    setDigitsProcessed(state);
+}
+BENCHMARK(BM_BigNumToString)->RangeMultiplier(10)->Range(100, 1000000);
+
+void BM_BigNumSerialize(benchmark::State& state) {
+    std::mt19937_64 gen(5);
+    BigNum a(randomDigits(state.range(0), gen));
+    std::string record;
+    for (auto _ : state) {
+        record.clear();
+        a.appendSerialized(record);
+        benchmark::DoNotOptimize(record.data());
+    }
+    setDigitsProcessed(state);
+}
+BENCHMARK(BM_BigNumSerialize)->RangeMultiplier(10)->Range(100, 1000000);
+
+void BM_BigNumDeserialize(benchmark::State& state) {
+    std::mt19937_64 gen(6);
+    std::string record;
+    BigNum(randomDigits(state.range(0), gen)).appendSerialized(record);
+    for (auto _ : state) {
+        BigNum a = BigNum::deserialize(record.data(), record.size());
+        benchmark::DoNotOptimize(a);
+    }
+    setDigitsProcessed(state);
+}
+BENCHMARK(BM_BigNumDeserialize)->RangeMultiplier(10)->Range(100, 1000000);
+
+} // namespace
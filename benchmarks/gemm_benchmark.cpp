@@ -0,0 +1,91 @@
+// Gemm::multiply and MLP training throughput. The GEMM argument is the size n of square
+// n x n operands; the FLOPS counter (2n^3 per product) is what to compare against the
+// core's peak. The reference is the nested std::inner_product formulation the blocked
+// kernel replaces, run against a pre-transposed B so it at least reads both rows in order.
+
+#include <benchmark/benchmark.h>
+
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "gemm.h"
+#include "mlp.h"
+
+namespace {
+
+std::vector<double> randomMatrix(size_t values, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<> dis(-1.0, 1.0);
+    std::vector<double> m(values);
+    for (double& x : m) {
+        x = dis(gen);
+    }
+    return m;
+}
+
+void setFlops(benchmark::State& state, double flopsPerIteration) {
+    state.counters["FLOPS"] = benchmark::Counter(flopsPerIteration, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+void BM_GemmInnerProduct(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto a = randomMatrix(n * n, 1), bt = randomMatrix(n * n, 2);
+    std::vector<double> c(n * n);
+    for (auto _ : state) {
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                c[i * n + j] = std::inner_product(a.begin() + i * n, a.begin() + (i + 1) * n, bt.begin() + j * n, 0.0);
+            }
+        }
+        benchmark::DoNotOptimize(c.data());
+    }
+    setFlops(state, 2.0 * n * n * n);
+}
+BENCHMARK(BM_GemmInnerProduct)->RangeMultiplier(2)->Range(256, 1024)->Unit(benchmark::kMillisecond);
+
+// The second argument is Gemm::simd_level; the portable kernel skips the 4096 size, which
+// alone would take a quarter of a minute per run
+void BM_GemmBlocked(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const int savedLevel = Gemm::simd_level;
+    if (state.range(1) > savedLevel) {
+        state.SkipWithError("kernel not supported on this CPU");
+        return;
+    }
+    const auto a = randomMatrix(n * n, 1), b = randomMatrix(n * n, 2);
+    std::vector<double> c(n * n);
+    Gemm::simd_level = static_cast<int>(state.range(1));
+    for (auto _ : state) {
+        Gemm::multiply(false, false, n, n, n, a.data(), n, b.data(), n, c.data(), n);
+        benchmark::DoNotOptimize(c.data());
+    }
+    Gemm::simd_level = savedLevel;
+    setFlops(state, 2.0 * n * n * n);
+}
+BENCHMARK(BM_GemmBlocked)
+    ->ArgsProduct({{256, 1024}, {0}})
+    ->ArgsProduct({{256, 1024, 4096}, {1, 2}})
+    ->Unit(benchmark::kMillisecond);
+
+// One train_batch step (forward and backward) of a width -> width -> width -> 1 network on
+// a batch of 256 rows; three products per dense layer per step
+void BM_MLPTrainBatch(benchmark::State& state) {
+    const size_t width = static_cast<size_t>(state.range(0));
+    constexpr size_t rows = 256;
+    MLP mlp({width, width, width, 1}, MLP::Activation::ReLU, 0.01, 1);
+    const auto features = randomMatrix(rows * width, 3);
+    std::vector<double> targets(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        targets[r] = features[r * width] > 0 ? 1.0 : 0.0;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mlp.train_batch(features.data(), targets.data(), rows));
+    }
+    // Forward, weight gradient and (except for the first layer) delta product per layer
+    setFlops(state, 2.0 * rows * (width * width * 2 + width) * 3 - 2.0 * rows * width * width);
+    state.SetItemsProcessed(state.iterations() * rows);
+}
+BENCHMARK(BM_MLPTrainBatch)->RangeMultiplier(4)->Range(256, 4096)->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,80 @@
+// ConcurrentHashMap from projects/project1_kv_store on a read-mostly mix: 90% get, 10% put
+// on random keys of a map preloaded with 1M entries. All threads share one map; the single
+// shard variant is the same table behind one reader-writer lock, for comparison.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "concurrent_hash_map.h"
+
+namespace {
+
+constexpr uint64_t KEY_COUNT = 1 << 20;
+
+ConcurrentHashMap<uint64_t, uint64_t>* preload(size_t shards) {
+    auto* map = new ConcurrentHashMap<uint64_t, uint64_t>(shards);
+    for (uint64_t k = 0; k < KEY_COUNT; ++k) {
+        map->put(k, k);
+    }
+    return map;
+}
+
+// Built on first use (by whichever benchmark thread gets there first) and kept for the run
+ConcurrentHashMap<uint64_t, uint64_t>& stripedMap() {
+    static ConcurrentHashMap<uint64_t, uint64_t>* map = preload(256);
+    return *map;
+}
+
+ConcurrentHashMap<uint64_t, uint64_t>& singleLockMap() {
+    static ConcurrentHashMap<uint64_t, uint64_t>* map = preload(1);
+    return *map;
+}
+
+void readMostly(benchmark::State& state, ConcurrentHashMap<uint64_t, uint64_t>& map) {
+    uint64_t rng = 0x9E3779B97F4A7C15ull * (state.thread_index() + 1);
+    for (auto _ : state) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        // Separate bits for the key and the operation, as in kv_store's measureMix
+        const uint64_t key = (rng >> 32) % KEY_COUNT;
+        if (rng % 10 == 0) {
+            map.put(key, rng);
+        } else {
+            benchmark::DoNotOptimize(map.get(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_KvReadMostly(benchmark::State& state) {
+    readMostly(state, stripedMap());
+}
+BENCHMARK(BM_KvReadMostly)->ThreadRange(1, 32)->UseRealTime();
+
+void BM_KvReadMostlySingleLock(benchmark::State& state) {
+    readMostly(state, singleLockMap());
+}
+BENCHMARK(BM_KvReadMostlySingleLock)->ThreadRange(1, 32)->UseRealTime();
+
+// 64 keys per call, one shard lock per shard touched
+void BM_KvMultiGet(benchmark::State& state) {
+    ConcurrentHashMap<uint64_t, uint64_t>& map = stripedMap();
+    std::vector<uint64_t> keys(64);
+    uint64_t rng = 88172645463325252ull;
+    for (auto _ : state) {
+        for (uint64_t& k : keys) {
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            k = rng % KEY_COUNT;
+        }
+        benchmark::DoNotOptimize(map.multi_get(keys));
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(BM_KvMultiGet);
+
+} // namespace
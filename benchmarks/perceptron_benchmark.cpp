@@ -0,0 +1,236 @@
+// Perceptron::predict and Perceptron::train throughput. The argument is the number of input
+// features; each iteration walks a fixed set of random samples so the branch on the
+// prediction does not settle into one outcome. The epoch benchmarks run over a dataset too
+// large for the caches, once as separately allocated rows and once as a contiguous matrix.
+// The dataset stream benchmark reads that kind of dataset back from a file.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dataset.h"
+#include "perceptron.h"
+
+namespace {
+
+constexpr size_t SAMPLES = 256;
+
+std::vector<std::vector<double>> randomSamples(size_t features) {
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<> dis(-1.0, 1.0);
+    std::vector<std::vector<double>> samples(SAMPLES, std::vector<double>(features));
+    for (auto& sample : samples) {
+        for (double& x : sample) {
+            x = dis(gen);
+        }
+    }
+    return samples;
+}
+
+void BM_PerceptronPredict(benchmark::State& state) {
+    const size_t features = static_cast<size_t>(state.range(0));
+    Perceptron p(static_cast<int>(features));
+    const auto samples = randomSamples(features);
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(p.predict(samples[i]));
+        i = (i + 1) % SAMPLES;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PerceptronPredict)->RangeMultiplier(8)->Range(2, 1024);
+
+void BM_PerceptronTrain(benchmark::State& state) {
+    const size_t features = static_cast<size_t>(state.range(0));
+    Perceptron p(static_cast<int>(features));
+    const auto samples = randomSamples(features);
+    size_t i = 0;
+    for (auto _ : state) {
+        // Label by the sign of the first feature: learnable, and errors keep the update path hot
+        p.train(samples[i], samples[i][0] > 0 ? 1 : 0);
+        i = (i + 1) % SAMPLES;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PerceptronTrain)->RangeMultiplier(8)->Range(2, 1024);
+
+// predict_batch over BATCH_ROWS rows per call; the second argument is Perceptron::simd_level
+constexpr size_t BATCH_ROWS = 4096;
+
+template <typename T>
+void BM_PerceptronPredictBatch(benchmark::State& state) {
+    const size_t features = static_cast<size_t>(state.range(0));
+    const int savedLevel = Perceptron::simd_level;
+    if (state.range(1) > savedLevel) {
+        state.SkipWithError("kernel not supported on this CPU");
+        return;
+    }
+    Perceptron p(static_cast<int>(features));
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<T> dis(-1, 1);
+    std::vector<T> matrix(BATCH_ROWS * features);
+    for (T& x : matrix) {
+        x = dis(gen);
+    }
+    std::vector<int> out(BATCH_ROWS);
+
+    Perceptron::simd_level = static_cast<int>(state.range(1));
+    for (auto _ : state) {
+        p.predict_batch(matrix.data(), BATCH_ROWS, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    Perceptron::simd_level = savedLevel;
+    state.SetItemsProcessed(state.iterations() * BATCH_ROWS);
+}
+BENCHMARK_TEMPLATE(BM_PerceptronPredictBatch, double)->ArgsProduct({{8, 64, 512}, {0, 1, 2}});
+BENCHMARK_TEMPLATE(BM_PerceptronPredictBatch, float)->ArgsProduct({{8, 64, 512}, {0, 1, 2}});
+
+// Datasets of about 64 MB of features, whatever the row width
+constexpr size_t DATASET_VALUES = size_t{8} << 20;
+
+// Shuffled online training the way a vector-of-rows dataset is walked: train() per row
+void BM_PerceptronEpochRows(benchmark::State& state) {
+    const size_t features = static_cast<size_t>(state.range(0));
+    const size_t rows = DATASET_VALUES / features;
+    std::mt19937 gen(6);
+    std::uniform_real_distribution<> dis(-1.0, 1.0);
+    std::vector<std::vector<double>> samples(rows, std::vector<double>(features));
+    std::vector<int> targets(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        for (double& x : samples[r]) {
+            x = dis(gen);
+        }
+        targets[r] = samples[r][0] > 0 ? 1 : 0;
+    }
+    std::vector<size_t> order(rows);
+    std::iota(order.begin(), order.end(), size_t{0});
+
+    Perceptron p(static_cast<int>(features));
+    for (auto _ : state) {
+        std::shuffle(order.begin(), order.end(), gen);
+        for (size_t r : order) {
+            p.train(samples[r], targets[r]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+}
+BENCHMARK(BM_PerceptronEpochRows)->RangeMultiplier(8)->Range(8, 512)->Unit(benchmark::kMillisecond);
+
+// The same epoch through train_epoch over one row-major matrix; the second argument is the
+// mini-batch size
+void BM_PerceptronEpochMatrix(benchmark::State& state) {
+    const size_t features = static_cast<size_t>(state.range(0));
+    const size_t rows = DATASET_VALUES / features;
+    std::mt19937 gen(6);
+    std::uniform_real_distribution<> dis(-1.0, 1.0);
+    std::vector<double> matrix(rows * features);
+    std::vector<int> targets(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t i = 0; i < features; ++i) {
+            matrix[r * features + i] = dis(gen);
+        }
+        targets[r] = matrix[r * features] > 0 ? 1 : 0;
+    }
+
+    Perceptron p(static_cast<int>(features));
+    for (auto _ : state) {
+        p.train_epoch(matrix.data(), targets.data(), rows, static_cast<size_t>(state.range(1)), gen);
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+}
+BENCHMARK(BM_PerceptronEpochMatrix)
+    ->ArgsProduct({{8, 64, 512}, {1, 64}})
+    ->Unit(benchmark::kMillisecond);
+
+// One Hogwild epoch over a separable 256k x 32 dataset; the argument is the number of worker
+// threads. The accuracy counter is measured after the last epoch, so rows that scale in
+// throughput can be checked for not paying for it in convergence.
+void BM_PerceptronHogwild(benchmark::State& state) {
+    constexpr size_t rows = size_t{1} << 18;
+    constexpr size_t features = 32;
+    std::mt19937 gen(8);
+    std::normal_distribution<> dis(0.0, 1.0);
+    std::vector<double> matrix(rows * features);
+    std::vector<int> targets(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        double sum = 0.0;
+        for (size_t i = 0; i < features; ++i) {
+            matrix[r * features + i] = dis(gen);
+            sum += matrix[r * features + i] * (i % 2 ? 1.0 : -0.5);
+        }
+        targets[r] = sum >= 0 ? 1 : 0;
+    }
+
+    Perceptron p(static_cast<int>(features));
+    unsigned epoch = 0;
+    for (auto _ : state) {
+        p.train_hogwild(matrix.data(), targets.data(), rows, 1, static_cast<unsigned>(state.range(0)), epoch++);
+    }
+
+    std::vector<int> predictions(rows);
+    p.predict_batch(matrix.data(), rows, predictions.data());
+    size_t correct = 0;
+    for (size_t r = 0; r < rows; ++r) {
+        correct += (predictions[r] == targets[r]) ? 1 : 0;
+    }
+    state.counters["accuracy"] = static_cast<double>(correct) / rows;
+    state.SetItemsProcessed(state.iterations() * rows);
+}
+BENCHMARK(BM_PerceptronHogwild)->RangeMultiplier(2)->Range(1, 32)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Streams a 256k x 32 dataset (64 MB as doubles) through DatasetStream from a file in the
+// page cache and only sums the features, so the rate is about what the reader can feed a
+// trainer. The argument picks the format: 0 for the mapped binary file, 1 for CSV.
+void BM_DatasetStream(benchmark::State& state) {
+    constexpr size_t rows = size_t{1} << 18;
+    constexpr size_t features = 32;
+    const bool csv = state.range(0) == 1;
+    std::mt19937 gen(9);
+    std::normal_distribution<> dis(0.0, 1.0);
+    std::vector<double> matrix(rows * features);
+    std::vector<int> targets(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t i = 0; i < features; ++i) {
+            matrix[r * features + i] = dis(gen);
+        }
+        targets[r] = matrix[r * features] > 0 ? 1 : 0;
+    }
+    const std::string path =
+        std::filesystem::temp_directory_path().string() + (csv ? "/bm_dataset_stream.csv" : "/bm_dataset_stream.bin");
+    if (csv) {
+        CsvDataset::write(path, matrix.data(), targets.data(), rows, features);
+    } else {
+        MappedDataset::write(path, matrix.data(), targets.data(), rows, features);
+    }
+
+    for (auto _ : state) {
+        // Opening the file is part of each pass, as it would be for an epoch
+        if (csv) {
+            CsvDataset data(path, features, 1 << 14);
+            DatasetStream stream([&data](DatasetChunk& c) { return data.read_chunk(c); });
+            while (const DatasetChunk* chunk = stream.next()) {
+                const double* end = chunk->features + chunk->rows * features;
+                benchmark::DoNotOptimize(std::accumulate(chunk->features, end, 0.0));
+            }
+        } else {
+            MappedDataset data(path, 1 << 14);
+            DatasetStream stream([&data](DatasetChunk& c) { return data.read_chunk(c); });
+            while (const DatasetChunk* chunk = stream.next()) {
+                const double* end = chunk->features + chunk->rows * features;
+                benchmark::DoNotOptimize(std::accumulate(chunk->features, end, 0.0));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(std::filesystem::file_size(path)));
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_DatasetStream)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+} // namespace
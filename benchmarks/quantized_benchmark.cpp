@@ -0,0 +1,85 @@
+// Int8 inference against the double-precision models it was quantized from. Each pair of
+// benchmarks scores the same rows; the perceptron ones take the kernel level as their
+// second argument (Int8Dot::simd_level for int8, Perceptron::simd_level for double).
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "mlp.h"
+#include "perceptron.h"
+#include "quantized.h"
+
+namespace {
+
+constexpr size_t BATCH_ROWS = 4096;
+
+std::vector<double> randomFeatures(size_t values) {
+    std::mt19937 gen(11);
+    std::normal_distribution<> dis(0.0, 1.0);
+    std::vector<double> features(values);
+    for (double& x : features) {
+        x = dis(gen);
+    }
+    return features;
+}
+
+void BM_QuantizedPerceptronPredict(benchmark::State& state) {
+    const size_t features = static_cast<size_t>(state.range(0));
+    const int savedLevel = Int8Dot::simd_level;
+    if (state.range(1) > savedLevel) {
+        state.SkipWithError("kernel not supported on this CPU");
+        return;
+    }
+    const auto x = randomFeatures(BATCH_ROWS * features);
+    Perceptron p(static_cast<int>(features));
+    QuantizedPerceptron q(p, x.data(), BATCH_ROWS);
+    std::vector<int8_t> xq(x.size());
+    q.quantize_inputs(x.data(), BATCH_ROWS, xq.data());
+    std::vector<int> out(BATCH_ROWS);
+
+    Int8Dot::simd_level = static_cast<int>(state.range(1));
+    for (auto _ : state) {
+        q.predict_batch(xq.data(), BATCH_ROWS, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    Int8Dot::simd_level = savedLevel;
+    state.SetItemsProcessed(state.iterations() * BATCH_ROWS);
+}
+BENCHMARK(BM_QuantizedPerceptronPredict)->ArgsProduct({{64, 512}, {0, 1, 2}});
+
+// Rows of width -> width -> width -> 1 networks, 256 rows per call
+void BM_MLPPredict(benchmark::State& state) {
+    const size_t width = static_cast<size_t>(state.range(0));
+    constexpr size_t rows = 256;
+    MLP mlp({width, width, width, 1}, MLP::Activation::ReLU, 0.01, 1);
+    const auto x = randomFeatures(rows * width);
+    std::vector<double> out(rows);
+    for (auto _ : state) {
+        mlp.predict_batch(x.data(), rows, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+}
+BENCHMARK(BM_MLPPredict)->RangeMultiplier(4)->Range(256, 1024)->Unit(benchmark::kMicrosecond);
+
+void BM_QuantizedMLPPredict(benchmark::State& state) {
+    const size_t width = static_cast<size_t>(state.range(0));
+    constexpr size_t rows = 256;
+    MLP mlp({width, width, width, 1}, MLP::Activation::ReLU, 0.01, 1);
+    const auto x = randomFeatures(rows * width);
+    QuantizedMLP q(mlp, x.data(), rows);
+    std::vector<int8_t> xq(x.size());
+    q.quantize_inputs(x.data(), rows, xq.data());
+    std::vector<double> out(rows);
+    for (auto _ : state) {
+        q.predict_batch(xq.data(), rows, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+}
+BENCHMARK(BM_QuantizedMLPPredict)->RangeMultiplier(4)->Range(256, 1024)->Unit(benchmark::kMicrosecond);
+
+} // namespace
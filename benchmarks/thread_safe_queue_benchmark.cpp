@@ -0,0 +1,169 @@
+// ThreadSafeQueue throughput across thread counts, next to the lock-free BoundedMpmcQueue
+// and the wait-free SpscQueue from cpp_concurrency/chapter_07_lock_free. Google Benchmark
+// runs the body on every thread at once, each for the same number of iterations, against
+// one shared queue.
+
+#include <benchmark/benchmark.h>
+
+#include <thread>
+#include <vector>
+
+#include "bounded_mpmc_queue.h"
+#include "spsc_queue.h"
+#include "thread_safe_queue.h"
+
+namespace {
+
+ThreadSafeQueue<int> sharedQueue;
+BoundedMpmcQueue<int> sharedRing(1024);
+SpscQueue<int> sharedSpsc(1024);
+SpscQueue<int, true> sharedBlockingSpsc(1024);
+
+// Every thread pushes one item and pops one, so the queue stays short and the cost is the
+// lock hand-off between threads
+void BM_QueuePushPop(benchmark::State& state) {
+    int value = 0;
+    for (auto _ : state) {
+        sharedQueue.push(value);
+        sharedQueue.try_pop(value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_QueuePushPop)->ThreadRange(1, 8)->UseRealTime();
+
+// Half the threads produce and half consume with wait_and_pop. Both halves run the same
+// number of iterations, so every consumer is eventually fed and the queue ends empty.
+void BM_QueueProducerConsumer(benchmark::State& state) {
+    const bool producer = (state.thread_index() % 2 == 0);
+    int value = 0;
+    for (auto _ : state) {
+        if (producer) {
+            sharedQueue.push(value);
+        } else {
+            sharedQueue.wait_and_pop(value);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_QueueProducerConsumer)->ThreadRange(2, 8)->UseRealTime();
+
+// The producer/consumer pattern moving 64 items per lock with push_bulk and pop_up_to, so
+// the lock hand-offs and wakeups are paid once per batch rather than once per item
+void BM_QueueBulkProducerConsumer(benchmark::State& state) {
+    constexpr size_t BATCH = 64;
+    const bool producer = (state.thread_index() % 2 == 0);
+    std::vector<int> batch(BATCH);
+    for (auto _ : state) {
+        if (producer) {
+            sharedQueue.push_bulk(batch.begin(), batch.end());
+        } else {
+            // A consumer may get a partial batch; it keeps popping until it has a full one
+            batch.clear();
+            while (batch.size() < BATCH) {
+                sharedQueue.pop_up_to(batch, BATCH - batch.size());
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * BATCH);
+}
+BENCHMARK(BM_QueueBulkProducerConsumer)->ThreadRange(2, 8)->UseRealTime();
+
+// The same two patterns on the lock-free ring. Its 1024 slots never fill here: each thread
+// holds at most one item at a time in the first, and consumers keep up in the second.
+void BM_MpmcPushPop(benchmark::State& state) {
+    int value = 0;
+    for (auto _ : state) {
+        sharedRing.push(value);
+        sharedRing.try_pop(value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MpmcPushPop)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_MpmcProducerConsumer(benchmark::State& state) {
+    const bool producer = (state.thread_index() % 2 == 0);
+    int value = 0;
+    for (auto _ : state) {
+        if (producer) {
+            sharedRing.push(value);
+        } else {
+            sharedRing.wait_and_pop(value);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MpmcProducerConsumer)->ThreadRange(2, 8)->UseRealTime();
+
+// The single producer, single consumer case. With one thread the cost is a push and a pop
+// with no contention at all; with two, thread 0 produces and thread 1 consumes.
+template<typename Queue>
+void BM_SpscPushPop(benchmark::State& state, Queue& queue) {
+    int value = 0;
+    for (auto _ : state) {
+        queue.push(value);
+        queue.try_pop(value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_CAPTURE(BM_SpscPushPop, spinning, sharedSpsc);
+BENCHMARK_CAPTURE(BM_SpscPushPop, futex, sharedBlockingSpsc);
+
+template<typename Queue>
+void BM_SpscProducerConsumer(benchmark::State& state, Queue& queue) {
+    const bool producer = (state.thread_index() == 0);
+    int value = 0;
+    for (auto _ : state) {
+        if (producer) {
+            queue.push(value);
+        } else {
+            queue.wait_and_pop(value);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_CAPTURE(BM_SpscProducerConsumer, spinning, sharedSpsc)->Threads(2)->UseRealTime();
+BENCHMARK_CAPTURE(BM_SpscProducerConsumer, futex, sharedBlockingSpsc)->Threads(2)->UseRealTime();
+
+// Cross-thread latency: every iteration sends a value to an echo thread through one queue
+// and waits for it to come back through another, so the time per iteration is two hops.
+// hop_time is reported in seconds per hop. The echo thread stops when it is sent -1.
+template<typename Queue>
+void pingPong(benchmark::State& state, Queue& ping, Queue& pong) {
+    std::thread echo([&ping, &pong] {
+        int value = 0;
+        while (value >= 0) {
+            ping.wait_and_pop(value);
+            pong.push(value);
+        }
+    });
+    int value = 0;
+    for (auto _ : state) {
+        ping.push(value);
+        pong.wait_and_pop(value);
+    }
+    ping.push(-1);
+    pong.wait_and_pop(value);
+    echo.join();
+    state.counters["hop_time"] = benchmark::Counter(2.0 * state.iterations(),
+                                                      benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+void BM_QueuePingPong(benchmark::State& state) {
+    ThreadSafeQueue<int> ping, pong;
+    pingPong(state, ping, pong);
+}
+BENCHMARK(BM_QueuePingPong)->UseRealTime();
+
+void BM_SpscPingPong(benchmark::State& state) {
+    SpscQueue<int> ping(16), pong(16);
+    pingPong(state, ping, pong);
+}
+BENCHMARK(BM_SpscPingPong)->UseRealTime();
+
+void BM_BlockingSpscPingPong(benchmark::State& state) {
+    SpscQueue<int, true> ping(16), pong(16);
+    pingPong(state, ping, pong);
+}
+BENCHMARK(BM_BlockingSpscPingPong)->UseRealTime();
+
+} // namespace
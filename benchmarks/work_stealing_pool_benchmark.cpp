@@ -0,0 +1,62 @@
+// WorkStealingPool from cpp_concurrency/chapter_08_concurrent_design. The submit benchmarks
+// measure the cost of one task round trip from outside the pool, against starting a thread
+// per task. The fork-join benchmark sums a vector by recursive splitting; its argument is
+// the number of workers.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <future>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "work_stealing_pool.h"
+
+namespace {
+
+void BM_PoolSubmitGet(benchmark::State& state) {
+    WorkStealingPool pool(1);
+    uint64_t sum = 0;
+    for (auto _ : state) {
+        sum += pool.submit([](uint64_t n) { return n + 1; }, sum).get();
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PoolSubmitGet)->UseRealTime();
+
+void BM_ThreadPerTask(benchmark::State& state) {
+    uint64_t sum = 0;
+    for (auto _ : state) {
+        std::thread t([&sum] { sum += 1; });
+        t.join();
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ThreadPerTask)->UseRealTime();
+
+uint64_t forkJoinSum(WorkStealingPool& pool, const uint32_t* first, const uint32_t* last) {
+    if (last - first <= 16384) {
+        return std::accumulate(first, last, uint64_t{0});
+    }
+    const uint32_t* middle = first + (last - first) / 2;
+    std::future<uint64_t> lower = pool.submit([&pool, first, middle] { return forkJoinSum(pool, first, middle); });
+    const uint64_t upper = forkJoinSum(pool, middle, last);
+    return pool.wait(lower) + upper;
+}
+
+void BM_PoolForkJoinSum(benchmark::State& state) {
+    WorkStealingPool pool(static_cast<size_t>(state.range(0)));
+    std::vector<uint32_t> values(1 << 22, 1);
+    for (auto _ : state) {
+        std::future<uint64_t> sum = pool.submit(
+            [&pool, &values] { return forkJoinSum(pool, values.data(), values.data() + values.size()); });
+        benchmark::DoNotOptimize(sum.get());
+    }
+    state.SetBytesProcessed(state.iterations() * values.size() * sizeof(uint32_t));
+}
+BENCHMARK(BM_PoolForkJoinSum)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+
+} // namespace
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+/**
+ * A bounded multi-producer, multi-consumer queue that never takes a lock, with the same
+ * push / try_pop / wait_and_pop interface as ThreadSafeQueue.
+ *
+ * This is Dmitry Vyukov's ring buffer. Every slot carries a sequence number that says
+ * whose turn it is:
+ *   - sequence == position       the slot is empty and the producer claiming position may fill it
+ *   - sequence == position + 1   the slot is full and the consumer claiming position may empty it
+ * A producer claims a position by advancing `head` with one compare-and-swap, writes the
+ * value, then publishes it by storing position + 1 into the slot's sequence (release). A
+ * consumer does the mirror image on `tail` and hands the slot back for the next lap by
+ * storing position + capacity. Producers and consumers only ever contend on their own
+ * counter, and two threads only touch the same slot when one hands it to the other.
+ *
+ * head, tail and every slot sit on their own cache line, so a producer bumping head does
+ * not invalidate the line consumers are reading tail from, and neighbouring slots being
+ * filled and emptied by different threads do not false-share.
+ *
+ * The capacity is rounded up to a power of two (at least 2) so a position maps to its slot with a mask.
+ * Being bounded, push() waits while the queue is full; try_push() does not.
+ *
+ * T must be nothrow move constructible and move assignable. A position is claimed before
+ * the value is moved in or out, and only the move's completion publishes the slot, so a
+ * move that threw would leave every later thread spinning on that slot for good.
+ */
+template<typename T>
+class BoundedMpmcQueue {
+    static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>,
+                  "BoundedMpmcQueue publishes a slot only after the move, so moves must not throw");
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct alignas(CACHE_LINE) Slot {
+        std::atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)]; // Holds a T only while the slot is full
+
+        T* value() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+
+    // Next position to push to and to pop from, each on its own cache line
+    alignas(CACHE_LINE) std::atomic<size_t> head{0};
+    alignas(CACHE_LINE) std::atomic<size_t> tail{0};
+
+    // Waiting for another thread: spin briefly, then give up the core so the thread we
+    // are waiting for can run even when there are more threads than cores
+    static void backoff(unsigned& attempt) {
+        if (++attempt < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+public:
+    explicit BoundedMpmcQueue(size_t capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("BoundedMpmcQueue needs a capacity of at least 1");
+        }
+        // With a single slot, "full for this lap" and "empty for the next" would be the
+        // same sequence number, so there are always at least two
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots.reset(new Slot[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~BoundedMpmcQueue() {
+        // Destroy whatever is still queued; no other thread may use the queue by now
+        const size_t end = head.load(std::memory_order_relaxed);
+        for (size_t position = tail.load(std::memory_order_relaxed); position != end; ++position) {
+            slots[position & mask].value()->~T();
+        }
+    }
+
+    BoundedMpmcQueue(const BoundedMpmcQueue&) = delete;
+    BoundedMpmcQueue& operator=(const BoundedMpmcQueue&) = delete;
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+    // Add an element if there is room
+    // Returns true if successful, false if the queue was full
+    bool try_push(T value) {
+        return try_push_from(value);
+    }
+
+    // Add an element, waiting while the queue is full
+    void push(T value) {
+        unsigned attempt = 0;
+        while (!try_push_from(value)) {
+            backoff(attempt);
+        }
+    }
+
+    // Try to pop an element from the queue
+    // Returns true if successful, false if queue was empty
+    bool try_pop(T& value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[position & mask];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const ptrdiff_t lag = static_cast<ptrdiff_t>(sequence - (position + 1));
+            if (lag == 0) {
+                // The slot holds this lap's value; claim the position
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    T* stored = slot.value();
+                    value = std::move(*stored);
+                    stored->~T();
+                    // Hand the slot to the producer of the next lap
+                    slot.sequence.store(position + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false; // Not filled yet: empty
+            } else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Wait until an element is available and then pop it
+    // There is no lock to sleep on, so this spins and then yields between attempts
+    void wait_and_pop(T& value) {
+        unsigned attempt = 0;
+        while (!try_pop(value)) {
+            backoff(attempt);
+        }
+    }
+
+    // Check if the queue is empty
+    // Only a snapshot: other threads may push or pop right after it is taken
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    // Moves value in if there is room and leaves it untouched if not, so push() can retry
+    bool try_push_from(T& value) {
+        size_t position = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[position & mask];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const ptrdiff_t lag = static_cast<ptrdiff_t>(sequence - position);
+            if (lag == 0) {
+                // The slot is free for this lap; claim the position
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    new (slot.storage) T(std::move(value));
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+                // Another producer took it; position now holds the current head
+            } else if (lag < 0) {
+                return false; // The slot still holds last lap's value: full
+            } else {
+                position = head.load(std::memory_order_relaxed); // We fell behind; catch up
+            }
+        }
+    }
+};
@@ -1,9 +1,400 @@
 // chapter 07 lock free - C++ Concurrency in Action
-// Start your code for this chapter here
+// A bounded lock-free MPMC queue (bounded_mpmc_queue.h) and a wait-free SPSC queue
+// (spsc_queue.h), stress-tested and raced against the mutex-based ThreadSafeQueue from playing/,
+// whose close(), bulk and timed pops are checked here too
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "bounded_mpmc_queue.h"
+#include "spsc_queue.h"
+#include "thread_safe_queue.h"
+
+// Producers push (producer id, sequence number) pairs through a small queue so it wraps and
+// fills constantly; consumers record what they pop. Passes when every value arrives exactly
+// once and each consumer sees each producer's values in the order they were pushed.
+bool runStressTest(int producers, int consumers, uint32_t items_per_producer, size_t capacity) {
+    BoundedMpmcQueue<uint64_t> queue(capacity);
+    std::vector<std::vector<uint64_t>> popped(consumers);
+    std::atomic<uint64_t> remaining(uint64_t{items_per_producer} * producers);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, p, items_per_producer] {
+            for (uint32_t i = 0; i < items_per_producer; ++i) {
+                queue.push((uint64_t(p) << 32) | i);
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&queue, &popped, &remaining, c] {
+            uint64_t value;
+            while (remaining.load(std::memory_order_relaxed) > 0) {
+                if (queue.try_pop(value)) {
+                    popped[c].push_back(value);
+                    remaining.fetch_sub(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    std::vector<uint32_t> seen(uint64_t{items_per_producer} * producers, 0);
+    bool ok = queue.empty();
+    for (const std::vector<uint64_t>& values : popped) {
+        std::vector<int64_t> last(producers, -1);
+        for (uint64_t value : values) {
+            const uint32_t producer = static_cast<uint32_t>(value >> 32), index = static_cast<uint32_t>(value);
+            ok = ok && producer < static_cast<uint32_t>(producers) && index < items_per_producer &&
+                 static_cast<int64_t>(index) > last[producer];
+            if (!ok) {
+                return false;
+            }
+            last[producer] = index;
+            ++seen[uint64_t{producer} * items_per_producer + index];
+        }
+    }
+    return ok && std::all_of(seen.begin(), seen.end(), [](uint32_t n) { return n == 1; });
+}
+
+// Move-only values must be moved in and out, and whatever is left in the queue when it is
+// destroyed must be destroyed with it (run under ASan to see a leak)
+bool runMoveOnlyTest() {
+    BoundedMpmcQueue<std::unique_ptr<std::string>> queue(3);
+    bool ok = queue.capacity() == 4 && BoundedMpmcQueue<int>(1).capacity() == 2;
+    for (int i = 0; i < 4; ++i) {
+        ok = ok && queue.try_push(std::make_unique<std::string>(std::to_string(i)));
+    }
+    ok = ok && !queue.try_push(std::make_unique<std::string>("full"));
+    std::unique_ptr<std::string> value;
+    ok = ok && queue.try_pop(value) && *value == "0";
+    queue.push(std::make_unique<std::string>("4"));
+    return ok; // Four strings are still queued
+}
+
+// One producer pushes 0..items-1 and one consumer checks they come out in exactly that order
+template<bool Blocking>
+bool runSpscTest(uint32_t items, size_t capacity) {
+    SpscQueue<uint32_t, Blocking> queue(capacity);
+    bool in_order = true;
+    std::thread consumer([&queue, &in_order, items] {
+        uint32_t value;
+        for (uint32_t i = 0; i < items; ++i) {
+            queue.wait_and_pop(value);
+            in_order = in_order && value == i;
+        }
+    });
+    for (uint32_t i = 0; i < items; ++i) {
+        queue.push(i);
+    }
+    consumer.join();
+    return in_order && queue.empty();
+}
+
+bool runSpscMoveOnlyTest() {
+    SpscQueue<std::unique_ptr<std::string>> queue(3);
+    bool ok = queue.capacity() == 4 && SpscQueue<int>(1).capacity() == 1;
+    for (int i = 0; i < 4; ++i) {
+        ok = ok && queue.try_push(std::make_unique<std::string>(std::to_string(i)));
+    }
+    ok = ok && !queue.try_push(std::make_unique<std::string>("full"));
+    std::unique_ptr<std::string> value;
+    ok = ok && queue.try_pop(value) && *value == "0";
+    queue.push(std::make_unique<std::string>("4"));
+    return ok; // Four strings are still queued
+}
+
+// Items per second moved through a queue by `pairs` producers and as many consumers
+// The closable, batched side of ThreadSafeQueue that the lock-free queues do not have:
+// close(), push_bulk, try_pop_bulk, pop_up_to and wait_and_pop_for. Returns how many of the
+// CLOSABLE_CHECKS checks pass.
+constexpr int CLOSABLE_CHECKS = 8;
+
+// Runs pop on another thread; if it is still blocked after a second, closes the queue to
+// release it and reports failure
+template<typename Pop>
+bool returnsPromptly(ThreadSafeQueue<int>& queue, Pop pop) {
+    std::atomic<bool> done(false);
+    bool result = false;
+    std::thread caller([&] {
+        result = pop();
+        done = true;
+    });
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (!done && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const bool prompt = done;
+    queue.close();
+    caller.join();
+    return prompt && result;
+}
+
+// Starts pop on another thread against an empty queue, closes the queue once the caller
+// has had time to block, and checks that close() woke it with pop's result
+template<typename Pop>
+bool closeWakes(Pop pop) {
+    ThreadSafeQueue<int> queue;
+    bool result = false;
+    std::thread waiter([&] { result = pop(queue); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.close();
+    waiter.join();
+    return result;
+}
+
+int runClosableQueueTest() {
+    int passed = 0;
+    std::vector<int> out;
+
+    // 1. pop_up_to with max_count 0 has nothing to wait for
+    {
+        ThreadSafeQueue<int> queue;
+        passed += returnsPromptly(queue, [&] { return queue.pop_up_to(out, 0) == 0 && out.empty(); }) ? 1 : 0;
+    }
+    // 2-3. close() wakes consumers blocked on an empty queue, and they come back empty-handed
+    passed += closeWakes([](ThreadSafeQueue<int>& q) { int v; return !q.wait_and_pop(v); }) ? 1 : 0;
+    passed += closeWakes([](ThreadSafeQueue<int>& q) { std::vector<int> got; return q.pop_up_to(got, 8) == 0; }) ? 1 : 0;
+    // 4. A closed queue refuses new elements, one at a time or in bulk
+    {
+        ThreadSafeQueue<int> queue;
+        queue.close();
+        std::vector<int> batch = {1, 2, 3};
+        passed += (!queue.push(1) && queue.push_bulk(batch.begin(), batch.end()) == 0 && queue.empty() &&
+                   queue.is_closed()) ? 1 : 0;
+    }
+    // 5. Elements queued before close() are still delivered, in order, before the pops give up
+    {
+        ThreadSafeQueue<int> queue;
+        std::vector<int> batch = {0, 1, 2, 3, 4, 5, 6};
+        queue.push_bulk(batch.begin(), batch.end());
+        queue.close();
+        int v = -1;
+        bool ok = queue.wait_and_pop(v) && v == 0;
+        out.clear();
+        ok = ok && queue.pop_up_to(out, 4) == 4 && queue.pop_up_to(out, 4) == 2 && queue.pop_up_to(out, 4) == 0;
+        ok = ok && out == std::vector<int>({1, 2, 3, 4, 5, 6}) && !queue.wait_and_pop(v);
+        passed += ok ? 1 : 0;
+    }
+    // 6. try_pop_bulk takes at most max_count and never waits
+    {
+        ThreadSafeQueue<int> queue;
+        std::vector<int> batch = {0, 1, 2, 3, 4};
+        queue.push_bulk(batch.begin(), batch.end());
+        out.clear();
+        bool ok = queue.try_pop_bulk(out, 3) == 3 && queue.try_pop_bulk(out, 3) == 2;
+        ok = ok && queue.try_pop_bulk(out, 3) == 0 && out == std::vector<int>({0, 1, 2, 3, 4});
+        passed += ok ? 1 : 0;
+    }
+    // 7. wait_and_pop_for gives up after its timeout, and returns a value pushed in time
+    {
+        ThreadSafeQueue<int> queue;
+        int v = -1;
+        const auto start = std::chrono::steady_clock::now();
+        bool ok = !queue.wait_and_pop_for(v, std::chrono::milliseconds(20));
+        ok = ok && std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20);
+        std::thread pusher([&queue] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            queue.push(42);
+        });
+        ok = ok && queue.wait_and_pop_for(v, std::chrono::seconds(5)) && v == 42;
+        pusher.join();
+        passed += ok ? 1 : 0;
+    }
+    // 8. Batched producers and consumers: consumers drain with pop_up_to until close() and an
+    // empty queue stop them, and every value arrives exactly once
+    {
+        ThreadSafeQueue<int> queue;
+        const int producers = 4, consumers = 3, batches = 500, batch_size = 16;
+        std::vector<std::vector<int>> popped(consumers);
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&queue, p] {
+                std::vector<int> batch(batch_size);
+                for (int b = 0; b < batches; ++b) {
+                    for (int i = 0; i < batch_size; ++i) {
+                        batch[i] = (p * batches + b) * batch_size + i;
+                    }
+                    queue.push_bulk(batch.begin(), batch.end());
+                }
+            });
+        }
+        for (int c = 0; c < consumers; ++c) {
+            threads.emplace_back([&queue, &popped, c] {
+                while (queue.pop_up_to(popped[c], 64) > 0) {
+                }
+            });
+        }
+        for (int p = 0; p < producers; ++p) {
+            threads[p].join();
+        }
+        queue.close();
+        for (int c = 0; c < consumers; ++c) {
+            threads[producers + c].join();
+        }
+        std::vector<int> seen(producers * batches * batch_size, 0);
+        bool ok = true;
+        for (const std::vector<int>& values : popped) {
+            for (int value : values) {
+                ok = ok && value >= 0 && value < static_cast<int>(seen.size()) && seen[value]++ == 0;
+            }
+        }
+        ok = ok && std::count(seen.begin(), seen.end(), 1) == static_cast<long>(seen.size());
+        passed += ok ? 1 : 0;
+    }
+    return passed;
+}
+
+template<typename Queue>
+double measureThroughput(Queue& queue, int pairs, int items_per_producer) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < pairs; ++i) {
+        threads.emplace_back([&queue, items_per_producer] {
+            for (int n = 0; n < items_per_producer; ++n) {
+                queue.push(n);
+            }
+        });
+        threads.emplace_back([&queue, items_per_producer] {
+            int value;
+            for (int n = 0; n < items_per_producer; ++n) {
+                queue.wait_and_pop(value);
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return pairs * items_per_producer / seconds;
+}
+
+// Blocking pop for any of the queues. ThreadSafeQueue's wait_and_pop returns false once the
+// queue is closed and empty; the lock-free queues cannot be closed, so their pop always
+// delivers.
+template<typename Queue>
+bool popWaiting(Queue& queue, int& value) {
+    if constexpr (std::is_same_v<decltype(queue.wait_and_pop(value)), bool>) {
+        return queue.wait_and_pop(value);
+    } else {
+        queue.wait_and_pop(value);
+        return true;
+    }
+}
+
+// Nanoseconds for one hop between two threads: a value is bounced back and forth through
+// a pair of queues and the round trip is halved. Returns -1 if a pop failed or a round
+// came back with the wrong value.
+template<typename Queue>
+double measureHopLatency(Queue& ping, Queue& pong, int rounds) {
+    std::atomic<bool> ok(true);
+    std::thread echo([&ping, &pong, &ok, rounds] {
+        int value = 0;
+        for (int n = 0; n < rounds; ++n) {
+            // On a failed pop the stale value still goes back, so neither thread is left waiting
+            if (!popWaiting(ping, value)) {
+                ok = false;
+            }
+            pong.push(value);
+        }
+    });
+    auto start = std::chrono::steady_clock::now();
+    int value = 0;
+    bool echoed = true;
+    for (int n = 0; n < rounds; ++n) {
+        ping.push(n);
+        echoed = popWaiting(pong, value) && value == n && echoed;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    echo.join();
+    return ok && echoed ? seconds * 1e9 / (2.0 * rounds) : -1.0;
+}
+
+// One row of the hop table; a failed latency run is reported rather than printed as -1
+void printHopRow(const char* name, double rate, double hop_ns) {
+    std::cout << std::left << std::setw(20) << name << std::right << std::setw(12) << static_cast<long long>(rate);
+    if (hop_ns < 0) {
+        std::cout << std::setw(14) << "FAILED" << std::endl;
+    } else {
+        std::cout << std::setw(14) << static_cast<long long>(hop_ns) << std::endl;
+    }
+}
 
 int main() {
-    std::cout << "Hello from chapter_07_lock_free" << std::endl;
+    std::cout << "--- Stress Test ---" << std::endl;
+    const int configs[][3] = {{1, 1, 1}, {1, 4, 2}, {4, 1, 2}, {4, 4, 8}, {8, 8, 64}, {16, 16, 1024}};
+    int passed = 0;
+    for (const auto& config : configs) {
+        passed += runStressTest(config[0], config[1], 20000, config[2]) ? 1 : 0;
+    }
+    const int runs = sizeof(configs) / sizeof(configs[0]);
+    std::cout << passed << "/" << runs << " producer/consumer mixes deliver every value exactly once, in order"
+              << std::endl;
+    std::cout << "Move-only values: " << (runMoveOnlyTest() ? "ok" : "FAILED") << std::endl;
+    std::cout << "\n--- ThreadSafeQueue: close, bulk and timed pops ---" << std::endl;
+    std::cout << runClosableQueueTest() << "/" << CLOSABLE_CHECKS
+              << " ThreadSafeQueue close, bulk and timeout checks pass" << std::endl;
+
+    std::cout << "\n--- Throughput (items/s, producers = consumers) ---" << std::endl;
+    std::cout << std::left << std::setw(10) << "threads" << std::right << std::setw(18) << "ThreadSafeQueue"
+              << std::setw(18) << "BoundedMpmcQueue" << std::endl;
+    const int items = 200000;
+    for (int pairs = 1; pairs <= 16; pairs *= 2) {
+        ThreadSafeQueue<int> locked;
+        BoundedMpmcQueue<int> lock_free(1024);
+        const double locked_rate = measureThroughput(locked, pairs, items);
+        const double lock_free_rate = measureThroughput(lock_free, pairs, items);
+        std::cout << std::left << std::setw(10) << 2 * pairs << std::right << std::setw(18)
+                  << static_cast<long long>(locked_rate) << std::setw(18) << static_cast<long long>(lock_free_rate)
+                  << std::endl;
+    }
+
+    std::cout << "\n--- Single producer, single consumer ---" << std::endl;
+    const size_t capacities[] = {1, 2, 64, 1024};
+    int spsc_passed = 0;
+    for (size_t capacity : capacities) {
+        spsc_passed += runSpscTest<false>(200000, capacity) ? 1 : 0;
+        spsc_passed += runSpscTest<true>(200000, capacity) ? 1 : 0;
+    }
+    std::cout << spsc_passed << "/" << 2 * sizeof(capacities) / sizeof(capacities[0])
+              << " capacities (spinning and futex pop) deliver every value in order" << std::endl;
+    std::cout << "Move-only values: " << (runSpscMoveOnlyTest() ? "ok" : "FAILED") << std::endl;
+
+    std::cout << "\n" << std::left << std::setw(20) << "queue" << std::right << std::setw(12) << "items/s"
+              << std::setw(14) << "ns per hop" << std::endl;
+    const int rounds = 20000;
+    {
+        ThreadSafeQueue<int> locked, ping, pong;
+        const double rate = measureThroughput(locked, 1, items);
+        printHopRow("ThreadSafeQueue", rate, measureHopLatency(ping, pong, rounds));
+    }
+    {
+        BoundedMpmcQueue<int> lock_free(1024), ping(1024), pong(1024);
+        const double rate = measureThroughput(lock_free, 1, items);
+        printHopRow("BoundedMpmcQueue", rate, measureHopLatency(ping, pong, rounds));
+    }
+    {
+        SpscQueue<int> wait_free(1024), ping(1024), pong(1024);
+        const double rate = measureThroughput(wait_free, 1, items);
+        printHopRow("SpscQueue", rate, measureHopLatency(ping, pong, rounds));
+    }
+    {
+        SpscQueue<int, true> wait_free(1024), ping(1024), pong(1024);
+        const double rate = measureThroughput(wait_free, 1, items);
+        printHopRow("SpscQueue (futex)", rate, measureHopLatency(ping, pong, rounds));
+    }
     return 0;
 }
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * A wait-free queue for exactly one producer thread and one consumer thread.
+ *
+ * With a single thread on each side nobody ever competes for a position, so there is no
+ * compare-and-swap and no retry loop: push and pop each finish in a bounded number of
+ * steps. The producer owns `head` (the next position to write) and the consumer owns
+ * `tail` (the next position to read); each publishes its counter with a release store
+ * and reads the other's with an acquire load.
+ *
+ * Reading the other side's counter is the only cross-core traffic, so each side keeps a
+ * private copy of it (cached_tail for the producer, cached_head for the consumer) and only
+ * reloads it when the copy says the queue is full or empty. Each counter and each cached
+ * copy sits on its own cache line, so in the steady state the two cores only exchange the
+ * lines of the slots themselves.
+ *
+ * The capacity is rounded up to a power of two so a position maps to its slot with a mask.
+ *
+ * Blocking selects how wait_and_pop waits for an empty queue. With false it spins and then
+ * yields, and push costs nothing extra. With true the consumer sleeps in the kernel (a
+ * futex on Linux) and push pays one fence to check whether it has to wake it, which suits
+ * pipelines that are idle for long stretches.
+ *
+ * Calling push from two threads, or pop from two threads, at once is a data race.
+ */
+template<typename T, bool Blocking = false>
+class SpscQueue {
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)]; // Holds a T only while the slot is full
+
+        T* value() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+
+    // Producer side: its own position and its last view of the consumer's
+    alignas(CACHE_LINE) std::atomic<size_t> head{0};
+    alignas(CACHE_LINE) size_t cached_tail = 0;
+
+    // Consumer side: its own position and its last view of the producer's
+    alignas(CACHE_LINE) std::atomic<size_t> tail{0};
+    alignas(CACHE_LINE) size_t cached_head = 0;
+
+    // 1 while the consumer is asleep (or about to be) in wait_and_pop; only used when Blocking
+    alignas(CACHE_LINE) std::atomic<uint32_t> sleeping{0};
+
+    static void backoff(unsigned& attempt) {
+        if (++attempt < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    // Sleeps while sleeping still holds 1; returns at once if the producer got there first
+    void sleep_until_woken() {
+#if defined(__linux__)
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex needs a plain 32-bit word");
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&sleeping), FUTEX_WAIT_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+        while (sleeping.load(std::memory_order_acquire) == 1) {
+            std::this_thread::yield();
+        }
+#endif
+    }
+
+    void wake_consumer() {
+        // Pairs with the fence in wait_and_pop: either the consumer sees the new head when
+        // it looks again, or we see its flag here
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_relaxed) == 1) {
+            sleeping.store(0, std::memory_order_release);
+#if defined(__linux__)
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&sleeping), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+        }
+    }
+
+public:
+    explicit SpscQueue(size_t capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("SpscQueue needs a capacity of at least 1");
+        }
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots.reset(new Slot[size]);
+        mask = size - 1;
+    }
+
+    ~SpscQueue() {
+        // Destroy whatever is still queued; neither thread may use the queue by now
+        const size_t end = head.load(std::memory_order_relaxed);
+        for (size_t position = tail.load(std::memory_order_relaxed); position != end; ++position) {
+            slots[position & mask].value()->~T();
+        }
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+    // Add an element if there is room (producer thread only)
+    // Returns true if successful, false if the queue was full
+    bool try_push(T value) {
+        return try_push_from(value);
+    }
+
+    // Add an element, waiting while the queue is full (producer thread only)
+    void push(T value) {
+        unsigned attempt = 0;
+        while (!try_push_from(value)) {
+            backoff(attempt);
+        }
+    }
+
+    // Try to pop an element from the queue (consumer thread only)
+    // Returns true if successful, false if queue was empty
+    bool try_pop(T& value) {
+        const size_t position = tail.load(std::memory_order_relaxed);
+        if (position == cached_head) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (position == cached_head) {
+                return false;
+            }
+        }
+        T* stored = slots[position & mask].value();
+        value = std::move(*stored);
+        stored->~T();
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Wait until an element is available and then pop it (consumer thread only)
+    void wait_and_pop(T& value) {
+        unsigned attempt = 0;
+        while (!try_pop(value)) {
+            if (!Blocking || attempt < 64) {
+                backoff(attempt);
+                continue;
+            }
+            // Announce the sleep, then look once more: a push that missed the flag is
+            // guaranteed to be visible here
+            sleeping.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (try_pop(value)) {
+                sleeping.store(0, std::memory_order_relaxed);
+                return;
+            }
+            sleep_until_woken();
+            sleeping.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Check if the queue is empty
+    // Exact on the consumer thread; only a snapshot anywhere else
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    // Moves value in if there is room and leaves it untouched if not, so push() can retry
+    bool try_push_from(T& value) {
+        const size_t position = head.load(std::memory_order_relaxed);
+        if (position - cached_tail > mask) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (position - cached_tail > mask) {
+                return false;
+            }
+        }
+        new (slots[position & mask].storage) T(std::move(value));
+        head.store(position + 1, std::memory_order_release);
+        if (Blocking) {
+            wake_consumer();
+        }
+        return true;
+    }
+};
@@ -1,9 +1,161 @@
 // chapter 08 concurrent design - C++ Concurrency in Action
-// Start your code for this chapter here
+// A work-stealing thread pool (work_stealing_pool.h): its Chase-Lev deque under attack from
+// thieves, futures from submit(), and the chapter's fork-join parallel quicksort on top of it
+//
+// Usage: chapter_08_concurrent_design [--pin]    (--pin binds the workers to cores)
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <future>
 #include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
-int main() {
-    std::cout << "Hello from chapter_08_concurrent_design" << std::endl;
+#include "work_stealing_pool.h"
+
+// The owner pushes 0..items-1 (popping some of them back as it goes) while thieves steal
+// from the other end. The deque starts with 4 slots so it grows while being robbed.
+// Passes when every value was taken exactly once, by somebody.
+bool runDequeTest(int thieves, uint64_t items) {
+    ChaseLevDeque<uint64_t> deque(4);
+    std::vector<std::vector<uint64_t>> taken(thieves + 1);
+    std::atomic<bool> done(false);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thieves; ++t) {
+        threads.emplace_back([&deque, &taken, &done, t] {
+            uint64_t value;
+            while (!done.load(std::memory_order_acquire) || !deque.empty()) {
+                if (deque.steal(value)) {
+                    taken[t + 1].push_back(value);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    uint64_t value;
+    for (uint64_t i = 0; i < items; ++i) {
+        deque.push(i);
+        if (i % 3 == 0 && deque.pop(value)) {
+            taken[0].push_back(value);
+        }
+    }
+    while (deque.pop(value)) {
+        taken[0].push_back(value);
+    }
+    done.store(true, std::memory_order_release);
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    std::vector<uint32_t> seen(items, 0);
+    for (const std::vector<uint64_t>& values : taken) {
+        for (uint64_t v : values) {
+            if (v >= items) {
+                return false;
+            }
+            ++seen[v];
+        }
+    }
+    return std::all_of(seen.begin(), seen.end(), [](uint32_t n) { return n == 1; });
+}
+
+// Many small tasks from outside the pool, arguments passed through submit(), and an
+// exception delivered through its future
+bool runSubmitTest(WorkStealingPool& pool) {
+    std::vector<std::future<uint64_t>> futures;
+    for (uint64_t i = 0; i < 10000; ++i) {
+        futures.push_back(pool.submit([](uint64_t n) { return n * n; }, i));
+    }
+    uint64_t sum = 0;
+    for (std::future<uint64_t>& f : futures) {
+        sum += f.get();
+    }
+    bool ok = sum == 9999ull * 10000 * 19999 / 6;
+
+    std::future<std::string> joined = pool.submit([](std::string a, const std::string& b) { return a + b; },
+                                                  std::string("work "), std::string("stealing"));
+    ok = ok && joined.get() == "work stealing";
+
+    std::future<void> failing = pool.submit([] { throw std::runtime_error("task failed"); });
+    try {
+        failing.get();
+        ok = false;
+    } catch (const std::runtime_error& e) {
+        ok = ok && std::string(e.what()) == "task failed";
+    }
+    return ok;
+}
+
+// Quicksort as a fork-join program: each partition step forks the lower half as a task
+// and sorts the upper half itself, then helps the pool until the lower half is done.
+// Small ranges are sorted sequentially so tasks stay large enough to be worth stealing.
+template<typename Iterator>
+void parallelQuickSort(WorkStealingPool& pool, Iterator first, Iterator last) {
+    if (last - first > 2048) {
+        const auto pivot = *(first + (last - first) / 2);
+        Iterator middle1 = std::partition(first, last, [&pivot](const auto& x) { return x < pivot; });
+        Iterator middle2 = std::partition(middle1, last, [&pivot](const auto& x) { return !(pivot < x); });
+        std::future<void> lower = pool.submit([&pool, first, middle1] { parallelQuickSort(pool, first, middle1); });
+        parallelQuickSort(pool, middle2, last);
+        pool.wait(lower);
+    } else {
+        std::sort(first, last);
+    }
+}
+
+void sortOnPool(WorkStealingPool& pool, std::vector<uint32_t>& values) {
+    std::future<void> done = pool.submit([&pool, &values] { parallelQuickSort(pool, values.begin(), values.end()); });
+    done.get();
+}
+
+int main(int argc, char* argv[]) {
+    const bool pin = argc > 1 && std::strcmp(argv[1], "--pin") == 0;
+
+    std::cout << "--- Chase-Lev deque ---" << std::endl;
+    const int thief_counts[] = {1, 2, 4, 8};
+    int passed = 0;
+    for (int thieves : thief_counts) {
+        passed += runDequeTest(thieves, 200000) ? 1 : 0;
+    }
+    std::cout << passed << "/" << sizeof(thief_counts) / sizeof(thief_counts[0])
+              << " thief counts take every value exactly once" << std::endl;
+
+    std::cout << "\n--- submit() ---" << std::endl;
+    {
+        WorkStealingPool pool(4, pin);
+        std::cout << "Futures, arguments and exceptions: " << (runSubmitTest(pool) ? "ok" : "FAILED") << std::endl;
+    }
+
+    std::cout << "\n--- Fork-join quicksort of 4M values" << (pin ? ", pinned" : "") << " ---" << std::endl;
+    std::vector<uint32_t> input(1 << 22);
+    std::mt19937 rng(42);
+    for (uint32_t& v : input) {
+        v = rng();
+    }
+    std::vector<uint32_t> expected = input;
+    auto start = std::chrono::steady_clock::now();
+    std::sort(expected.begin(), expected.end());
+    const double sequential = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "std::sort: " << sequential * 1000 << " ms" << std::endl;
+
+    std::cout << "threads   ms      speedup   sorted" << std::endl;
+    const size_t max_threads = std::max(4u, 2 * std::thread::hardware_concurrency());
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        WorkStealingPool pool(threads, pin);
+        std::vector<uint32_t> values = input;
+        start = std::chrono::steady_clock::now();
+        sortOnPool(pool, values);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << threads << "\t  " << seconds * 1000 << "\t  " << sequential / seconds << "\t    "
+                  << (values == expected ? "yes" : "NO") << std::endl;
+    }
     return 0;
 }
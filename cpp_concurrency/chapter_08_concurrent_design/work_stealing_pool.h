@@ -0,0 +1,380 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "thread_safe_queue.h"
+
+/**
+ * The Chase-Lev work-stealing deque, in the C11 formulation of Lê, Pop, Cohen and
+ * Zappa Nardelli ("Correct and Efficient Work-Stealing for Weak Memory Models", 2013).
+ *
+ * One owner thread pushes and pops at the bottom like a stack, so it gets back the work
+ * it created most recently (still hot in its cache). Any number of thieves take from the
+ * top, the oldest work, which in a fork-join program is the biggest piece left. Owner and
+ * thieves only race for the last element, which they settle with a CAS on `top`; all
+ * other operations are a handful of plain loads and stores.
+ *
+ * The ring grows when the owner fills it. Thieves may still be reading the old ring, so
+ * retired rings are kept until the deque is destroyed; they add up to less than the final
+ * one.
+ *
+ * T must be trivially copyable (the pool stores raw task pointers).
+ */
+template<typename T>
+class ChaseLevDeque {
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct Ring {
+        int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> items;
+
+        explicit Ring(int64_t size) : mask(size - 1), items(new std::atomic<T>[size]) {}
+
+        int64_t size() const { return mask + 1; }
+        T get(int64_t i) const { return items[i & mask].load(std::memory_order_relaxed); }
+        void put(int64_t i, T value) { items[i & mask].store(value, std::memory_order_relaxed); }
+    };
+
+    // top is advanced by thieves (and by the owner for the last element), bottom only by
+    // the owner; each on its own cache line
+    alignas(CACHE_LINE) std::atomic<int64_t> top{0};
+    alignas(CACHE_LINE) std::atomic<int64_t> bottom{0};
+    alignas(CACHE_LINE) std::atomic<Ring*> ring;
+    std::vector<std::unique_ptr<Ring>> rings; // The current ring and every retired one; owner only
+
+    Ring* grow(Ring* old, int64_t t, int64_t b) {
+        rings.push_back(std::make_unique<Ring>(old->size() * 2));
+        Ring* bigger = rings.back().get();
+        for (int64_t i = t; i < b; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        ring.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+public:
+    explicit ChaseLevDeque(size_t initial_capacity = 256) {
+        static_assert(std::is_trivially_copyable<T>::value, "ChaseLevDeque holds trivially copyable values");
+        int64_t size = 2;
+        while (size < static_cast<int64_t>(initial_capacity)) {
+            size <<= 1;
+        }
+        rings.push_back(std::make_unique<Ring>(size));
+        ring.store(rings.back().get(), std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+    // Add an element at the bottom (owner thread only)
+    void push(T value) {
+        const int64_t b = bottom.load(std::memory_order_relaxed);
+        const int64_t t = top.load(std::memory_order_acquire);
+        Ring* r = ring.load(std::memory_order_relaxed);
+        if (b - t > r->mask) {
+            r = grow(r, t, b);
+        }
+        r->put(b, value);
+        // Release so a thief that sees the new bottom also sees the element
+        bottom.store(b + 1, std::memory_order_release);
+    }
+
+    // Take the newest element from the bottom (owner thread only)
+    // Returns true if successful, false if the deque was empty
+    bool pop(T& value) {
+        const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Ring* r = ring.load(std::memory_order_relaxed);
+        // Claim the bottom element before looking at top; the fence orders the two so a
+        // thief cannot take the same element without the CAS below noticing
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed); // Was already empty
+            return false;
+        }
+        value = r->get(b);
+        if (t == b) {
+            // The last element: race the thieves for it
+            const bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                         std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Take the oldest element from the top (any thread)
+    // Returns false if the deque was empty or another thread won the race for the element
+    bool steal(T& value) {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        Ring* r = ring.load(std::memory_order_acquire);
+        value = r->get(t);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    // Only a snapshot when called by a thief
+    bool empty() const {
+        return bottom.load(std::memory_order_acquire) <= top.load(std::memory_order_acquire);
+    }
+};
+
+/**
+ * A fixed-size thread pool whose workers balance the load by stealing from each other.
+ *
+ * Every worker owns a ChaseLevDeque. A task submitted from inside a worker (a fork in a
+ * fork-join algorithm) goes onto that worker's own deque, where no other thread touches
+ * it unless it runs out of work. Tasks submitted from any other thread go into a shared
+ * injection queue (a ThreadSafeQueue). A worker looking for work tries, in order, its own
+ * deque, the injection queue, and then the other workers' deques, starting at a random
+ * victim so the thieves spread out.
+ *
+ * A worker that finds nothing sleeps on a condition variable. `pending` counts queued
+ * tasks and `sleepers` counts sleeping workers; whoever queues a task only takes the
+ * mutex to wake somebody when there is somebody to wake.
+ *
+ * submit() returns a std::future. A task that waits for tasks it forked must not block
+ * its worker on future::get(), or a pool with all workers waiting would deadlock; it
+ * calls wait() instead, which runs other tasks until the future is ready.
+ *
+ * With pin_to_cores the workers are bound round-robin to the CPUs this process may run
+ * on (Linux only; elsewhere the flag is ignored).
+ *
+ * The destructor runs every task still queued, so no future is left without a value.
+ */
+class WorkStealingPool {
+private:
+    struct Task {
+        virtual ~Task() = default;
+        virtual void run() = 0;
+    };
+
+    template<typename F>
+    struct TaskFor : Task {
+        F function;
+
+        explicit TaskFor(F&& f) : function(std::move(f)) {}
+        void run() override { function(); }
+    };
+
+    struct Worker {
+        ChaseLevDeque<Task*> deque;
+        uint64_t rng_state;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    ThreadSafeQueue<Task*> injected;
+    std::vector<std::thread> threads;
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::atomic<size_t> pending{0};
+    std::atomic<size_t> sleepers{0};
+    std::atomic<bool> stopping{false};
+
+    // Which pool and worker the current thread belongs to, so submit() can find its deque
+    static inline thread_local WorkStealingPool* current_pool = nullptr;
+    static inline thread_local size_t current_index = 0;
+
+    Worker* own_worker() const {
+        return current_pool == this ? workers[current_index].get() : nullptr;
+    }
+
+    void enqueue(Task* task) {
+        // Counted before it can be taken, so pending never drops below the tasks queued.
+        // Pairs with the check in wait_for_work(): either the sleeper sees the new count or
+        // we see the sleeper
+        pending.fetch_add(1, std::memory_order_seq_cst);
+        if (Worker* worker = own_worker()) {
+            worker->deque.push(task);
+        } else {
+            injected.push(task);
+        }
+        if (sleepers.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            wake.notify_one();
+        }
+    }
+
+    Task* find_task(Worker& worker, size_t index) {
+        Task* task = nullptr;
+        if (worker.deque.pop(task) || injected.try_pop(task)) {
+            return task;
+        }
+        const size_t count = workers.size();
+        // xorshift64 picks where to start stealing
+        worker.rng_state ^= worker.rng_state << 13;
+        worker.rng_state ^= worker.rng_state >> 7;
+        worker.rng_state ^= worker.rng_state << 17;
+        const size_t start = static_cast<size_t>(worker.rng_state % count);
+        for (size_t i = 0; i < count; ++i) {
+            const size_t victim = (start + i) % count;
+            if (victim != index && workers[victim]->deque.steal(task)) {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    // Runs one task taken by this worker and accounts for it
+    void run(Task* task) {
+        pending.fetch_sub(1, std::memory_order_relaxed);
+        std::unique_ptr<Task> owned(task);
+        owned->run();
+    }
+
+    void wait_for_work() {
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleepers.fetch_add(1, std::memory_order_seq_cst);
+        wake.wait(lock, [this] {
+            return pending.load(std::memory_order_seq_cst) > 0 || stopping.load(std::memory_order_relaxed);
+        });
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void worker_loop(size_t index) {
+        current_pool = this;
+        current_index = index;
+        Worker& worker = *workers[index];
+        unsigned idle = 0;
+        for (;;) {
+            if (Task* task = find_task(worker, index)) {
+                run(task);
+                idle = 0;
+            } else if (stopping.load(std::memory_order_acquire) && pending.load(std::memory_order_acquire) == 0) {
+                return;
+            } else if (++idle < 64) {
+                // A steal can fail because of a lost race rather than an empty pool, and
+                // work often turns up a moment later, so look again before sleeping
+                std::this_thread::yield();
+            } else {
+                wait_for_work();
+                idle = 0;
+            }
+        }
+    }
+
+    static void pin_to_core(std::thread& thread, size_t index) {
+#if defined(__linux__)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+            return;
+        }
+        size_t nth = index % static_cast<size_t>(CPU_COUNT(&allowed));
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed) && nth-- == 0) {
+                cpu_set_t one;
+                CPU_ZERO(&one);
+                CPU_SET(cpu, &one);
+                pthread_setaffinity_np(thread.native_handle(), sizeof(one), &one);
+                return;
+            }
+        }
+#else
+        (void)thread;
+        (void)index;
+#endif
+    }
+
+public:
+    explicit WorkStealingPool(size_t thread_count = std::thread::hardware_concurrency(), bool pin_to_cores = false) {
+        if (thread_count == 0) {
+            thread_count = 1;
+        }
+        for (size_t i = 0; i < thread_count; ++i) {
+            workers.push_back(std::make_unique<Worker>());
+            workers.back()->rng_state = 0x9E3779B97F4A7C15ull * (i + 1);
+        }
+        for (size_t i = 0; i < thread_count; ++i) {
+            threads.emplace_back([this, i] { worker_loop(i); });
+            if (pin_to_cores) {
+                pin_to_core(threads.back(), i);
+            }
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping.store(true, std::memory_order_release);
+        }
+        wake.notify_all();
+        for (std::thread& t : threads) {
+            t.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t size() const {
+        return threads.size();
+    }
+
+    // Queue f(args...) and return a future for its result. Exceptions thrown by f are
+    // delivered through the future
+    template<typename F, typename... Args>
+    auto submit(F&& f, Args&&... args) -> std::future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>> {
+        using Result = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+        std::packaged_task<Result()> task(
+            [f = std::forward<F>(f), arguments = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                return std::apply(std::move(f), std::move(arguments));
+            });
+        std::future<Result> result = task.get_future();
+        enqueue(new TaskFor<std::packaged_task<Result()>>(std::move(task)));
+        return result;
+    }
+
+    // Run queued tasks on the calling thread until future is ready, then return its value.
+    // Safe to call from inside a task; from any other thread it helps with injected tasks
+    template<typename R>
+    R wait(std::future<R>& future) {
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (!run_pending_task()) {
+                std::this_thread::yield();
+            }
+        }
+        return future.get();
+    }
+
+    // Run one queued task on the calling thread, if there is one
+    // Returns false if no task was found
+    bool run_pending_task() {
+        Task* task = nullptr;
+        if (Worker* worker = own_worker()) {
+            task = find_task(*worker, current_index);
+        } else {
+            injected.try_pop(task);
+        }
+        if (task == nullptr) {
+            return false;
+        }
+        run(task);
+        return true;
+    }
+};
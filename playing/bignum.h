@@ -0,0 +1,2562 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// x86-64 always has SSE2; the AVX2 kernels are compiled with a target attribute and only
+// called when the CPU reports AVX2 at run time
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BIGNUM_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define BIGNUM_X86_SIMD 0
+#endif
+
+// The binary format is little-endian; on such hosts records are copied (or read in place)
+// as whole limb arrays instead of byte by byte
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define BIGNUM_LITTLE_ENDIAN 1
+#else
+#define BIGNUM_LITTLE_ENDIAN 0
+#endif
+
+/**
+ * LimbStorage - the limb buffer behind BigNum
+ *
+ * A minimal vector of uint32_t with room for INLINE_LIMBS limbs inside the object itself,
+ * which covers any value up to 256 bits plus a carry limb. Values that fit never touch the
+ * heap; larger ones spill into a heap block that is kept and reused when the value later
+ * shrinks or is overwritten, so steady-state arithmetic does not allocate either way.
+ */
+class LimbStorage {
+public:
+    static constexpr size_t INLINE_LIMBS = 10;
+    
+    LimbStorage() = default;
+    
+    LimbStorage(const LimbStorage& other) {
+        assign(other.begin(), other.end());
+    }
+    
+    LimbStorage(LimbStorage&& other) noexcept {
+        takeFrom(other);
+    }
+    
+    LimbStorage& operator=(const LimbStorage& other) {
+        if (this != &other) {
+            assign(other.begin(), other.end()); // Reuses the current block when it is large enough
+        }
+        return *this;
+    }
+    
+    LimbStorage& operator=(LimbStorage&& other) noexcept {
+        if (this != &other) {
+            if (other.data_ == other.inline_ && data_ != inline_) {
+                // Nothing to steal: copy the few limbs and keep our own heap block for later
+                assign(other.begin(), other.end());
+            } else {
+                release();
+                takeFrom(other);
+            }
+        }
+        return *this;
+    }
+    
+    ~LimbStorage() {
+        release();
+    }
+    
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return capacity_; }
+    uint32_t* data() { return data_; }
+    const uint32_t* data() const { return data_; }
+    uint32_t* begin() { return data_; }
+    uint32_t* end() { return data_ + size_; }
+    const uint32_t* begin() const { return data_; }
+    const uint32_t* end() const { return data_ + size_; }
+    uint32_t& operator[](size_t i) { return data_[i]; }
+    const uint32_t& operator[](size_t i) const { return data_[i]; }
+    uint32_t& back() { return data_[size_ - 1]; }
+    const uint32_t& back() const { return data_[size_ - 1]; }
+    
+    void reserve(size_t count) {
+        if (count > capacity_) {
+            grow(count);
+        }
+    }
+    
+    // New limbs (if any) are set to value
+    void resize(size_t count, uint32_t value = 0) {
+        reserve(count);
+        if (count > size_) {
+            std::fill(data_ + size_, data_ + count, value);
+        }
+        size_ = count;
+    }
+    
+    void assign(size_t count, uint32_t value) {
+        size_ = 0;
+        resize(count, value);
+    }
+    
+    // The source range must not point into this buffer
+    void assign(const uint32_t* first, const uint32_t* last) {
+        size_t count = static_cast<size_t>(last - first);
+        size_ = 0;
+        reserve(count);
+        std::copy(first, last, data_);
+        size_ = count;
+    }
+    
+    void push_back(uint32_t value) {
+        if (size_ == capacity_) {
+            grow(2 * capacity_);
+        }
+        data_[size_++] = value;
+    }
+    
+    void pop_back() {
+        --size_;
+    }
+    
+    void clear() {
+        size_ = 0;
+    }
+    
+    // Shifts every limb up by count positions and zero-fills the bottom
+    void insertZerosAtFront(size_t count) {
+        size_t oldSize = size_;
+        resize(size_ + count);
+        std::copy_backward(data_, data_ + oldSize, data_ + oldSize + count);
+        std::fill(data_, data_ + count, 0);
+    }
+    
+    bool operator==(const LimbStorage& other) const {
+        return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+    }
+
+private:
+    uint32_t* data_ = inline_;
+    size_t size_ = 0;
+    size_t capacity_ = INLINE_LIMBS;
+    uint32_t inline_[INLINE_LIMBS];
+    
+    // Moves to a heap block of at least count limbs, keeping the current contents
+    void grow(size_t count) {
+        size_t newCapacity = std::max(count, 2 * capacity_);
+        uint32_t* block = new uint32_t[newCapacity];
+        // size_ never exceeds newCapacity; the min lets GCC see that too, where it would
+        // otherwise warn about an overflowing copy into a block it thinks may be empty
+        std::copy(data_, data_ + std::min(size_, newCapacity), block);
+        if (data_ != inline_) {
+            delete[] data_;
+        }
+        data_ = block;
+        capacity_ = newCapacity;
+    }
+    
+    void release() {
+        if (data_ != inline_) {
+            delete[] data_;
+        }
+        data_ = inline_;
+        capacity_ = INLINE_LIMBS;
+        size_ = 0;
+    }
+    
+    // Requires this to be empty and inline. Leaves other holding the single limb 0, so a
+    // moved-from BigNum still reads as zero.
+    void takeFrom(LimbStorage& other) {
+        if (other.data_ == other.inline_) {
+            std::copy(other.inline_, other.inline_ + other.size_, inline_);
+            size_ = other.size_;
+        } else {
+            data_ = other.data_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            other.data_ = other.inline_;
+            other.capacity_ = INLINE_LIMBS;
+        }
+        other.inline_[0] = 0;
+        other.size_ = 1;
+    }
+};
+
+/**
+ * WorkerPool - a fixed set of threads for fork-join loops
+ *
+ * parallelFor(count, body) runs body(0) .. body(count - 1) across the workers and the calling
+ * thread and returns once all of them have finished. A caller waiting on its own loop keeps
+ * running indices from other pending loops, so bodies may themselves call parallelFor
+ * (BigNum's NTT nests three levels deep) without starving the pool. Bodies must not throw.
+ */
+class WorkerPool {
+public:
+    // Starts threads - 1 workers; the thread calling parallelFor is the last one
+    explicit WorkerPool(unsigned threads) {
+        for (unsigned i = 1; i < threads; ++i) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+    
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+    
+    unsigned size() const {
+        return static_cast<unsigned>(workers.size()) + 1;
+    }
+    
+    template <typename Fn>
+    void parallelFor(size_t count, Fn&& body) {
+        if (count == 0) {
+            return;
+        }
+        auto loop = std::make_shared<Loop>();
+        loop->body = [&body](size_t i) { body(i); };
+        loop->count = count;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(loop);
+        }
+        wake.notify_all();
+        
+        runIndices(*loop);
+        while (loop->finished.load(std::memory_order_acquire) < count) {
+            // Help with whatever else is queued (typically loops nested inside our own body)
+            if (std::shared_ptr<Loop> other = nextLoop()) {
+                runIndices(*other);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    struct Loop {
+        std::function<void(size_t)> body;
+        size_t count = 0;
+        std::atomic<size_t> next{0};     // Next index to hand out
+        std::atomic<size_t> finished{0}; // Indices completed
+    };
+    
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::shared_ptr<Loop>> pending; // Loops that may still have unclaimed indices
+    bool stopping = false;
+    
+    static void runIndices(Loop& loop) {
+        for (size_t i; (i = loop.next.fetch_add(1, std::memory_order_relaxed)) < loop.count;) {
+            loop.body(i);
+            loop.finished.fetch_add(1, std::memory_order_release);
+        }
+    }
+    
+    // Returns the oldest loop with unclaimed indices, dropping exhausted ones on the way
+    std::shared_ptr<Loop> nextLoop() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return nextLoopLocked();
+    }
+    
+    std::shared_ptr<Loop> nextLoopLocked() {
+        while (!pending.empty()) {
+            if (pending.front()->next.load(std::memory_order_relaxed) < pending.front()->count) {
+                return pending.front();
+            }
+            pending.pop_front();
+        }
+        return nullptr;
+    }
+    
+    void workerLoop() {
+        for (;;) {
+            std::shared_ptr<Loop> loop;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !pending.empty(); });
+                loop = nextLoopLocked();
+                if (!loop) {
+                    if (stopping) {
+                        return;
+                    }
+                    continue;
+                }
+            }
+            runIndices(*loop);
+        }
+    }
+};
+
+class BigNum;
+
+/**
+ * Expression templates for fused BigNum arithmetic
+ *
+ * a + b, a - b and a * b do not compute anything: they build a small expression object that
+ * refers to the operands. Assigning it to a BigNum (or constructing, returning or comparing
+ * one) flattens the tree into a signed list of terms, each a single operand or a product of
+ * two, and evaluates the whole sum in one carry pass straight into the destination. So
+ * r = a + b + c - d reads each limb once and allocates nothing when r is large enough, and
+ * r = a * b + c writes the product into r and adds c in place.
+ *
+ * Expressions refer to their BigNum operands, temporaries included, so they must be
+ * evaluated within the full expression that creates them: do not store one in an auto
+ * variable. Factors of a product that are themselves expressions are evaluated eagerly.
+ *
+ * An rvalue operand of + or - (std::move(a) + b, f() + g()) is treated as given up: when
+ * the destination is too small for the sum and the operand's buffer is not, evaluation
+ * moves the operand into the destination and adds the rest in place, so the sum needs no
+ * allocation of its own. Such an operand is left in the moved-from state, which reads as zero.
+ */
+
+// One term of a flattened sum: -x, +x, -x * y or +x * y (y is null for a plain operand).
+// spare is x itself when x is an rvalue operand whose storage the destination may take over.
+struct BigNumTerm {
+    const BigNum* x;
+    const BigNum* y;
+    bool negative;
+    BigNum* spare = nullptr;
+};
+
+// Base of every expression node. It makes an expression usable where a BigNum value is
+// read, so code like (a + b).toString() or q * b + r == a keeps compiling.
+template <typename Derived>
+class BigNumExpr {
+public:
+    const Derived& self() const { return static_cast<const Derived&>(*this); }
+    
+    BigNum eval() const;
+    bool operator==(const BigNum& other) const;
+    bool operator!=(const BigNum& other) const;
+    bool operator<(const BigNum& other) const;
+    bool operator<=(const BigNum& other) const;
+    bool operator>(const BigNum& other) const;
+    bool operator>=(const BigNum& other) const;
+    BigNum operator/(const BigNum& other) const;
+    BigNum operator%(const BigNum& other) const;
+    int compareAbsoluteValue(const BigNum& other) const;
+    BigNum square() const;
+    BigNum pow(unsigned long long exponent) const;
+    std::string toString() const;
+};
+
+// A single operand: a reference to a BigNum, or an owned BigNum for integer operands and
+// for factors that had to be evaluated first
+template <typename T>
+class BigNumLeaf {
+public:
+    static constexpr size_t termCount = 1;
+    
+    explicit BigNumLeaf(T operand) : value(std::forward<T>(operand)) {}
+    
+    const auto& operand() const { return value; }
+    
+    void collect(BigNumTerm*& cursor, bool negative) const {
+        *cursor++ = BigNumTerm{&value, nullptr, negative};
+    }
+
+private:
+    T value;
+};
+
+// An rvalue operand of + or -, offered to the destination as spare storage
+class BigNumSpareLeaf {
+public:
+    static constexpr size_t termCount = 1;
+    
+    explicit BigNumSpareLeaf(BigNum& operand) : value(&operand) {}
+    
+    void collect(BigNumTerm*& cursor, bool negative) const {
+        *cursor++ = BigNumTerm{value, nullptr, negative, value};
+    }
+
+private:
+    BigNum* value;
+};
+
+template <typename Left, typename Right>
+class BigNumProduct : public BigNumExpr<BigNumProduct<Left, Right>> {
+public:
+    static constexpr size_t termCount = 1;
+    
+    BigNumProduct(Left left, Right right) : left(std::move(left)), right(std::move(right)) {}
+    
+    void collect(BigNumTerm*& cursor, bool negative) const {
+        *cursor++ = BigNumTerm{&left.operand(), &right.operand(), negative};
+    }
+
+private:
+    Left left;
+    Right right;
+};
+
+// left + right, or left - right when Subtract is set
+template <typename Left, typename Right, bool Subtract>
+class BigNumSum : public BigNumExpr<BigNumSum<Left, Right, Subtract>> {
+public:
+    static constexpr size_t termCount = Left::termCount + Right::termCount;
+    
+    BigNumSum(Left left, Right right) : left(std::move(left)), right(std::move(right)) {}
+    
+    void collect(BigNumTerm*& cursor, bool negative) const {
+        left.collect(cursor, negative);
+        right.collect(cursor, negative != Subtract);
+    }
+
+private:
+    Left left;
+    Right right;
+};
+
+template <typename T>
+using BigNumDecay = std::remove_cv_t<std::remove_reference_t<T>>;
+
+template <typename T>
+constexpr bool isBigNumExpr = std::is_base_of<BigNumExpr<BigNumDecay<T>>, BigNumDecay<T>>::value;
+
+template <typename T>
+constexpr bool isBigNumValue = std::is_same<BigNumDecay<T>, BigNum>::value || isBigNumExpr<T>;
+
+// The arithmetic operators accept BigNums, expressions and integers, as long as one side is
+// not an integer (integers used to convert implicitly to the const BigNum& parameters)
+template <typename L, typename R>
+using EnableBigNumOperator = std::enable_if_t<
+    (isBigNumValue<L> || std::is_integral<BigNumDecay<L>>::value) &&
+    (isBigNumValue<R> || std::is_integral<BigNumDecay<R>>::value) &&
+    (isBigNumValue<L> || isBigNumValue<R>)>;
+
+// Node for an operand of + and -: expressions are kept as subtrees
+inline BigNumLeaf<const BigNum&> bigNumSumOperand(const BigNum& x) {
+    return BigNumLeaf<const BigNum&>(x);
+}
+
+inline BigNumSpareLeaf bigNumSumOperand(BigNum&& x) {
+    return BigNumSpareLeaf(x);
+}
+
+// (Num only defers naming BigNum's layout until the class is complete)
+template <typename Integer, typename Num = BigNum, typename = std::enable_if_t<std::is_integral<Integer>::value>>
+BigNumLeaf<Num> bigNumSumOperand(Integer x) {
+    return BigNumLeaf<Num>(static_cast<long long>(x));
+}
+
+template <typename Derived>
+Derived bigNumSumOperand(const BigNumExpr<Derived>& x) {
+    return x.self();
+}
+
+// Node for a factor of *: expressions are evaluated, since a term holds one product only
+inline BigNumLeaf<const BigNum&> bigNumFactor(const BigNum& x) {
+    return BigNumLeaf<const BigNum&>(x);
+}
+
+template <typename Integer, typename Num = BigNum, typename = std::enable_if_t<std::is_integral<Integer>::value>>
+BigNumLeaf<Num> bigNumFactor(Integer x) {
+    return BigNumLeaf<Num>(static_cast<long long>(x));
+}
+
+template <typename Derived, typename Num = BigNum>
+BigNumLeaf<Num> bigNumFactor(const BigNumExpr<Derived>& x) {
+    return BigNumLeaf<Num>(x);
+}
+
+template <typename L, typename R, typename = EnableBigNumOperator<L, R>>
+auto operator+(L&& a, R&& b) {
+    using Left = decltype(bigNumSumOperand(std::forward<L>(a)));
+    using Right = decltype(bigNumSumOperand(std::forward<R>(b)));
+    return BigNumSum<Left, Right, false>(bigNumSumOperand(std::forward<L>(a)),
+                                         bigNumSumOperand(std::forward<R>(b)));
+}
+
+template <typename L, typename R, typename = EnableBigNumOperator<L, R>>
+auto operator-(L&& a, R&& b) {
+    using Left = decltype(bigNumSumOperand(std::forward<L>(a)));
+    using Right = decltype(bigNumSumOperand(std::forward<R>(b)));
+    return BigNumSum<Left, Right, true>(bigNumSumOperand(std::forward<L>(a)),
+                                        bigNumSumOperand(std::forward<R>(b)));
+}
+
+template <typename L, typename R, typename = EnableBigNumOperator<L, R>>
+auto operator*(L&& a, R&& b) {
+    using Left = decltype(bigNumFactor(a));
+    using Right = decltype(bigNumFactor(b));
+    return BigNumProduct<Left, Right>(bigNumFactor(a), bigNumFactor(b));
+}
+
+/**
+ * BigNum class - A class for handling very large numbers
+ * Supports operations like addition and multiplication for numbers with hundreds of digits
+ *
+ * The magnitude is stored in base 10^9 "limbs": every uint32_t holds nine decimal
+ * digits. Compared to one digit per int this needs ~8x less memory and ~9x fewer
+ * loop iterations, while decimal I/O stays a simple zero-padded print of each limb.
+ * The limbs live in a LimbStorage, so values up to 256 bits never allocate.
+ */
+class BigNum {
+private:
+    static constexpr uint32_t BASE = 1000000000; // 10^9, one more than the largest limb value
+    static constexpr int BASE_DIGITS = 9;        // Decimal digits stored in each limb
+    
+    LimbStorage limbs; // Stores base 10^9 limbs in reverse order (least significant first)
+    bool isNegative;   // Flag to indicate if the number is negative
+    
+    friend class BigNumView; // Shares the decimal and validation helpers
+    
+    // Helper method to remove leading zeros
+    void removeLeadingZeros() {
+        while (limbs.size() > 1 && limbs.back() == 0) {
+            limbs.pop_back();
+        }
+        // If only a single zero remains, make sure it's not marked as negative
+        if (limbs.size() == 1 && limbs[0] == 0) {
+            isNegative = false;
+        }
+    }
+    
+    bool isZero() const {
+        return limbs.size() == 1 && limbs[0] == 0;
+    }
+    
+    // Builds a non-negative BigNum from a slice of limbs (an empty slice is zero)
+    static BigNum fromLimbs(const uint32_t* p, size_t count) {
+        BigNum result;
+        if (count > 0) {
+            result.limbs.assign(p, p + count);
+            result.removeLeadingZeros();
+        }
+        return result;
+    }
+    
+    // Divides the magnitude in place by a small divisor and returns the remainder
+    uint32_t divideSmallInPlace(uint32_t divisor) {
+        uint64_t remainder = 0;
+        for (size_t i = limbs.size(); i-- > 0;) {
+            uint64_t current = limbs[i] + remainder * BASE;
+            limbs[i] = static_cast<uint32_t>(current / divisor);
+            remainder = current % divisor;
+        }
+        removeLeadingZeros();
+        return static_cast<uint32_t>(remainder);
+    }
+    
+    // "00" "01" ... "99": limbs are printed two digits per lookup instead of one per division
+    static constexpr char DIGIT_PAIRS[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    
+    // Writes limb as exactly nine digits, zero-padded on the left
+    static void writeLimbPadded(char* out, uint32_t limb) {
+        uint32_t high = limb / 100000; // Top four digits
+        uint32_t low = limb % 100000;  // Bottom five digits
+        out[0] = DIGIT_PAIRS[2 * (high / 100)];
+        out[1] = DIGIT_PAIRS[2 * (high / 100) + 1];
+        out[2] = DIGIT_PAIRS[2 * (high % 100)];
+        out[3] = DIGIT_PAIRS[2 * (high % 100) + 1];
+        out[4] = static_cast<char>('0' + low / 10000);
+        low %= 10000;
+        out[5] = DIGIT_PAIRS[2 * (low / 100)];
+        out[6] = DIGIT_PAIRS[2 * (low / 100) + 1];
+        out[7] = DIGIT_PAIRS[2 * (low % 100)];
+        out[8] = DIGIT_PAIRS[2 * (low % 100) + 1];
+    }
+    
+    // Number of decimal digits in a limb, counting 0 as one digit
+    static size_t limbDigits(uint32_t limb) {
+        size_t digits = 1;
+        for (uint32_t bound = 10; digits < BASE_DIGITS && limb >= bound; bound *= 10) {
+            ++digits;
+        }
+        return digits;
+    }
+    
+    // Writes limb without leading zeros and returns the number of digits written
+    static size_t writeLimbUnpadded(char* out, uint32_t limb) {
+        char padded[BASE_DIGITS];
+        writeLimbPadded(padded, limb);
+        const size_t digits = limbDigits(limb);
+        std::copy(padded + BASE_DIGITS - digits, padded + BASE_DIGITS, out);
+        return digits;
+    }
+    
+    // decimalLength() and toChars() for a magnitude given as limbs[0..count), shared with BigNumView
+    static size_t decimalLength(const uint32_t* limbs, size_t count, bool negative) {
+        return (negative ? 1 : 0) + limbDigits(limbs[count - 1]) + (count - 1) * BASE_DIGITS;
+    }
+    
+    static size_t toChars(const uint32_t* limbs, size_t count, bool negative, char* buffer, size_t capacity) {
+        const size_t length = decimalLength(limbs, count, negative);
+        if (length > capacity) {
+            return 0;
+        }
+        char* out = buffer;
+        if (negative) {
+            *out++ = '-';
+        }
+        
+        // The most significant limb is printed without padding, every other limb as 9 digits
+        out += writeLimbUnpadded(out, limbs[count - 1]);
+        for (size_t i = count - 1; i-- > 0;) {
+            writeLimbPadded(out, limbs[i]);
+            out += BASE_DIGITS;
+        }
+        return length;
+    }
+    
+    // 32-bit little-endian words of the binary format, whatever the host byte order
+    static void storeWord(char* out, uint32_t word) {
+#if BIGNUM_LITTLE_ENDIAN
+        std::memcpy(out, &word, sizeof(word));
+#else
+        for (int i = 0; i < 4; ++i) {
+            out[i] = static_cast<char>(word >> (8 * i));
+        }
+#endif
+    }
+    
+    static uint32_t loadWord(const char* in) {
+        uint32_t word;
+#if BIGNUM_LITTLE_ENDIAN
+        std::memcpy(&word, in, sizeof(word));
+#else
+        word = 0;
+        for (int i = 0; i < 4; ++i) {
+            word |= static_cast<uint32_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+        }
+#endif
+        return word;
+    }
+    
+    // Checks that limbs[0..count) is a canonical magnitude for the given sign: every limb
+    // below BASE, no leading zero limbs and no negative zero
+    static bool isCanonical(const uint32_t* limbs, size_t count, bool negative) {
+        if (count == 0 || (count > 1 && limbs[count - 1] == 0)) {
+            return false;
+        }
+        if (negative && count == 1 && limbs[0] == 0) {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (limbs[i] >= BASE) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // Parses an optionally signed decimal string into this number; an empty string or a
+    // bare sign reads as zero. Each 9-digit chunk is validated once rather than per digit.
+    void parseDecimal(const char* text, size_t length) {
+        limbs.clear();
+        isNegative = false;
+        size_t start = 0;
+        if (length > 0 && (text[0] == '-' || text[0] == '+')) {
+            isNegative = (text[0] == '-');
+            start = 1;
+        }
+        if (start >= length) {
+            limbs.push_back(0);
+            isNegative = false;
+            return;
+        }
+        
+        // Parse 9-digit chunks, starting from the least significant end
+        limbs.reserve((length - start + BASE_DIGITS - 1) / BASE_DIGITS);
+        size_t end = length;
+        while (end > start) {
+            size_t chunkStart = (end - start > BASE_DIGITS) ? end - BASE_DIGITS : start;
+            uint32_t limb = 0;
+            unsigned invalid = 0;
+            for (size_t i = chunkStart; i < end; ++i) {
+                unsigned digit = static_cast<unsigned char>(text[i]) - '0';
+                invalid |= (digit > 9);
+                limb = limb * 10 + digit;
+            }
+            if (invalid) {
+                throw std::invalid_argument("Invalid character in number string");
+            }
+            limbs.push_back(limb);
+            end = chunkStart;
+        }
+        
+        removeLeadingZeros();
+    }
+    
+    // --- Vectorized carry propagation for addition and subtraction ---
+    //
+    // A block of limbs is added lane by lane. A lane generates a carry when its sum reaches
+    // BASE and propagates an incoming one when it sums to exactly BASE - 1. With those as
+    // bit masks g and p, the carries into the lanes are ((g << 1) + p + carryIn) ^ p: the
+    // integer addition moves a carry through a whole run of propagating lanes at once, and
+    // the bit just above the lanes is the carry into the next block. Subtraction works the
+    // same way with borrows, where a lane that came out as 0 propagates.
+    
+    static int detectSimdLevel() {
+#if BIGNUM_X86_SIMD
+        return __builtin_cpu_supports("avx2") ? 2 : 1;
+#else
+        return 0;
+#endif
+    }
+    
+    // out[i] = x[i] + y[i] + carry-in for i < count; returns the carry out. out may be x or y.
+    static uint32_t addLimbsScalar(const uint32_t* x, const uint32_t* y, uint32_t* out, size_t count, uint32_t carry) {
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t digit = x[i] + y[i] + carry; // < 2 * 10^9, fits in 32 bits
+            carry = (digit >= BASE) ? 1 : 0;
+            out[i] = digit - carry * BASE;
+        }
+        return carry;
+    }
+    
+    // out[i] = x[i] - y[i] - borrow-in for i < count; returns the borrow out
+    static uint32_t subtractLimbsScalar(const uint32_t* x, const uint32_t* y, uint32_t* out, size_t count, uint32_t borrow) {
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t subtrahend = y[i] + borrow;
+            uint32_t digit = x[i] - subtrahend; // Wraps around when a borrow is needed
+            borrow = (x[i] < subtrahend) ? 1 : 0;
+            out[i] = digit + borrow * BASE;
+        }
+        return borrow;
+    }
+    
+#if BIGNUM_X86_SIMD
+    // Limbs are below 2^30, so the signed 32-bit compares act as unsigned ones
+    static uint32_t addLimbsSse2(const uint32_t* x, const uint32_t* y, uint32_t* out, size_t count, uint32_t carry) {
+        const __m128i base = _mm_set1_epi32(static_cast<int>(BASE));
+        const __m128i top = _mm_set1_epi32(static_cast<int>(BASE - 1));
+        const __m128i laneBits = _mm_setr_epi32(1, 2, 4, 8);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i sum = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)),
+                                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i)));
+            __m128i generate = _mm_cmpgt_epi32(sum, top);
+            sum = _mm_sub_epi32(sum, _mm_and_si128(generate, base));
+            __m128i propagate = _mm_cmpeq_epi32(sum, top);
+            unsigned g = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(generate)));
+            unsigned p = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(propagate)));
+            unsigned carries = ((g << 1) + p + carry) ^ p;
+            carry = carries >> 4;
+            __m128i carryIn = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(static_cast<int>(carries)), laneBits), laneBits);
+            sum = _mm_sub_epi32(sum, carryIn); // carryIn lanes are -1
+            sum = _mm_andnot_si128(_mm_and_si128(carryIn, propagate), sum); // BASE - 1 + 1 wraps to 0
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), sum);
+        }
+        return addLimbsScalar(x + i, y + i, out + i, count - i, carry);
+    }
+    
+    static uint32_t subtractLimbsSse2(const uint32_t* x, const uint32_t* y, uint32_t* out, size_t count, uint32_t borrow) {
+        const __m128i base = _mm_set1_epi32(static_cast<int>(BASE));
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i laneBits = _mm_setr_epi32(1, 2, 4, 8);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i));
+            __m128i generate = _mm_cmpgt_epi32(b, a);
+            __m128i diff = _mm_add_epi32(_mm_sub_epi32(a, b), _mm_and_si128(generate, base));
+            __m128i propagate = _mm_cmpeq_epi32(diff, zero);
+            unsigned g = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(generate)));
+            unsigned p = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(propagate)));
+            unsigned borrows = ((g << 1) + p + borrow) ^ p;
+            borrow = borrows >> 4;
+            __m128i borrowIn = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(static_cast<int>(borrows)), laneBits), laneBits);
+            diff = _mm_add_epi32(diff, borrowIn); // borrowIn lanes are -1
+            diff = _mm_add_epi32(diff, _mm_and_si128(_mm_and_si128(borrowIn, propagate), base)); // 0 - 1 becomes BASE - 1
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), diff);
+        }
+        return subtractLimbsScalar(x + i, y + i, out + i, count - i, borrow);
+    }
+    
+    __attribute__((target("avx2")))
+    static uint32_t addLimbsAvx2(const uint32_t* x, const uint32_t* y, uint32_t* out, size_t count, uint32_t carry) {
+        const __m256i base = _mm256_set1_epi32(static_cast<int>(BASE));
+        const __m256i top = _mm256_set1_epi32(static_cast<int>(BASE - 1));
+        const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i sum = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)),
+                                           _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i)));
+            __m256i generate = _mm256_cmpgt_epi32(sum, top);
+            sum = _mm256_sub_epi32(sum, _mm256_and_si256(generate, base));
+            __m256i propagate = _mm256_cmpeq_epi32(sum, top);
+            unsigned g = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(generate)));
+            unsigned p = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(propagate)));
+            unsigned carries = ((g << 1) + p + carry) ^ p;
+            carry = carries >> 8;
+            __m256i carryIn = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(carries)), laneBits), laneBits);
+            sum = _mm256_sub_epi32(sum, carryIn);
+            sum = _mm256_andnot_si256(_mm256_and_si256(carryIn, propagate), sum);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), sum);
+        }
+        return addLimbsSse2(x + i, y + i, out + i, count - i, carry);
+    }
+    
+    __attribute__((target("avx2")))
+    static uint32_t subtractLimbsAvx2(const uint32_t* x, const uint32_t* y, uint32_t* out, size_t count, uint32_t borrow) {
+        const __m256i base = _mm256_set1_epi32(static_cast<int>(BASE));
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i));
+            __m256i generate = _mm256_cmpgt_epi32(b, a);
+            __m256i diff = _mm256_add_epi32(_mm256_sub_epi32(a, b), _mm256_and_si256(generate, base));
+            __m256i propagate = _mm256_cmpeq_epi32(diff, zero);
+            unsigned g = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(generate)));
+            unsigned p = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(propagate)));
+            unsigned borrows = ((g << 1) + p + borrow) ^ p;
+            borrow = borrows >> 8;
+            __m256i borrowIn = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(borrows)), laneBits), laneBits);
+            diff = _mm256_add_epi32(diff, borrowIn);
+            diff = _mm256_add_epi32(diff, _mm256_and_si256(_mm256_and_si256(borrowIn, propagate), base));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), diff);
+        }
+        return subtractLimbsSse2(x + i, y + i, out + i, count - i, borrow);
+    }
+#endif
+    
+    // Dispatches to the widest kernel simdLevel allows
+    static uint32_t addLimbVectors(const uint32_t* x, const uint32_t* y, uint32_t* out, size_t count, uint32_t carry) {
+#if BIGNUM_X86_SIMD
+        if (simdLevel >= 2) {
+            return addLimbsAvx2(x, y, out, count, carry);
+        }
+        if (simdLevel >= 1) {
+            return addLimbsSse2(x, y, out, count, carry);
+        }
+#endif
+        return addLimbsScalar(x, y, out, count, carry);
+    }
+    
+    static uint32_t subtractLimbVectors(const uint32_t* x, const uint32_t* y, uint32_t* out, size_t count, uint32_t borrow) {
+#if BIGNUM_X86_SIMD
+        if (simdLevel >= 2) {
+            return subtractLimbsAvx2(x, y, out, count, borrow);
+        }
+        if (simdLevel >= 1) {
+            return subtractLimbsSse2(x, y, out, count, borrow);
+        }
+#endif
+        return subtractLimbsScalar(x, y, out, count, borrow);
+    }
+    
+    // Adds p[0..count) into acc starting at limb offset, propagating the carry.
+    // The caller guarantees the true sum fits in acc.
+    static void addLimbsAt(std::vector<uint32_t>& acc, const uint32_t* p, size_t count, size_t offset) {
+        while (count > 0 && p[count - 1] == 0) {
+            --count;
+        }
+        uint32_t carry = addLimbVectors(acc.data() + offset, p, acc.data() + offset, count, 0);
+        for (size_t k = offset + count; carry && k < acc.size(); ++k) {
+            uint32_t sum = acc[k] + carry;
+            carry = (sum >= BASE) ? 1 : 0;
+            acc[k] = sum - carry * BASE;
+        }
+    }
+    
+    // Subtracts b from acc in place; the caller guarantees acc >= b
+    static void subtractLimbsInPlace(std::vector<uint32_t>& acc, const std::vector<uint32_t>& b) {
+        size_t count = b.size();
+        while (count > 0 && b[count - 1] == 0) {
+            --count;
+        }
+        uint32_t borrow = subtractLimbVectors(acc.data(), b.data(), acc.data(), count, 0);
+        for (size_t i = count; borrow && i < acc.size(); ++i) {
+            uint32_t diff = acc[i] - borrow;
+            borrow = (acc[i] < borrow) ? 1 : 0;
+            acc[i] = diff + borrow * BASE;
+        }
+    }
+    
+    // Returns a[0..n) + b[0..m), assuming n >= m; the result has n limbs plus one for a final carry
+    static std::vector<uint32_t> addLimbs(const uint32_t* a, size_t n, const uint32_t* b, size_t m) {
+        std::vector<uint32_t> sum(a, a + n);
+        sum.push_back(0);
+        addLimbsAt(sum, b, m, 0);
+        if (sum.back() == 0) {
+            sum.pop_back();
+        }
+        return sum;
+    }
+    
+    // out = |a| + |b|, untrimmed. out may be the same storage as a or b: sizes are captured
+    // before out is resized, pointers fetched after, and each limb is read before it is written.
+    static void addMagnitudes(LimbStorage& out, const LimbStorage& a, const LimbStorage& b) {
+        const bool aLonger = a.size() >= b.size();
+        const size_t longSize = aLonger ? a.size() : b.size();
+        const size_t shortSize = aLonger ? b.size() : a.size();
+        out.resize(longSize + 1);
+        const uint32_t* longer = aLonger ? a.data() : b.data();
+        const uint32_t* shorter = aLonger ? b.data() : a.data();
+        uint32_t* sum = out.data();
+        
+        uint32_t carry = addLimbVectors(longer, shorter, sum, shortSize, 0);
+        size_t i = shortSize;
+        for (; carry && i < longSize; ++i) {
+            uint32_t digit = longer[i] + carry;
+            carry = (digit >= BASE) ? 1 : 0;
+            sum[i] = digit - carry * BASE;
+        }
+        // Once the carry has died out the rest is a copy, or nothing at all in place
+        if (sum != longer) {
+            std::copy(longer + i, longer + longSize, sum + i);
+        }
+        sum[longSize] = carry;
+    }
+    
+    // out = |a| - |b| assuming |a| >= |b|, untrimmed. Aliasing rules as for addMagnitudes.
+    static void subtractMagnitudes(LimbStorage& out, const LimbStorage& a, const LimbStorage& b) {
+        const size_t n = a.size();
+        const size_t m = b.size();
+        out.resize(n);
+        const uint32_t* x = a.data();
+        const uint32_t* y = b.data();
+        uint32_t* diff = out.data();
+        
+        uint32_t borrow = subtractLimbVectors(x, y, diff, m, 0);
+        size_t i = m;
+        for (; borrow && i < n; ++i) {
+            uint32_t digit = x[i] - borrow;
+            borrow = (x[i] < borrow) ? 1 : 0;
+            diff[i] = digit + borrow * BASE;
+        }
+        if (diff != x) {
+            std::copy(x + i, x + n, diff + i);
+        }
+    }
+    
+    // out = a + b, or a - b when negateB is set. out may be a or b, which is how the
+    // compound operators and fused expressions reuse an existing limb buffer.
+    static void addSigned(BigNum& out, const BigNum& a, const BigNum& b, bool negateB) {
+        const bool aNegative = a.isNegative;
+        const bool bNegative = (b.isNegative != negateB);
+        if (aNegative == bNegative) {
+            addMagnitudes(out.limbs, a.limbs, b.limbs);
+            out.isNegative = aNegative;
+        } else if (a.compareAbsoluteValue(b) >= 0) {
+            subtractMagnitudes(out.limbs, a.limbs, b.limbs);
+            out.isNegative = aNegative;
+        } else {
+            subtractMagnitudes(out.limbs, b.limbs, a.limbs);
+            out.isNegative = bNegative;
+        }
+        out.removeLeadingZeros();
+    }
+    
+    // out = a * b, where out may be a or b. Schoolbook-sized products are written straight
+    // into out's buffer, or through a per-thread scratch buffer when out is an operand, so
+    // repeated small multiplications stop allocating once the buffers have grown.
+    static void multiplyInto(BigNum& out, const BigNum& a, const BigNum& b) {
+        const bool negative = (a.isNegative != b.isNegative);
+        if (a.isZero() || b.isZero()) {
+            out.limbs.assign(1, 0);
+            out.isNegative = false;
+            return;
+        }
+        
+        const size_t n = a.limbs.size();
+        const size_t m = b.limbs.size();
+        if (std::min(n, m) < std::max(karatsubaThreshold, size_t(4))) {
+            const bool aliased = (&out == &a || &out == &b);
+            static thread_local std::vector<uint32_t> scratch;
+            uint32_t* product;
+            if (aliased) {
+                scratch.assign(n + m, 0);
+                product = scratch.data();
+            } else {
+                out.limbs.assign(n + m, 0);
+                product = out.limbs.data();
+            }
+            if (&a == &b) {
+                schoolbookSquare(a.limbs.data(), n, product);
+            } else {
+                schoolbookMultiply(a.limbs.data(), n, b.limbs.data(), m, product);
+            }
+            if (aliased) {
+                out.limbs.assign(scratch.data(), scratch.data() + n + m);
+            }
+        } else {
+            std::vector<uint32_t> product = multiplyLimbs(a.limbs.data(), n, b.limbs.data(), m);
+            out.limbs.assign(product.data(), product.data() + product.size());
+        }
+        out.isNegative = negative;
+        out.removeLeadingZeros();
+    }
+    
+    void negate() {
+        if (!isZero()) {
+            isNegative = !isNegative;
+        }
+    }
+    
+    // --- Fused evaluation of expression templates ---
+    
+    // An operand of a fused sum, captured before the destination is resized
+    struct Addend {
+        const uint32_t* limbs;
+        size_t size;
+        int64_t sign; // +1 or -1
+    };
+    
+    // Evaluates expr into this, or this + expr / this - expr when accumulating
+    template <typename Expr>
+    void assignExpression(const Expr& expr, bool accumulate, bool subtract) {
+        BigNumTerm terms[Expr::termCount + 1];
+        Addend addends[Expr::termCount + 1];
+        BigNumTerm* cursor = terms;
+        if (accumulate) {
+            *cursor++ = BigNumTerm{this, nullptr, false};
+        }
+        expr.collect(cursor, subtract);
+        assignTerms(*this, terms, addends, static_cast<size_t>(cursor - terms));
+    }
+    
+    // out = the signed sum of terms[0..count), where out may appear among the operands and
+    // addends has room for count entries. Products are formed first, one of them directly in
+    // out unless out is still to be read, then everything is added up in a single pass.
+    static void assignTerms(BigNum& out, BigNumTerm* terms, Addend* addends, size_t count) {
+        bool outIsOperand = false;
+        bool outIsFactor = false;
+        size_t products = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (terms[i].y) {
+                ++products;
+                outIsFactor = outIsFactor || terms[i].x == &out || terms[i].y == &out;
+            } else {
+                outIsOperand = outIsOperand || terms[i].x == &out;
+            }
+        }
+        if (products == 0 && !outIsOperand && adoptSpare(out, terms, count)) {
+            outIsOperand = true;
+        }
+        if (outIsFactor && count > 1) {
+            // Forming a product in out would overwrite a factor other terms still need
+            BigNum result;
+            assignTerms(result, terms, addends, count);
+            out = std::move(result);
+            return;
+        }
+        if (products == 0 && count == 2) {
+            // A single + or -: addSigned covers the sign cases and any aliasing
+            const BigNumTerm& first = terms[0].negative ? terms[1] : terms[0];
+            const BigNumTerm& second = terms[0].negative ? terms[0] : terms[1];
+            addSigned(out, *first.x, *second.x, first.negative != second.negative);
+            if (first.negative) {
+                out.negate();
+            }
+            return;
+        }
+        
+        // Reserved up front: the terms keep pointers into it
+        std::vector<BigNum> scratch;
+        bool outFree = !outIsOperand;
+        if (products > (outFree ? 1 : 0)) {
+            scratch.reserve(products - (outFree ? 1 : 0));
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (!terms[i].y) {
+                continue;
+            }
+            BigNum* target = &out;
+            if (outFree) {
+                outFree = false;
+            } else {
+                scratch.emplace_back();
+                target = &scratch.back();
+            }
+            multiplyInto(*target, *terms[i].x, *terms[i].y);
+            terms[i] = BigNumTerm{target, nullptr, terms[i].negative};
+        }
+        
+        if (count == 1) {
+            if (terms[0].x != &out) {
+                out = *terms[0].x;
+            }
+            if (terms[0].negative) {
+                out.negate();
+            }
+            return;
+        }
+        sumAddends(out, terms, addends, count);
+    }
+    
+    // When out is too small for the sum of the plain operands terms[0..count) and a spare
+    // operand is not, moves that operand into out and points its term at out, so the sum is
+    // formed in place in the operand's buffer. An operand that also appears in another term
+    // is left alone, as that term still reads it.
+    static bool adoptSpare(BigNum& out, BigNumTerm* terms, size_t count) {
+        size_t needed = 0; // Longest operand plus a carry limb, as the add kernels size it
+        for (size_t i = 0; i < count; ++i) {
+            needed = std::max(needed, terms[i].x->limbs.size() + 1);
+        }
+        if (out.limbs.capacity() >= needed) {
+            return false;
+        }
+        BigNumTerm* donor = nullptr;
+        for (size_t i = 0; i < count && !donor; ++i) {
+            if (terms[i].spare && terms[i].spare->limbs.capacity() >= needed) {
+                donor = &terms[i];
+            }
+        }
+        if (!donor) {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (&terms[i] != donor && terms[i].x == donor->x) {
+                return false;
+            }
+        }
+        out = std::move(*donor->spare);
+        *donor = BigNumTerm{&out, nullptr, donor->negative};
+        return true;
+    }
+    
+    // out = the signed sum of the plain operands terms[0..count) in one pass over the limbs.
+    // Every operand limb is read before the output limb at the same index is written, so out
+    // may be one of the operands.
+    static void sumAddends(BigNum& out, const BigNumTerm* terms, Addend* addends, size_t count) {
+        size_t longest = 0;
+        size_t shortest = SIZE_MAX;
+        for (size_t k = 0; k < count; ++k) {
+            const BigNum& x = *terms[k].x;
+            addends[k].size = x.limbs.size();
+            addends[k].sign = (terms[k].negative != x.isNegative) ? -1 : 1;
+            longest = std::max(longest, addends[k].size);
+            shortest = std::min(shortest, addends[k].size);
+        }
+        // |sum| < count * BASE^longest, so one more limb takes the carry and the carry out of
+        // the top limb is 0 for a non-negative sum and -1 for a negative one
+        const size_t n = longest + 1;
+        out.limbs.resize(n);
+        for (size_t k = 0; k < count; ++k) {
+            addends[k].limbs = terms[k].x->limbs.data(); // Fetched after the resize
+        }
+        uint32_t* result = out.limbs.data();
+        
+        int64_t carry = 0;
+        auto store = [&](size_t i, int64_t sum) {
+            carry = sum / BASE;
+            int64_t digit = sum % BASE;
+            if (digit < 0) {
+                digit += BASE;
+                --carry;
+            }
+            result[i] = static_cast<uint32_t>(digit);
+        };
+        size_t i = 0;
+        for (; i < shortest; ++i) {
+            int64_t sum = carry;
+            for (size_t k = 0; k < count; ++k) {
+                sum += addends[k].sign * addends[k].limbs[i];
+            }
+            store(i, sum);
+        }
+        for (; i < n; ++i) {
+            int64_t sum = carry;
+            for (size_t k = 0; k < count; ++k) {
+                if (i < addends[k].size) {
+                    sum += addends[k].sign * addends[k].limbs[i];
+                }
+            }
+            store(i, sum);
+        }
+        
+        // A negative sum left BASE^n + sum in the limbs: its complement is the magnitude
+        out.isNegative = (carry < 0);
+        if (out.isNegative) {
+            uint32_t borrow = 0;
+            for (size_t k = 0; k < n; ++k) {
+                uint32_t subtrahend = result[k] + borrow;
+                result[k] = (subtrahend == 0) ? 0 : BASE - subtrahend;
+                borrow = (subtrahend == 0) ? 0 : 1;
+            }
+        }
+        out.removeLeadingZeros();
+    }
+    
+    // Long multiplication into out[0..n+m), which the caller has zeroed
+    static void schoolbookMultiply(const uint32_t* a, size_t n, const uint32_t* b, size_t m, uint32_t* out) {
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t multiplier = a[i];
+            if (multiplier == 0) {
+                continue;
+            }
+            uint64_t carry = 0;
+            for (size_t j = 0; j < m; ++j) {
+                // At most (10^9 - 1)^2 + 2 * 10^9, well inside 64 bits
+                uint64_t product = out[i + j] + multiplier * b[j] + carry;
+                out[i + j] = static_cast<uint32_t>(product % BASE);
+                carry = product / BASE;
+            }
+            // Rows never reach this slot before row i, so the carry can be stored directly
+            out[i + m] = static_cast<uint32_t>(carry);
+        }
+    }
+    
+    // Long squaring into out[0..2n), which the caller has zeroed. Each cross product
+    // a[i]*a[j] (i < j) is computed once and doubled, roughly halving the work.
+    static void schoolbookSquare(const uint32_t* a, size_t n, uint32_t* out) {
+        for (size_t i = 0; i + 1 < n; ++i) {
+            uint64_t multiplier = a[i];
+            if (multiplier == 0) {
+                continue;
+            }
+            uint64_t carry = 0;
+            for (size_t j = i + 1; j < n; ++j) {
+                uint64_t product = out[i + j] + multiplier * a[j] + carry;
+                out[i + j] = static_cast<uint32_t>(product % BASE);
+                carry = product / BASE;
+            }
+            out[i + n] = static_cast<uint32_t>(carry);
+        }
+        // Double the cross products and add the squares on the diagonal
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t square = static_cast<uint64_t>(a[i]) * a[i];
+            uint64_t low = 2ULL * out[2 * i] + square % BASE + carry;
+            out[2 * i] = static_cast<uint32_t>(low % BASE);
+            uint64_t high = 2ULL * out[2 * i + 1] + square / BASE + low / BASE;
+            out[2 * i + 1] = static_cast<uint32_t>(high % BASE);
+            carry = high / BASE;
+        }
+    }
+    
+    // Divides a 128-bit accumulator below 2^96 by BASE in place and returns the remainder.
+    // Splitting it as high * 2^32 + low turns the slow 128-bit division into two 64-bit
+    // divisions by a constant, which compile to multiplications.
+    static uint32_t divideByBase(unsigned __int128& value) {
+        uint64_t high = static_cast<uint64_t>(value >> 32);
+        uint64_t low = static_cast<uint64_t>(value) & 0xFFFFFFFFULL;
+        uint64_t highQuotient = high / BASE;
+        uint64_t rest = ((high % BASE) << 32) | low; // < 10^9 * 2^32, fits in 64 bits
+        value = (static_cast<unsigned __int128>(highQuotient) << 32) + rest / BASE;
+        return static_cast<uint32_t>(rest % BASE);
+    }
+    
+    // --- Number-theoretic transform (NTT) multiplication ---
+    //
+    // The limbs are convolved exactly modulo three NTT-friendly primes and the true
+    // coefficients are rebuilt with the Chinese remainder theorem. A coefficient is a
+    // sum of at most NTT_MAX_LENGTH products below 10^18, which stays under the ~7.9e25
+    // product of the primes, so no further splitting of the limbs is needed.
+    static constexpr uint32_t NTT_PRIME_1 = 998244353; // 119 * 2^23 + 1
+    static constexpr uint32_t NTT_PRIME_2 = 167772161; //   5 * 2^25 + 1
+    static constexpr uint32_t NTT_PRIME_3 = 469762049; //   7 * 2^26 + 1
+    static constexpr uint32_t NTT_ROOT = 3;            // Primitive root of all three primes
+    static constexpr size_t NTT_MAX_LENGTH = size_t(1) << 23; // Largest power of two dividing every p - 1
+    
+    static constexpr uint32_t powModWord(uint64_t base, uint64_t exponent, uint32_t mod) {
+        uint64_t result = 1;
+        base %= mod;
+        while (exponent > 0) {
+            if (exponent & 1) {
+                result = result * base % mod;
+            }
+            base = base * base % mod;
+            exponent >>= 1;
+        }
+        return static_cast<uint32_t>(result);
+    }
+    
+    // Montgomery arithmetic modulo an NTT prime with R = 2^32: reduce(t) = t * R^-1 mod MOD
+    // for any t < MOD * 2^32, using two multiplications instead of a 64-bit division.
+    // Twiddles are kept in Montgomery form, so reduce(x * twiddle) is a plain product.
+    static constexpr uint32_t montgomeryNegInverse(uint32_t mod) {
+        uint32_t inverse = mod; // Newton iteration; each step doubles the correct low bits
+        for (int i = 0; i < 5; ++i) {
+            inverse *= 2 - mod * inverse;
+        }
+        return 0u - inverse;
+    }
+    
+    template <uint32_t MOD>
+    static uint32_t montgomeryReduce(uint64_t t) {
+        constexpr uint32_t negInverse = montgomeryNegInverse(MOD);
+        uint32_t q = static_cast<uint32_t>(t) * negInverse;
+        uint32_t u = static_cast<uint32_t>((t + static_cast<uint64_t>(q) * MOD) >> 32);
+        return (u >= MOD) ? u - MOD : u;
+    }
+    
+    // Twiddle table for a transform of the given size, in Montgomery form:
+    // roots[half + k] = w^k for the stage of length 2 * half, where w is that stage's root
+    // of unity (inverted for the inverse transform). Each stage's twiddles are contiguous.
+    template <uint32_t MOD>
+    static std::vector<uint32_t> nttRoots(size_t size, bool inverse) {
+        constexpr uint64_t rModP = (uint64_t(1) << 32) % MOD;
+        std::vector<uint32_t> roots(size);
+        const size_t half = size / 2;
+        uint64_t step = powModWord(NTT_ROOT, (MOD - 1) / size, MOD);
+        if (inverse) {
+            step = powModWord(step, MOD - 2, MOD);
+        }
+        const uint64_t stepMontgomery = step * rModP % MOD;
+        roots[half] = static_cast<uint32_t>(rModP);
+        for (size_t k = 1; k < half; ++k) {
+            roots[half + k] = montgomeryReduce<MOD>(roots[half + k - 1] * stepMontgomery);
+        }
+        // The root of a stage of half the length is the square of the current one
+        for (size_t h = half / 2; h >= 1; h /= 2) {
+            for (size_t k = 0; k < h; ++k) {
+                roots[h + k] = roots[2 * h + 2 * k];
+            }
+        }
+        return roots;
+    }
+    
+    // Blocks of up to this many elements (64 KB) are transformed with all of their
+    // remaining stages back to back, while they are still in cache
+    static constexpr size_t NTT_CACHE_BLOCK = size_t(1) << 14;
+    
+    // Loops shorter than two grains stay on the calling thread
+    static constexpr size_t PARALLEL_GRAIN = 4096;
+    
+    static inline std::unique_ptr<WorkerPool> multiplyPool; // Null while multiplication is serial
+    
+    // The pool to spread a product over, or null when it is serial or the shorter operand
+    // (in limbs) is below parallelThreshold
+    static WorkerPool* parallelPool(size_t shorterLimbs) {
+        return (multiplyPool && shorterLimbs >= parallelThreshold) ? multiplyPool.get() : nullptr;
+    }
+    
+    // Runs body(0) .. body(count - 1) on the pool, or in order on this thread without one
+    template <typename Fn>
+    static void forEachIndex(WorkerPool* pool, size_t count, Fn&& body) {
+        if (pool) {
+            pool->parallelFor(count, body);
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                body(i);
+            }
+        }
+    }
+    
+    // Runs body(begin, end) over chunks of [0, count): one chunk per few pool threads, or a
+    // single chunk on this thread without a pool or for short loops
+    template <typename Fn>
+    static void parallelRange(WorkerPool* pool, size_t count, Fn&& body) {
+        if (!pool || count < 2 * PARALLEL_GRAIN) {
+            body(size_t(0), count);
+            return;
+        }
+        const size_t chunks = std::min<size_t>(count / PARALLEL_GRAIN, pool->size() * 4);
+        pool->parallelFor(chunks, [&](size_t c) {
+            body(count * c / chunks, count * (c + 1) / chunks);
+        });
+    }
+    
+    // Butterflies k in [begin, end) of one DIF stage over the block pair lo / hi
+    template <uint32_t MOD>
+    static void forwardButterflies(uint32_t* lo, uint32_t* hi, const uint32_t* twiddles, size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            uint32_t u = lo[k];
+            uint32_t v = hi[k];
+            lo[k] = (u + v >= MOD) ? u + v - MOD : u + v;
+            hi[k] = montgomeryReduce<MOD>(static_cast<uint64_t>(u + MOD - v) * twiddles[k]);
+        }
+    }
+    
+    // Butterflies k in [begin, end) of one DIT stage over the block pair lo / hi
+    template <uint32_t MOD>
+    static void inverseButterflies(uint32_t* lo, uint32_t* hi, const uint32_t* twiddles, size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            uint32_t u = lo[k];
+            uint32_t v = montgomeryReduce<MOD>(static_cast<uint64_t>(hi[k]) * twiddles[k]);
+            lo[k] = (u + v >= MOD) ? u + v - MOD : u + v;
+            hi[k] = (u >= v) ? u - v : u + MOD - v;
+        }
+    }
+    
+    // Forward transform, decimation in frequency: natural order in, bit-reversed order out.
+    // Above the cache block, one stage is done over the whole array and the two halves are
+    // transformed recursively, which keeps the working set cache-sized (no bit-reversal pass)
+    // and gives a pool independent halves and butterfly ranges to spread across threads.
+    template <uint32_t MOD>
+    static void nttForward(uint32_t* data, size_t length, const uint32_t* roots, WorkerPool* pool = nullptr) {
+        if (length > NTT_CACHE_BLOCK) {
+            const size_t half = length / 2;
+            parallelRange(pool, half, [&](size_t begin, size_t end) {
+                forwardButterflies<MOD>(data, data + half, roots + half, begin, end);
+            });
+            forEachIndex(pool, 2, [&](size_t i) { nttForward<MOD>(data + i * half, half, roots, pool); });
+            return;
+        }
+        for (size_t stage = length; stage >= 2; stage /= 2) {
+            const size_t half = stage / 2;
+            for (size_t start = 0; start < length; start += stage) {
+                forwardButterflies<MOD>(data + start, data + start + half, roots + half, 0, half);
+            }
+        }
+    }
+    
+    // Inverse transform, decimation in time: bit-reversed order in, natural order out,
+    // scaled by the transform size (the caller removes that factor)
+    template <uint32_t MOD>
+    static void nttInverse(uint32_t* data, size_t length, const uint32_t* roots, WorkerPool* pool = nullptr) {
+        if (length > NTT_CACHE_BLOCK) {
+            const size_t half = length / 2;
+            forEachIndex(pool, 2, [&](size_t i) { nttInverse<MOD>(data + i * half, half, roots, pool); });
+            parallelRange(pool, half, [&](size_t begin, size_t end) {
+                inverseButterflies<MOD>(data, data + half, roots + half, begin, end);
+            });
+            return;
+        }
+        for (size_t stage = 2; stage <= length; stage *= 2) {
+            const size_t half = stage / 2;
+            for (size_t start = 0; start < length; start += stage) {
+                inverseButterflies<MOD>(data + start, data + start + half, roots + half, 0, half);
+            }
+        }
+    }
+    
+    // Cyclic convolution of a and b modulo MOD with the given transform size (b unused when squaring)
+    template <uint32_t MOD>
+    static std::vector<uint32_t> nttConvolve(const uint32_t* a, size_t n, const uint32_t* b, size_t m,
+                                             bool squaring, size_t size, WorkerPool* pool) {
+        const std::vector<uint32_t> roots = nttRoots<MOD>(size, false);
+        std::vector<uint32_t> fa(size, 0);
+        parallelRange(pool, n, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                fa[i] = a[i] % MOD;
+            }
+        });
+        nttForward<MOD>(fa.data(), size, roots.data(), pool);
+        // The pointwise products come out as x * y * R^-1; that stray factor and the 1/size
+        // of the inverse transform are removed together by one final Montgomery multiply
+        if (squaring) {
+            parallelRange(pool, size, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    fa[i] = montgomeryReduce<MOD>(static_cast<uint64_t>(fa[i]) * fa[i]);
+                }
+            });
+        } else {
+            std::vector<uint32_t> fb(size, 0);
+            parallelRange(pool, m, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    fb[i] = b[i] % MOD;
+                }
+            });
+            nttForward<MOD>(fb.data(), size, roots.data(), pool);
+            parallelRange(pool, size, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    fa[i] = montgomeryReduce<MOD>(static_cast<uint64_t>(fa[i]) * fb[i]);
+                }
+            });
+        }
+        nttInverse<MOD>(fa.data(), size, nttRoots<MOD>(size, true).data(), pool);
+        constexpr uint64_t rModP = (uint64_t(1) << 32) % MOD;
+        const uint64_t scale = powModWord(size, MOD - 2, MOD) * rModP % MOD * rModP % MOD;
+        parallelRange(pool, size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                fa[i] = montgomeryReduce<MOD>(fa[i] * scale);
+            }
+        });
+        return fa;
+    }
+    
+    // Multiplies via three-prime NTT + CRT into the zeroed n + m limb result.
+    // Requires n + m <= NTT_MAX_LENGTH.
+    static void nttMultiply(const uint32_t* a, size_t n, const uint32_t* b, size_t m,
+                            std::vector<uint32_t>& result) {
+        const bool squaring = (a == b && n == m);
+        size_t size = 1;
+        while (size < n + m) {
+            size <<= 1;
+        }
+        WorkerPool* pool = parallelPool(std::min(n, m));
+        std::vector<uint32_t> residues[3];
+        auto convolve = [&](size_t prime) {
+            switch (prime) {
+                case 0: residues[0] = nttConvolve<NTT_PRIME_1>(a, n, b, m, squaring, size, pool); break;
+                case 1: residues[1] = nttConvolve<NTT_PRIME_2>(a, n, b, m, squaring, size, pool); break;
+                default: residues[2] = nttConvolve<NTT_PRIME_3>(a, n, b, m, squaring, size, pool); break;
+            }
+        };
+        forEachIndex(pool, 3, convolve);
+        const std::vector<uint32_t>& r1 = residues[0];
+        const std::vector<uint32_t>& r2 = residues[1];
+        const std::vector<uint32_t>& r3 = residues[2];
+        
+        // Garner's CRT: c = x1 + x2 * p1 + x3 * p1 * p2 with x_i < p_i
+        constexpr uint64_t p1 = NTT_PRIME_1, p2 = NTT_PRIME_2, p3 = NTT_PRIME_3;
+        constexpr uint64_t p1InvModP2 = powModWord(p1, p2 - 2, p2);
+        constexpr uint64_t p1p2InvModP3 = powModWord(p1 * p2 % p3, p3 - 2, p3);
+        constexpr uint64_t p1ModP3 = p1 % p3;
+        constexpr uint64_t p1p2 = p1 * p2;
+        
+        // Each range is carried on its own starting from zero; the carries leaving each range
+        // are then pushed into the next one in order
+        const size_t ranges = pool ? std::min<size_t>(pool->size() * 4, (n + m) / PARALLEL_GRAIN + 1) : 1;
+        std::vector<unsigned __int128> carryOut(ranges);
+        auto garner = [&](size_t range) {
+            const size_t begin = (n + m) * range / ranges;
+            const size_t end = (n + m) * (range + 1) / ranges;
+            unsigned __int128 carry = 0;
+            for (size_t i = begin; i < end; ++i) {
+                uint64_t x1 = r1[i];
+                uint64_t x2 = (r2[i] + p2 - x1 % p2) % p2 * p1InvModP2 % p2;
+                uint64_t t = (r3[i] + p3 - x1 % p3) % p3;
+                t = (t + p3 - x2 * p1ModP3 % p3) % p3;
+                uint64_t x3 = t * p1p2InvModP3 % p3;
+                
+                carry += x1 + static_cast<unsigned __int128>(x2) * p1 + static_cast<unsigned __int128>(x3) * p1p2;
+                result[i] = divideByBase(carry); // The running value stays below 2^88
+            }
+            carryOut[range] = carry;
+        };
+        forEachIndex(pool, ranges, garner);
+        for (size_t range = 1; range < ranges; ++range) {
+            unsigned __int128 carry = carryOut[range - 1];
+            size_t i = (n + m) * range / ranges;
+            const size_t end = (n + m) * (range + 1) / ranges;
+            for (; carry != 0 && i < end; ++i) {
+                carry += result[i];
+                result[i] = divideByBase(carry);
+            }
+            carryOut[range] += carry;
+        }
+    }
+    
+    // Multiplies a[0..n) by b[0..m), picking schoolbook, Karatsuba, Toom-3 or NTT by operand
+    // size. Passing the same pointer and length twice takes the squaring paths.
+    // Always returns exactly n + m limbs (possibly with leading zeros).
+    static std::vector<uint32_t> multiplyLimbs(const uint32_t* a, size_t n, const uint32_t* b, size_t m) {
+        if (n < m) {
+            std::swap(a, b);
+            std::swap(n, m);
+        }
+        std::vector<uint32_t> result(n + m, 0);
+        if (m == 0) {
+            return result;
+        }
+        // Karatsuba needs at least 4 limbs to make progress, whatever the tuned threshold says
+        if (m < std::max<size_t>(karatsubaThreshold, 4)) {
+            if (a == b && n == m) {
+                schoolbookSquare(a, n, result.data());
+            } else {
+                schoolbookMultiply(a, n, b, m, result.data());
+            }
+            return result;
+        }
+        if (m >= nttThreshold && n + m <= NTT_MAX_LENGTH) {
+            nttMultiply(a, n, b, m, result);
+            return result;
+        }
+        if (n >= 2 * m) {
+            // Unbalanced operands: multiply m-limb slices of the longer one and accumulate,
+            // so that the splitting algorithms below always see comparable sizes
+            for (size_t offset = 0; offset < n; offset += m) {
+                size_t length = std::min(m, n - offset);
+                std::vector<uint32_t> part = multiplyLimbs(a + offset, length, b, m);
+                addLimbsAt(result, part.data(), part.size(), offset);
+            }
+            return result;
+        }
+        if (m >= toom3Threshold) {
+            toom3Multiply(a, n, b, m, result);
+        } else {
+            karatsubaMultiply(a, n, b, m, result);
+        }
+        return result;
+    }
+    
+    // Karatsuba: with x = BASE^k, (a1 x + a0)(b1 x + b0) = z2 x^2 + z1 x + z0 where
+    // z1 = (a0 + a1)(b0 + b1) - z0 - z2, so three half-size products replace four.
+    // Requires n >= m > n / 2; writes into the zeroed n + m limb result.
+    static void karatsubaMultiply(const uint32_t* a, size_t n, const uint32_t* b, size_t m,
+                                  std::vector<uint32_t>& result) {
+        size_t k = (n + 1) / 2; // m >= k, so b1 may be empty but b0 is full
+        std::vector<uint32_t> aSum = addLimbs(a, k, a + k, n - k);
+        std::vector<uint32_t> bSum;
+        if (!(a == b && n == m)) {
+            bSum = addLimbs(b, k, b + k, m - k);
+        }
+        const std::vector<uint32_t>& bSide = (a == b && n == m) ? aSum : bSum; // Keeps z1 a square
+        
+        // The three products are independent, so a multiplication pool can run them at once
+        std::vector<uint32_t> z0, z1, z2;
+        forEachIndex(parallelPool(m), 3, [&](size_t which) {
+            if (which == 0) {
+                z0 = multiplyLimbs(a, k, b, k);
+            } else if (which == 1) {
+                z2 = multiplyLimbs(a + k, n - k, b + k, m - k);
+            } else {
+                z1 = multiplyLimbs(aSum.data(), aSum.size(), bSide.data(), bSide.size());
+            }
+        });
+        subtractLimbsInPlace(z1, z0);
+        subtractLimbsInPlace(z1, z2);
+        
+        addLimbsAt(result, z0.data(), z0.size(), 0);
+        addLimbsAt(result, z1.data(), z1.size(), k);
+        addLimbsAt(result, z2.data(), z2.size(), 2 * k);
+    }
+    
+    // Toom-3: splits each operand into three k-limb pieces, evaluates the pieces as
+    // polynomials at 0, 1, -1, -2 and infinity, multiplies pointwise (five products
+    // instead of nine) and interpolates with Bodrato's sequence. The intermediate
+    // values can be negative, so they are carried as signed BigNums.
+    // Requires n >= m > n / 2; writes into the zeroed n + m limb result.
+    static void toom3Multiply(const uint32_t* a, size_t n, const uint32_t* b, size_t m,
+                              std::vector<uint32_t>& result) {
+        size_t k = (n + 2) / 3; // m > n / 2 >= k, so b0 is full and b1 is non-empty
+        BigNum a0 = fromLimbs(a, k);
+        BigNum a1 = fromLimbs(a + k, std::min(k, n - k));
+        BigNum a2 = fromLimbs(a + 2 * k, n - 2 * k);
+        
+        // Evaluation
+        BigNum aTmp = a0 + a2;
+        BigNum aAt1 = aTmp + a1;
+        BigNum aAtMinus1 = aTmp - a1;
+        BigNum aAtMinus2 = (aAtMinus1 + a2) + (aAtMinus1 + a2) - a0;
+        
+        // Pointwise products (recursing through operator*); squaring reuses the a side,
+        // so every product below is itself a square
+        const BigNum* left[5] = {&a0, &aAt1, &aAtMinus1, &aAtMinus2, &a2};
+        const BigNum* right[5] = {&a0, &aAt1, &aAtMinus1, &aAtMinus2, &a2};
+        BigNum b0, b1, b2, bAt1, bAtMinus1, bAtMinus2;
+        if (!(a == b && n == m)) {
+            b0 = fromLimbs(b, k);
+            b1 = fromLimbs(b + k, std::min(k, m - k));
+            b2 = (m > 2 * k) ? fromLimbs(b + 2 * k, m - 2 * k) : BigNum();
+            BigNum bTmp = b0 + b2;
+            bAt1 = bTmp + b1;
+            bAtMinus1 = bTmp - b1;
+            bAtMinus2 = (bAtMinus1 + b2) + (bAtMinus1 + b2) - b0;
+            const BigNum* bPoints[5] = {&b0, &bAt1, &bAtMinus1, &bAtMinus2, &b2};
+            std::copy(bPoints, bPoints + 5, right);
+        }
+        BigNum products[5];
+        forEachIndex(parallelPool(m), 5, [&](size_t i) {
+            products[i] = *left[i] * *right[i];
+        });
+        BigNum& r0 = products[0];
+        BigNum& r1 = products[1];
+        BigNum& rMinus1 = products[2];
+        BigNum& rMinus2 = products[3];
+        BigNum& rInf = products[4];
+        
+        // Interpolation; every division below is exact
+        BigNum r3 = rMinus2 - r1;
+        r3.divideSmallInPlace(3);
+        r1 = r1 - rMinus1;
+        r1.divideSmallInPlace(2);
+        BigNum r2 = rMinus1 - r0;
+        r3 = r2 - r3;
+        r3.divideSmallInPlace(2);
+        r3 = r3 + rInf + rInf;
+        r2 = r2 + r1 - rInf;
+        r1 = r1 - r3;
+        
+        // Recomposition; all five coefficients are non-negative at this point
+        addLimbsAt(result, r0.limbs.data(), r0.limbs.size(), 0);
+        addLimbsAt(result, r1.limbs.data(), r1.limbs.size(), k);
+        addLimbsAt(result, r2.limbs.data(), r2.limbs.size(), 2 * k);
+        addLimbsAt(result, r3.limbs.data(), r3.limbs.size(), 3 * k);
+        addLimbsAt(result, rInf.limbs.data(), rInf.limbs.size(), 4 * k);
+    }
+    
+    // --- Division ---
+    
+    // Returns x * BASE^count
+    static BigNum shiftLimbsLeft(const BigNum& x, size_t count) {
+        BigNum result = x;
+        if (!x.isZero()) {
+            result.limbs.insertZerosAtFront(count);
+        }
+        return result;
+    }
+    
+    // Returns x / BASE^count, truncated toward zero
+    static BigNum shiftLimbsRight(const BigNum& x, size_t count) {
+        if (count >= x.limbs.size()) {
+            return BigNum();
+        }
+        BigNum result = fromLimbs(x.limbs.data() + count, x.limbs.size() - count);
+        result.isNegative = x.isNegative;
+        result.removeLeadingZeros();
+        return result;
+    }
+    
+    // Knuth's Algorithm D (TAOCP vol. 2, 4.3.1) on magnitudes: u = q * v + r with
+    // 0 <= r < v. Requires v to have at least two limbs and u.size() >= v.size().
+    // The quotient and remainder must not be the objects that own u or v.
+    static void knuthDivide(const LimbStorage& u, const LimbStorage& v, BigNum& quotient, BigNum& remainder) {
+        const size_t n = u.size();
+        const size_t m = v.size();
+        
+        // Normalize so that the top divisor limb is at least BASE / 2, which keeps every
+        // trial quotient digit at most two above the true one
+        const uint64_t factor = BASE / (static_cast<uint64_t>(v.back()) + 1);
+        std::vector<uint32_t> un(n + 1), vn(m);
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t cur = u[i] * factor + carry;
+            un[i] = static_cast<uint32_t>(cur % BASE);
+            carry = cur / BASE;
+        }
+        un[n] = static_cast<uint32_t>(carry);
+        carry = 0;
+        for (size_t i = 0; i < m; ++i) {
+            uint64_t cur = v[i] * factor + carry;
+            vn[i] = static_cast<uint32_t>(cur % BASE);
+            carry = cur / BASE;
+        }
+        
+        const uint64_t vTop = vn[m - 1];
+        const uint64_t vNext = vn[m - 2];
+        std::vector<uint32_t> q(n - m + 1, 0);
+        for (size_t j = n - m + 1; j-- > 0;) {
+            // Estimate the quotient digit from the top two limbs, then refine it with the third
+            uint64_t numerator = un[j + m] * static_cast<uint64_t>(BASE) + un[j + m - 1];
+            uint64_t qHat = numerator / vTop;
+            uint64_t rHat = numerator % vTop;
+            while (qHat >= BASE || qHat * vNext > rHat * BASE + un[j + m - 2]) {
+                --qHat;
+                rHat += vTop;
+                if (rHat >= BASE) {
+                    break;
+                }
+            }
+            
+            // Multiply and subtract qHat * vn from the current window of un
+            int64_t borrow = 0;
+            carry = 0;
+            for (size_t i = 0; i < m; ++i) {
+                uint64_t product = qHat * vn[i] + carry;
+                carry = product / BASE;
+                int64_t diff = static_cast<int64_t>(un[i + j]) - static_cast<int64_t>(product % BASE) - borrow;
+                borrow = (diff < 0) ? 1 : 0;
+                un[i + j] = static_cast<uint32_t>(diff + borrow * BASE);
+            }
+            int64_t top = static_cast<int64_t>(un[j + m]) - static_cast<int64_t>(carry) - borrow;
+            
+            // qHat was still one too large (rare): add the divisor back
+            if (top < 0) {
+                --qHat;
+                uint32_t addCarry = 0;
+                for (size_t i = 0; i < m; ++i) {
+                    uint32_t sum = un[i + j] + vn[i] + addCarry;
+                    addCarry = (sum >= BASE) ? 1 : 0;
+                    un[i + j] = sum - addCarry * BASE;
+                }
+                top += addCarry;
+            }
+            un[j + m] = static_cast<uint32_t>(top);
+            q[j] = static_cast<uint32_t>(qHat);
+        }
+        quotient = fromLimbs(q.data(), q.size());
+        
+        // Undo the normalization on the remainder
+        remainder = fromLimbs(un.data(), m);
+        remainder.divideSmallInPlace(static_cast<uint32_t>(factor));
+    }
+    
+    // Returns Y within a few units of BASE^(p + m) / v, where m is the limb count of v > 0.
+    // Newton's iteration Y' = Y + Y * (BASE^k - V * Y) / BASE^k doubles the number of
+    // correct limbs per step, so each level only looks at the top p + 1 limbs of v and
+    // the total cost is a small multiple of one p-limb multiplication.
+    static BigNum reciprocal(const BigNum& v, size_t p) {
+        const size_t m = v.limbs.size();
+        const size_t topCount = std::min(m, p + 1);
+        BigNum vTop = fromLimbs(v.limbs.data() + (m - topCount), topCount);
+        BigNum scale = shiftLimbsLeft(BigNum(1), p + topCount);
+        
+        if (p <= 16) {
+            BigNum quotient, remainder;
+            if (vTop.limbs.size() == 1) {
+                quotient = scale;
+                quotient.divideSmallInPlace(vTop.limbs[0]);
+                return quotient;
+            }
+            knuthDivide(scale.limbs, vTop.limbs, quotient, remainder);
+            return quotient;
+        }
+        
+        const size_t half = p / 2 + 1;
+        BigNum y = shiftLimbsLeft(reciprocal(v, half), p - half);
+        BigNum error = scale - vTop * y;
+        return y + shiftLimbsRight(y * error, p + topCount);
+    }
+    
+    // Division through a Newton reciprocal: q = floor(u * Y / BASE^(p + m)), followed by
+    // at most a couple of single-step corrections. Operates on non-negative values.
+    static void newtonDivide(const BigNum& u, const BigNum& v, BigNum& quotient, BigNum& remainder) {
+        const size_t m = v.limbs.size();
+        const size_t p = u.limbs.size() - m + 1;
+        quotient = shiftLimbsRight(u * reciprocal(v, p), p + m);
+        remainder = u - quotient * v;
+        while (remainder.isNegative) {
+            quotient = quotient - BigNum(1);
+            remainder = remainder + v;
+        }
+        while (remainder.compareAbsoluteValue(v) >= 0) {
+            quotient = quotient + BigNum(1);
+            remainder = remainder - v;
+        }
+    }
+    
+    // Divides magnitudes: |a| = quotient * |b| + remainder, both results non-negative
+    static void divideMagnitudes(const BigNum& a, const BigNum& b, BigNum& quotient, BigNum& remainder) {
+        if (a.compareAbsoluteValue(b) < 0) {
+            quotient = BigNum();
+            remainder = a;
+            remainder.isNegative = false;
+            return;
+        }
+        if (b.limbs.size() == 1) {
+            quotient = a;
+            quotient.isNegative = false;
+            remainder = BigNum(static_cast<long long>(quotient.divideSmallInPlace(b.limbs[0])));
+            return;
+        }
+        const size_t quotientLimbs = a.limbs.size() - b.limbs.size() + 1;
+        if (b.limbs.size() >= newtonDivisionThreshold && quotientLimbs >= newtonDivisionThreshold) {
+            BigNum dividend = a;
+            BigNum divisor = b;
+            dividend.isNegative = false;
+            divisor.isNegative = false;
+            newtonDivide(dividend, divisor, quotient, remainder);
+            return;
+        }
+        BigNum q, r;
+        knuthDivide(a.limbs, b.limbs, q, r);
+        quotient = std::move(q);
+        remainder = std::move(r);
+    }
+    
+    // --- Modular exponentiation ---
+    
+    // Exponent bits, least significant first
+    static std::vector<uint8_t> toBits(const BigNum& x) {
+        std::vector<uint8_t> bits;
+        BigNum rest = x;
+        rest.isNegative = false;
+        while (!rest.isZero()) {
+            uint32_t chunk = rest.divideSmallInPlace(uint32_t(1) << 30);
+            for (int i = 0; i < 30; ++i) {
+                bits.push_back((chunk >> i) & 1);
+            }
+        }
+        while (!bits.empty() && bits.back() == 0) {
+            bits.pop_back();
+        }
+        return bits;
+    }
+    
+    // Left-to-right sliding-window exponentiation: precomputes the odd powers
+    // base^1, base^3, ..., base^(2^w - 1), then consumes the exponent in windows that
+    // start and end with a 1 bit. mul(x, y) must return the reduced product.
+    template <typename Value, typename MulFn>
+    static Value slidingWindowPow(const Value& base, const std::vector<uint8_t>& bits, const Value& one, MulFn mul) {
+        const size_t bitCount = bits.size();
+        const size_t window = bitCount > 671 ? 6 : bitCount > 239 ? 5 : bitCount > 79 ? 4 : bitCount > 23 ? 3 : 1;
+        
+        std::vector<Value> oddPowers(size_t(1) << (window - 1));
+        oddPowers[0] = base;
+        if (oddPowers.size() > 1) {
+            Value baseSquared = mul(base, base);
+            for (size_t i = 1; i < oddPowers.size(); ++i) {
+                oddPowers[i] = mul(oddPowers[i - 1], baseSquared);
+            }
+        }
+        
+        Value result = one;
+        bool started = false; // Skips the squarings of the initial 1
+        size_t i = bitCount;
+        while (i > 0) {
+            if (bits[i - 1] == 0) {
+                if (started) {
+                    result = mul(result, result);
+                }
+                --i;
+                continue;
+            }
+            // The window covers bits [low, i), trimmed so that its lowest bit is set
+            size_t low = (i >= window) ? i - window : 0;
+            while (bits[low] == 0) {
+                ++low;
+            }
+            size_t value = 0;
+            for (size_t k = i; k-- > low;) {
+                value = (value << 1) | bits[k];
+                if (started) {
+                    result = mul(result, result);
+                }
+            }
+            result = started ? mul(result, oddPowers[value / 2]) : oddPowers[value / 2];
+            started = true;
+            i = low;
+        }
+        return result;
+    }
+    
+    // Montgomery multiplication in base 10^9 by product scanning: returns
+    // a * b * BASE^-k mod modulus as k limbs, for k-limb a, b < modulus coprime to 10.
+    // Each output column (the operand products plus the reduction products) is summed in
+    // a 128-bit accumulator, so there is one division by BASE per column rather than one
+    // per limb product. Passing the same vector twice squares it with half the products.
+    // negInverse is -modulus^-1 mod BASE.
+    static std::vector<uint32_t> montgomeryMultiply(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b,
+                                                    const std::vector<uint32_t>& modulus, uint32_t negInverse) {
+        const size_t k = modulus.size();
+        std::vector<uint32_t> q(k);          // Reduction digits: adding q * modulus clears the low k limbs
+        std::vector<uint32_t> result(k + 1);
+        unsigned __int128 acc = 0;
+        for (size_t column = 0; column < 2 * k; ++column) {
+            const size_t first = (column >= k) ? column - k + 1 : 0;
+            const size_t last = std::min(column, k - 1);
+            if (&a == &b) {
+                // Squaring: each cross product a[j] * a[column - j] appears twice
+                unsigned __int128 cross = 0;
+                size_t j = first;
+                for (; j < column - j && j <= last; ++j) {
+                    cross += static_cast<uint64_t>(a[j]) * a[column - j];
+                }
+                acc += cross << 1;
+                if (j == column - j && j <= last) {
+                    acc += static_cast<uint64_t>(a[j]) * a[j];
+                }
+            } else {
+                for (size_t j = first; j <= last; ++j) {
+                    acc += static_cast<uint64_t>(a[j]) * b[column - j];
+                }
+            }
+            const size_t qLast = std::min(column, k); // q[column] itself is not known yet
+            for (size_t j = first; j < qLast; ++j) {
+                acc += static_cast<uint64_t>(q[j]) * modulus[column - j];
+            }
+            if (column < k) {
+                uint64_t low = static_cast<uint64_t>(acc % BASE);
+                q[column] = static_cast<uint32_t>(low * negInverse % BASE);
+                acc += static_cast<uint64_t>(q[column]) * modulus[0];
+                divideByBase(acc); // Exact: the low limb is now zero
+            } else {
+                result[column - k] = divideByBase(acc);
+            }
+        }
+        result[k] = static_cast<uint32_t>(acc);
+        
+        // The sum is below 2 * modulus, so one conditional subtraction finishes the reduction
+        bool atLeastModulus = (result[k] != 0);
+        if (!atLeastModulus) {
+            atLeastModulus = true;
+            for (size_t i = k; i-- > 0;) {
+                if (result[i] != modulus[i]) {
+                    atLeastModulus = (result[i] > modulus[i]);
+                    break;
+                }
+            }
+        }
+        if (atLeastModulus) {
+            uint32_t borrow = 0;
+            for (size_t i = 0; i < k; ++i) {
+                uint32_t subtrahend = modulus[i] + borrow;
+                uint32_t diff = result[i] - subtrahend;
+                borrow = (result[i] < subtrahend) ? 1 : 0;
+                result[i] = diff + borrow * BASE;
+            }
+        }
+        result.resize(k);
+        return result;
+    }
+    
+    // Inverse of an odd value not divisible by 5, modulo BASE (extended Euclid)
+    static uint32_t inverseModBase(uint32_t value) {
+        int64_t oldR = value, r = BASE, oldS = 1, s = 0;
+        while (r != 0) {
+            int64_t q = oldR / r;
+            std::swap(oldR, r);
+            r -= q * oldR;
+            std::swap(oldS, s);
+            s -= q * oldS;
+        }
+        return static_cast<uint32_t>(((oldS % static_cast<int64_t>(BASE)) + BASE) % BASE);
+    }
+
+public:
+    // Default constructor - initializes to 0
+    BigNum() : isNegative(false) {
+        limbs.push_back(0);
+    }
+    
+    // Constructor from long long
+    BigNum(long long num) {
+        isNegative = (num < 0);
+        // Work on the unsigned magnitude so that LLONG_MIN does not overflow
+        unsigned long long magnitude = static_cast<unsigned long long>(num);
+        if (isNegative) {
+            magnitude = 0ULL - magnitude;
+        }
+        
+        if (magnitude == 0) {
+            limbs.push_back(0);
+        } else {
+            while (magnitude > 0) {
+                limbs.push_back(static_cast<uint32_t>(magnitude % BASE));
+                magnitude /= BASE;
+            }
+        }
+    }
+    
+    // Constructor from string
+    BigNum(const std::string& numStr) : isNegative(false) {
+        parseDecimal(numStr.data(), numStr.size());
+    }
+    
+    // Copies reuse the destination's buffer when it is large enough. Moves take over a
+    // spilled buffer and leave the source equal to zero.
+    BigNum(const BigNum& other) = default;
+    BigNum& operator=(const BigNum& other) = default;
+    
+    BigNum(BigNum&& other) noexcept : limbs(std::move(other.limbs)), isNegative(other.isNegative) {
+        other.isNegative = false;
+    }
+    
+    BigNum& operator=(BigNum&& other) noexcept {
+        if (this != &other) {
+            limbs = std::move(other.limbs);
+            isNegative = other.isNegative;
+            other.isNegative = false;
+        }
+        return *this;
+    }
+    
+    // Compound assignment works in place and only allocates when the result outgrows the
+    // current buffer, so accumulation loops settle into zero allocations.
+    BigNum& operator+=(const BigNum& other) {
+        addSigned(*this, *this, other, false);
+        return *this;
+    }
+    
+    BigNum& operator-=(const BigNum& other) {
+        addSigned(*this, *this, other, true);
+        return *this;
+    }
+    
+    BigNum& operator*=(const BigNum& other) {
+        multiplyInto(*this, *this, other);
+        return *this;
+    }
+    
+    // +, - and * return expression templates (see BigNumExpr), which are evaluated here in
+    // one pass into this number's buffer. x += a * b is a fused multiply-accumulate.
+    template <typename Expr>
+    BigNum(const BigNumExpr<Expr>& expr) : isNegative(false) {
+        assignExpression(expr.self(), false, false);
+    }
+    
+    template <typename Expr>
+    BigNum& operator=(const BigNumExpr<Expr>& expr) {
+        assignExpression(expr.self(), false, false);
+        return *this;
+    }
+    
+    template <typename Expr>
+    BigNum& operator+=(const BigNumExpr<Expr>& expr) {
+        assignExpression(expr.self(), true, false);
+        return *this;
+    }
+    
+    template <typename Expr>
+    BigNum& operator-=(const BigNumExpr<Expr>& expr) {
+        assignExpression(expr.self(), true, true);
+        return *this;
+    }
+    
+    // Subtraction helper - assumes |a| >= |b|
+    static BigNum absoluteSubtract(const BigNum& a, const BigNum& b) {
+        BigNum result;
+        subtractMagnitudes(result.limbs, a.limbs, b.limbs);
+        result.removeLeadingZeros();
+        return result;
+    }
+    
+    // Widest add/subtract kernel to use: 2 = AVX2, 1 = SSE2, 0 = scalar. Starts at the best
+    // the CPU supports; lowering it is how the tests and --bench reach the narrower kernels.
+    static inline int simdLevel = detectSimdLevel();
+    
+    // Multiplication tier thresholds, in limbs of the shorter operand. Operands below
+    // karatsubaThreshold use schoolbook multiplication, operands from toom3Threshold up
+    // use Toom-3, and Karatsuba covers the range in between. The defaults come from the
+    // threshold sweep printed by --bench on an x86-64 box; re-run it to tune a new machine.
+    static inline size_t karatsubaThreshold = 32;
+    static inline size_t toom3Threshold = 384;
+    // Operands from nttThreshold limbs up are multiplied with the three-prime NTT, as long
+    // as the product fits in NTT_MAX_LENGTH (~75M digits); larger ones fall back to Toom-3.
+    static inline size_t nttThreshold = 512;
+    // Products whose shorter operand has at least parallelThreshold limbs are spread over the
+    // multiplication pool once setMultiplyThreads has enabled it: the three NTT primes, the
+    // transform halves and butterfly ranges, and the Karatsuba/Toom-3 sub-products.
+    static inline size_t parallelThreshold = 16384;
+    
+    // Opt-in parallel multiplication: threads > 1 starts a shared pool of that many threads
+    // (counting the caller), 1 or 0 goes back to serial. Not safe to call while another
+    // thread is multiplying.
+    static void setMultiplyThreads(unsigned threads) {
+        multiplyPool.reset();
+        if (threads > 1) {
+            multiplyPool = std::make_unique<WorkerPool>(threads);
+        }
+    }
+    
+    static unsigned multiplyThreads() {
+        return multiplyPool ? multiplyPool->size() : 1;
+    }
+    
+    // Returns this * this. Multiplying a number by itself with operator* takes the same
+    // squaring paths, which skip one of the NTT transforms and half the schoolbook products.
+    BigNum square() const {
+        BigNum result;
+        multiplyInto(result, *this, *this);
+        return result;
+    }
+    
+    // Plain O(n*m) long multiplication regardless of the tier thresholds. Kept as the
+    // reference that the faster tiers are checked against.
+    static BigNum multiplySchoolbook(const BigNum& a, const BigNum& b) {
+        if (a.isZero() || b.isZero()) {
+            return BigNum(0);
+        }
+        
+        BigNum result;
+        result.limbs.assign(a.limbs.size() + b.limbs.size(), 0);
+        schoolbookMultiply(a.limbs.data(), a.limbs.size(), b.limbs.data(), b.limbs.size(), result.limbs.data());
+        result.isNegative = (a.isNegative != b.isNegative);
+        result.removeLeadingZeros();
+        return result;
+    }
+    
+    // Divisors and quotients that both have at least this many limbs are divided through
+    // a Newton reciprocal (a few multiplications); smaller ones use Knuth's Algorithm D.
+    static inline size_t newtonDivisionThreshold = 1024;
+    
+    // Computes a = quotient * b + remainder with the quotient truncated toward zero and the
+    // remainder taking the sign of a, like the built-in integer operators.
+    // Throws std::domain_error when b is zero.
+    static void divMod(const BigNum& a, const BigNum& b, BigNum& quotient, BigNum& remainder) {
+        if (b.isZero()) {
+            throw std::domain_error("Division by zero");
+        }
+        BigNum q, r;
+        divideMagnitudes(a, b, q, r);
+        q.isNegative = (a.isNegative != b.isNegative);
+        r.isNegative = a.isNegative;
+        q.removeLeadingZeros();
+        r.removeLeadingZeros();
+        quotient = q;
+        remainder = r;
+    }
+    
+    // Division operator (truncates toward zero)
+    BigNum operator/(const BigNum& other) const {
+        BigNum quotient, remainder;
+        divMod(*this, other, quotient, remainder);
+        return quotient;
+    }
+    
+    // Modulo operator (result has the sign of the dividend)
+    BigNum operator%(const BigNum& other) const {
+        BigNum quotient, remainder;
+        divMod(*this, other, quotient, remainder);
+        return remainder;
+    }
+    
+    // Returns this^exponent by repeated squaring
+    BigNum pow(unsigned long long exponent) const {
+        BigNum result(1);
+        BigNum base = *this;
+        while (exponent > 0) {
+            if (exponent & 1) {
+                result = result * base;
+            }
+            exponent >>= 1;
+            if (exponent > 0) {
+                base = base.square();
+            }
+        }
+        return result;
+    }
+    
+    // Returns base^exponent mod modulus in [0, modulus) with sliding-window exponentiation.
+    // Moduli coprime to 10 (every odd RSA modulus) use Montgomery multiplication, which
+    // needs no division at all; other moduli use Barrett reduction with a precomputed
+    // reciprocal. Throws std::domain_error for a non-positive modulus or negative exponent.
+    static BigNum powMod(const BigNum& base, const BigNum& exponent, const BigNum& modulus) {
+        if (modulus.isNegative || modulus.isZero()) {
+            throw std::domain_error("Modulus must be positive");
+        }
+        if (exponent.isNegative) {
+            throw std::domain_error("Exponent must be non-negative");
+        }
+        if (modulus == BigNum(1)) {
+            return BigNum();
+        }
+        
+        BigNum reducedBase = base % modulus;
+        if (reducedBase.isNegative) {
+            reducedBase = reducedBase + modulus;
+        }
+        const std::vector<uint8_t> bits = toBits(exponent);
+        const size_t k = modulus.limbs.size();
+        
+        if (modulus.limbs[0] % 2 != 0 && modulus.limbs[0] % 5 != 0) {
+            // Montgomery form: x is represented by x * BASE^k mod modulus, padded to k limbs
+            const uint32_t negInverse = BASE - inverseModBase(modulus.limbs[0]);
+            const std::vector<uint32_t> modulusLimbs(modulus.limbs.begin(), modulus.limbs.end());
+            auto toMontgomery = [&](const BigNum& x) {
+                BigNum reduced = shiftLimbsLeft(x, k) % modulus;
+                std::vector<uint32_t> limbs(reduced.limbs.begin(), reduced.limbs.end());
+                limbs.resize(k, 0);
+                return limbs;
+            };
+            auto mul = [&](const std::vector<uint32_t>& x, const std::vector<uint32_t>& y) {
+                return montgomeryMultiply(x, y, modulusLimbs, negInverse);
+            };
+            std::vector<uint32_t> plainOne(k, 0);
+            plainOne[0] = 1;
+            std::vector<uint32_t> power = slidingWindowPow(toMontgomery(reducedBase), bits, toMontgomery(BigNum(1)), mul);
+            return fromLimbs(mul(power, plainOne).data(), k); // Multiplying by 1 leaves Montgomery form
+        }
+        
+        // Barrett: with mu = floor(BASE^2k / modulus), q = ((x / BASE^(k-1)) * mu) / BASE^(k+1)
+        // underestimates x / modulus by at most 2, so x - q * modulus needs <= 2 corrections
+        const BigNum mu = shiftLimbsLeft(BigNum(1), 2 * k) / modulus;
+        auto mul = [&](const BigNum& x, const BigNum& y) {
+            BigNum product = x * y;
+            BigNum q = shiftLimbsRight(shiftLimbsRight(product, k - 1) * mu, k + 1);
+            BigNum r = product - q * modulus;
+            while (r.compareAbsoluteValue(modulus) >= 0) {
+                r = absoluteSubtract(r, modulus);
+            }
+            return r;
+        };
+        return slidingWindowPow(reducedBase, bits, BigNum(1), mul);
+    }
+    
+    // Compare the absolute values of two BigNum objects
+    int compareAbsoluteValue(const BigNum& other) const {
+        if (limbs.size() != other.limbs.size()) {
+            return (limbs.size() > other.limbs.size()) ? 1 : -1;
+        }
+        
+        for (size_t i = limbs.size(); i-- > 0;) {
+            if (limbs[i] != other.limbs[i]) {
+                return (limbs[i] > other.limbs[i]) ? 1 : -1;
+            }
+        }
+        
+        return 0; // Equal
+    }
+    
+    // Compare operator
+    bool operator==(const BigNum& other) const {
+        return (isNegative == other.isNegative) && (limbs == other.limbs);
+    }
+    
+    bool operator!=(const BigNum& other) const {
+        return !(*this == other);
+    }
+    
+    bool operator<(const BigNum& other) const {
+        if (isNegative != other.isNegative) {
+            return isNegative;
+        }
+        
+        int absComp = compareAbsoluteValue(other);
+        return isNegative ? absComp > 0 : absComp < 0;
+    }
+    
+    bool operator<=(const BigNum& other) const {
+        return (*this < other) || (*this == other);
+    }
+    
+    bool operator>(const BigNum& other) const {
+        return !(*this <= other);
+    }
+    
+    bool operator>=(const BigNum& other) const {
+        return !(*this < other);
+    }
+    
+    // Number of characters toString() produces, including the sign
+    size_t decimalLength() const {
+        return decimalLength(limbs.data(), limbs.size(), isNegative);
+    }
+    
+    // Writes the decimal form into buffer[0..capacity) without a terminator and returns the
+    // number of characters written, or 0 if it needs more than capacity (see decimalLength).
+    size_t toChars(char* buffer, size_t capacity) const {
+        return toChars(limbs.data(), limbs.size(), isNegative, buffer, capacity);
+    }
+    
+    // Appends the decimal form to out with at most one reallocation of out
+    void appendTo(std::string& out) const {
+        const size_t offset = out.size();
+        out.resize(offset + decimalLength());
+        toChars(&out[offset], out.size() - offset);
+    }
+    
+    // Convert to string representation
+    std::string toString() const {
+        std::string result;
+        appendTo(result);
+        return result;
+    }
+    
+    // Parses text[0..length) like the string constructor, without needing a std::string
+    static BigNum fromChars(const char* text, size_t length) {
+        BigNum result;
+        result.parseDecimal(text, length);
+        return result;
+    }
+    
+    // --- Binary serialization ---
+    //
+    // A record is a 32-bit header holding the limb count, with the sign in the top bit,
+    // followed by the limbs least significant first; every word is little-endian. Nine
+    // digits take four bytes instead of nine, and a record that starts on a 4-byte boundary
+    // can be read in place without decoding (see BigNumView).
+    static constexpr uint32_t SERIALIZED_SIGN_BIT = 0x80000000u;
+    
+    // Number of bytes serialize() writes
+    size_t serializedSize() const {
+        return sizeof(uint32_t) * (1 + limbs.size());
+    }
+    
+    // Writes the record into buffer[0..capacity) and returns its size, or 0 if it needs more
+    // than capacity (see serializedSize)
+    size_t serialize(char* buffer, size_t capacity) const {
+        const size_t size = serializedSize();
+        if (size > capacity) {
+            return 0;
+        }
+        storeWord(buffer, static_cast<uint32_t>(limbs.size()) | (isNegative ? SERIALIZED_SIGN_BIT : 0));
+#if BIGNUM_LITTLE_ENDIAN
+        std::memcpy(buffer + sizeof(uint32_t), limbs.data(), limbs.size() * sizeof(uint32_t));
+#else
+        for (size_t i = 0; i < limbs.size(); ++i) {
+            storeWord(buffer + sizeof(uint32_t) * (1 + i), limbs[i]);
+        }
+#endif
+        return size;
+    }
+    
+    // Appends the record to out with at most one reallocation of out
+    void appendSerialized(std::string& out) const {
+        const size_t offset = out.size();
+        out.resize(offset + serializedSize());
+        serialize(&out[offset], out.size() - offset);
+    }
+    
+    // Reads the record at the start of data[0..size), storing its length in *consumed when
+    // given. Throws std::invalid_argument if the record is truncated or not canonical.
+    static BigNum deserialize(const char* data, size_t size, size_t* consumed = nullptr) {
+        if (size < sizeof(uint32_t)) {
+            throw std::invalid_argument("Truncated BigNum record");
+        }
+        const uint32_t header = loadWord(data);
+        const size_t count = header & ~SERIALIZED_SIGN_BIT;
+        if (count == 0 || (size - sizeof(uint32_t)) / sizeof(uint32_t) < count) {
+            throw std::invalid_argument("Truncated BigNum record");
+        }
+        
+        BigNum result;
+        result.limbs.resize(count);
+#if BIGNUM_LITTLE_ENDIAN
+        std::memcpy(result.limbs.data(), data + sizeof(uint32_t), count * sizeof(uint32_t));
+#else
+        for (size_t i = 0; i < count; ++i) {
+            result.limbs[i] = loadWord(data + sizeof(uint32_t) * (1 + i));
+        }
+#endif
+        result.isNegative = (header & SERIALIZED_SIGN_BIT) != 0;
+        if (!isCanonical(result.limbs.data(), count, result.isNegative)) {
+            throw std::invalid_argument("Malformed BigNum record");
+        }
+        if (consumed) {
+            *consumed = sizeof(uint32_t) * (1 + count);
+        }
+        return result;
+    }
+    
+    // Friend function to enable cout << BigNum. Unless a field width is set, the digits are
+    // streamed through a fixed stack buffer so printing never builds the whole string.
+    friend std::ostream& operator<<(std::ostream& os, const BigNum& num) {
+        if (os.width() != 0) {
+            return os << num.toString();
+        }
+        char buffer[4096];
+        size_t used = 0;
+        if (num.isNegative) {
+            buffer[used++] = '-';
+        }
+        used += writeLimbUnpadded(buffer + used, num.limbs.back());
+        for (size_t i = num.limbs.size() - 1; i-- > 0;) {
+            if (used + BASE_DIGITS > sizeof(buffer)) {
+                os.write(buffer, static_cast<std::streamsize>(used));
+                used = 0;
+            }
+            writeLimbPadded(buffer + used, num.limbs[i]);
+            used += BASE_DIGITS;
+        }
+        os.write(buffer, static_cast<std::streamsize>(used));
+        return os;
+    }
+};
+
+// Reading an expression's value evaluates it into a BigNum
+template <typename Derived>
+BigNum BigNumExpr<Derived>::eval() const { return BigNum(*this); }
+
+template <typename Derived>
+bool BigNumExpr<Derived>::operator==(const BigNum& other) const { return eval() == other; }
+
+template <typename Derived>
+bool BigNumExpr<Derived>::operator!=(const BigNum& other) const { return eval() != other; }
+
+template <typename Derived>
+bool BigNumExpr<Derived>::operator<(const BigNum& other) const { return eval() < other; }
+
+template <typename Derived>
+bool BigNumExpr<Derived>::operator<=(const BigNum& other) const { return eval() <= other; }
+
+template <typename Derived>
+bool BigNumExpr<Derived>::operator>(const BigNum& other) const { return eval() > other; }
+
+template <typename Derived>
+bool BigNumExpr<Derived>::operator>=(const BigNum& other) const { return eval() >= other; }
+
+template <typename Derived>
+BigNum BigNumExpr<Derived>::operator/(const BigNum& other) const { return eval() / other; }
+
+template <typename Derived>
+BigNum BigNumExpr<Derived>::operator%(const BigNum& other) const { return eval() % other; }
+
+template <typename Derived>
+int BigNumExpr<Derived>::compareAbsoluteValue(const BigNum& other) const { return eval().compareAbsoluteValue(other); }
+
+template <typename Derived>
+BigNum BigNumExpr<Derived>::square() const { return eval().square(); }
+
+template <typename Derived>
+BigNum BigNumExpr<Derived>::pow(unsigned long long exponent) const { return eval().pow(exponent); }
+
+template <typename Derived>
+std::string BigNumExpr<Derived>::toString() const { return eval().toString(); }
+
+template <typename Derived>
+std::ostream& operator<<(std::ostream& os, const BigNumExpr<Derived>& expr) {
+    return os << expr.eval();
+}
+
+#if BIGNUM_LITTLE_ENDIAN
+/**
+ * BigNumView - a serialized BigNum read in place
+ *
+ * Wraps one record written by BigNum::serialize without parsing or copying it: the limbs are
+ * read straight out of the buffer, typically a memory-mapped file (see BigNumArchive). The
+ * buffer must stay alive while the view is used and the record must start on a 4-byte
+ * boundary. Construction only checks that the record fits in the buffer, in O(1). The limb
+ * values are validated by the calls that depend on them: toBigNum() and the printing paths
+ * throw std::invalid_argument for a record that is not canonical, since a limb of 10^9 or
+ * more would index past the digit tables. Comparisons only read the limbs and need no check.
+ *
+ * Reading limbs in place needs a host with the format's byte order, so the view only exists
+ * on little-endian hosts; elsewhere BigNum::deserialize decodes records word by word.
+ */
+class BigNumView {
+public:
+    // Throws std::invalid_argument if data[0..size) does not start with a whole, aligned record
+    BigNumView(const char* data, size_t size) {
+        if (reinterpret_cast<uintptr_t>(data) % alignof(uint32_t) != 0) {
+            throw std::invalid_argument("BigNum record is not 4-byte aligned");
+        }
+        if (size < sizeof(uint32_t)) {
+            throw std::invalid_argument("Truncated BigNum record");
+        }
+        const uint32_t header = BigNum::loadWord(data);
+        count = header & ~BigNum::SERIALIZED_SIGN_BIT;
+        negative = (header & BigNum::SERIALIZED_SIGN_BIT) != 0;
+        if (count == 0 || (size - sizeof(uint32_t)) / sizeof(uint32_t) < count) {
+            throw std::invalid_argument("Truncated BigNum record");
+        }
+        digits = reinterpret_cast<const uint32_t*>(data + sizeof(uint32_t));
+    }
+    
+    bool isNegative() const { return negative; }
+    
+    // The base 10^9 limbs, least significant first
+    size_t limbCount() const { return count; }
+    const uint32_t* limbs() const { return digits; }
+    
+    // Length of the record in bytes, i.e. the offset of the next record in an archive
+    size_t byteSize() const { return sizeof(uint32_t) * (1 + count); }
+    
+    // Only the top limb decides the length, so only it is checked here, in O(1)
+    size_t decimalLength() const {
+        const uint32_t top = digits[count - 1];
+        if (top >= BigNum::BASE || (top == 0 && count > 1)) {
+            throw std::invalid_argument("Malformed BigNum record");
+        }
+        return BigNum::decimalLength(digits, count, negative);
+    }
+    
+    size_t toChars(char* buffer, size_t capacity) const {
+        if (!BigNum::isCanonical(digits, count, negative)) {
+            throw std::invalid_argument("Malformed BigNum record");
+        }
+        return BigNum::toChars(digits, count, negative, buffer, capacity);
+    }
+    
+    std::string toString() const {
+        std::string result(decimalLength(), '\0');
+        toChars(&result[0], result.size());
+        return result;
+    }
+    
+    // Copies the value into a BigNum; throws std::invalid_argument if it is not canonical
+    BigNum toBigNum() const {
+        return BigNum::deserialize(reinterpret_cast<const char*>(digits) - sizeof(uint32_t), byteSize());
+    }
+    
+    bool operator==(const BigNum& other) const {
+        return negative == other.isNegative && count == other.limbs.size() &&
+               std::equal(digits, digits + count, other.limbs.data());
+    }
+    
+    bool operator!=(const BigNum& other) const { return !(*this == other); }
+    
+private:
+    const uint32_t* digits; // Points into the caller's buffer
+    size_t count;
+    bool negative;
+};
+#endif // BIGNUM_LITTLE_ENDIAN
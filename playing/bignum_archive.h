@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility> // For std::exchange
+#include <vector>
+
+#include "bignum.h"
+#include "mapped_file.h"
+
+// The archive hands out BigNumViews over the mapping and keeps its header in host order
+static_assert(BIGNUM_LITTLE_ENDIAN, "BigNumArchive reads little-endian records in place");
+
+/**
+ * BigNumArchive - a read-only, memory-mapped file of serialized BigNums
+ *
+ * The file starts with a 16-byte header: the magic "BNA1", a reserved 32-bit zero and the
+ * record count as a 64-bit little-endian word. The records (see BigNum::serialize) follow
+ * back to back. Opening an archive maps the file and checks the header; iterating hands out
+ * BigNumViews that point into the mapping, so loading does no parsing, no copying and no
+ * allocation, and pages are only read when a value is touched. Views stay valid while the
+ * archive is open.
+ */
+class BigNumArchive {
+public:
+    static constexpr char MAGIC[4] = {'B', 'N', 'A', '1'};
+    static constexpr size_t HEADER_SIZE = 16;
+
+    class const_iterator {
+    public:
+        BigNumView operator*() const {
+            return BigNumView(position, static_cast<size_t>(end - position));
+        }
+
+        // Steps over the current record; its header says how long it is
+        const_iterator& operator++() {
+            position += (**this).byteSize();
+            ++index;
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+
+    private:
+        friend class BigNumArchive;
+        const_iterator(const char* position, const char* end, size_t index)
+            : position(position), end(end), index(index) {}
+
+        const char* position;
+        const char* end;
+        size_t index;
+    };
+
+    // Maps the archive at path. Throws std::runtime_error if the file cannot be opened or
+    // mapped, and std::invalid_argument if it does not start with an archive header.
+    explicit BigNumArchive(const std::string& path) : mapping(path) {
+        const char* data = mapping.data();
+        const size_t length = mapping.size();
+        if (length < HEADER_SIZE) {
+            throw std::invalid_argument(path + " is not a BigNum archive");
+        }
+        uint64_t records;
+        std::memcpy(&records, data + 8, sizeof(records));
+        if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || records > (length - HEADER_SIZE) / sizeof(uint32_t)) {
+            throw std::invalid_argument(path + " is not a BigNum archive");
+        }
+        count = static_cast<size_t>(records);
+    }
+
+    BigNumArchive(const BigNumArchive&) = delete;
+    BigNumArchive& operator=(const BigNumArchive&) = delete;
+
+    BigNumArchive(BigNumArchive&& other) noexcept
+        : mapping(std::move(other.mapping)), count(std::exchange(other.count, 0)) {}
+
+    BigNumArchive& operator=(BigNumArchive&& other) noexcept {
+        if (this != &other) {
+            mapping = std::move(other.mapping);
+            count = std::exchange(other.count, 0);
+        }
+        return *this;
+    }
+
+    // Number of records in the archive
+    size_t size() const { return count; }
+
+    const_iterator begin() const {
+        return const_iterator(mapping.data() + HEADER_SIZE, mapping.data() + mapping.size(), 0);
+    }
+    const_iterator end() const {
+        return const_iterator(mapping.data() + mapping.size(), mapping.data() + mapping.size(), count);
+    }
+
+    // Writes values to path as an archive, replacing any existing file. Throws
+    // std::runtime_error if the file cannot be written.
+    static void write(const std::string& path, const std::vector<BigNum>& values) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Cannot create " + path + ": " + std::strerror(errno));
+        }
+
+        std::string chunk(MAGIC, sizeof(MAGIC));
+        const uint32_t reserved = 0;
+        const uint64_t records = values.size();
+        chunk.append(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+        chunk.append(reinterpret_cast<const char*>(&records), sizeof(records));
+
+        // Records are gathered into chunks of about 1 MB so each write is large
+        constexpr size_t CHUNK_BYTES = 1 << 20;
+        for (const BigNum& value : values) {
+            value.appendSerialized(chunk);
+            if (chunk.size() >= CHUNK_BYTES) {
+                file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                chunk.clear();
+            }
+        }
+        file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        file.close();
+        if (!file) {
+            throw std::runtime_error("Cannot write " + path + ": " + std::strerror(errno));
+        }
+    }
+
+private:
+    MappedFile mapping;
+    size_t count = 0;
+};
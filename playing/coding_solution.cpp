@@ -1,154 +1,192 @@
 /*
  * CODING INTERVIEW QUESTION - SOLUTION:
- * 
+ *
  * Thread-safe queue implementation that can be safely used by multiple threads.
+ *
+ * The queue itself is in thread_safe_queue.h. This program is its stress harness: it runs
+ * N producers and M consumers against a queue for a fixed time (queue_stress.h does the
+ * work) and reports throughput, enqueue-to-dequeue latency and any element that was lost,
+ * duplicated, corrupted or reordered. The lock-free queues from chapter 07 go through the
+ * same harness, so the numbers say which queue suits which pipeline.
+ *
+ * "locked" polls ThreadSafeQueue with try_pop like the lock-free queues; "batched" drives it
+ * the way an ingest pipeline does: consumers block in pop_up_to for up to --batch elements
+ * at a time and stop when the harness closes the queue.
+ *
+ * Usage: thread_safe_queue_demo [--queue locked|batched|mpmc|spsc] [--producers N] [--consumers M]
+ *                               [--payload 0|64|256|1024] [--seconds S] [--capacity N] [--batch N]
+ * With no options it runs every queue over a small matrix of thread counts.
  */
 
+#include <iomanip>
 #include <iostream>
-#include <queue>
-#include <mutex>
-#include <condition_variable>
 #include <memory>
-#include <thread>
+#include <stdexcept>
+#include <string>
 #include <vector>
-#include <chrono>
-#include <atomic>
 
-template<typename T>
-class ThreadSafeQueue {
-private:
-    // The underlying queue data structure
-    std::queue<T> data_queue;
-    
-    // Mutex to protect access to the queue
-    mutable std::mutex mutex;
-    
-    // Condition variable for waiting for data
-    std::condition_variable data_cond;
-    
-public:
-    ThreadSafeQueue() {
-        // No additional initialization needed
-    }
-    
-    // Add an element to the queue
-    void push(T value) {
-        // Lock the mutex to protect the queue
-        std::lock_guard<std::mutex> lock(mutex);
-        
-        // Add the value to the queue
-        data_queue.push(std::move(value));
-        
-        // Notify one waiting thread that data is available
-        data_cond.notify_one();
-    }
-    
-    // Try to pop an element from the queue
-    // Returns true if successful, false if queue was empty
-    bool try_pop(T& value) {
-        // Lock the mutex to protect the queue
-        std::lock_guard<std::mutex> lock(mutex);
-        
-        // Check if the queue is empty
-        if (data_queue.empty()) {
-            return false;
-        }
-        
-        // Get the value from the front of the queue
-        value = std::move(data_queue.front());
-        data_queue.pop();
-        
-        return true;
-    }
-    
-    // Wait until an element is available and then pop it
-    void wait_and_pop(T& value) {
-        // Use a unique_lock since we need to unlock it in the wait
-        std::unique_lock<std::mutex> lock(mutex);
-        
-        // Wait until the queue is not empty
-        // This releases the lock while waiting and reacquires it when notified
-        data_cond.wait(lock, [this]{ return !data_queue.empty(); });
-        
-        // Get the value from the front of the queue
-        value = std::move(data_queue.front());
-        data_queue.pop();
+#include "bounded_mpmc_queue.h"
+#include "queue_stress.h"
+#include "spsc_queue.h"
+#include "thread_safe_queue.h"
+
+struct HarnessOptions {
+    std::string queue = "all";
+    StressConfig config;
+    size_t payload = 64;
+    size_t capacity = 1024;
+    size_t batch = 64;
+};
+
+void print_header() {
+    std::cout << std::left << std::setw(22) << "queue" << std::right << std::setw(4) << "P" << std::setw(4) << "C"
+              << std::setw(9) << "payload" << std::setw(13) << "items/s" << std::setw(10) << "p50 ns"
+              << std::setw(10) << "p99 ns" << std::setw(10) << "p999 ns" << "  check" << std::endl;
+}
+
+void print_row(const std::string& name, const StressConfig& config, size_t payload, const StressResult& result) {
+    std::cout << std::left << std::setw(22) << name << std::right << std::setw(4) << config.producers
+              << std::setw(4) << config.consumers << std::setw(9) << payload << std::setw(13)
+              << static_cast<long long>(result.throughput()) << std::setw(10) << result.latency.percentile(0.50)
+              << std::setw(10) << result.latency.percentile(0.99) << std::setw(10) << result.latency.percentile(0.999);
+    if (result.ok()) {
+        std::cout << "  " << result.consumed << " ok" << std::endl;
+    } else {
+        std::cout << "  FAILED: produced " << result.produced << ", consumed " << result.consumed << ", lost "
+                  << result.lost << ", duplicated " << result.duplicated << ", corrupted " << result.corrupted
+                  << ", reordered " << result.reordered << std::endl;
     }
-    
-    // Check if the queue is empty
-    bool empty() const {
-        // Lock the mutex to protect the queue
-        std::lock_guard<std::mutex> lock(mutex);
-        
-        // Check if the queue is empty
-        return data_queue.empty();
+}
+
+// Runs one queue type with one payload size; returns false if any element went wrong
+template<size_t PayloadBytes>
+bool run_one(const std::string& queue, const StressConfig& config, size_t capacity, size_t batch) {
+    using Element = StressElement<PayloadBytes>;
+    StressResult result;
+    std::string name;
+    if (queue == "locked") {
+        ThreadSafeQueue<Element> q;
+        result = run_queue_stress<PayloadBytes>(q, config);
+        name = "ThreadSafeQueue";
+    } else if (queue == "batched") {
+        ThreadSafeQueue<Element> q;
+        StressConfig batched = config;
+        batched.pop_batch = batch;
+        result = run_queue_stress<PayloadBytes>(q, batched);
+        name = "ThreadSafeQueue batch";
+    } else if (queue == "mpmc") {
+        auto q = std::make_unique<BoundedMpmcQueue<Element>>(capacity);
+        result = run_queue_stress<PayloadBytes>(*q, config);
+        name = "BoundedMpmcQueue";
+    } else {
+        auto q = std::make_unique<SpscQueue<Element>>(capacity);
+        result = run_queue_stress<PayloadBytes>(*q, config);
+        name = "SpscQueue";
     }
-};
+    print_row(name, config, PayloadBytes, result);
+    return result.ok();
+}
 
-// Test function for producers
-void producer(ThreadSafeQueue<int>& queue, int id, int num_items) {
-    for (int i = 0; i < num_items; i++) {
-        int value = id * 1000 + i;
-        queue.push(value);
-        std::cout << "Producer " << id << " pushed: " << value << std::endl;
-        std::this_thread::sleep_for(std::chrono::milliseconds(50 + (std::rand() % 100)));
+bool run_config(const std::string& queue, const StressConfig& config, size_t payload, size_t capacity,
+                size_t batch) {
+    switch (payload) {
+        case 0: return run_one<0>(queue, config, capacity, batch);
+        case 64: return run_one<64>(queue, config, capacity, batch);
+        case 256: return run_one<256>(queue, config, capacity, batch);
+        default: return run_one<1024>(queue, config, capacity, batch);
     }
 }
 
-// Test function for consumers
-void consumer(ThreadSafeQueue<int>& queue, int id, std::atomic<bool>& done, std::atomic<int>& items_processed) {
-    while (!done || !queue.empty()) {
-        int value;
-        if (queue.try_pop(value)) {
-            std::cout << "Consumer " << id << " popped: " << value << std::endl;
-            items_processed++;
-            std::this_thread::sleep_for(std::chrono::milliseconds(100 + (std::rand() % 150)));
-        } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+void print_usage() {
+    std::cerr << "Usage: thread_safe_queue_demo [--queue locked|batched|mpmc|spsc] [--producers N] [--consumers M]\n"
+                 "                              [--payload 0|64|256|1024] [--seconds S] [--capacity N] [--batch N]"
+              << std::endl;
+}
+
+// Fills options from the command line; returns false on an unknown option or a value that
+// is not a number
+bool parse_args(const std::vector<std::string>& args, HarnessOptions& options, bool& custom_threads) {
+    if (args.size() % 2 != 0) {
+        return false;
+    }
+    try {
+        for (size_t i = 0; i + 1 < args.size(); i += 2) {
+            if (args[i] == "--queue") {
+                options.queue = args[i + 1];
+            } else if (args[i] == "--producers") {
+                options.config.producers = std::stoi(args[i + 1]);
+                custom_threads = true;
+            } else if (args[i] == "--consumers") {
+                options.config.consumers = std::stoi(args[i + 1]);
+                custom_threads = true;
+            } else if (args[i] == "--payload") {
+                options.payload = std::stoul(args[i + 1]);
+            } else if (args[i] == "--seconds") {
+                options.config.seconds = std::stod(args[i + 1]);
+            } else if (args[i] == "--capacity") {
+                options.capacity = std::stoul(args[i + 1]);
+            } else if (args[i] == "--batch") {
+                options.batch = std::stoul(args[i + 1]);
+            } else {
+                return false;
+            }
         }
+    } catch (const std::invalid_argument&) {
+        return false;
+    } catch (const std::out_of_range&) {
+        return false;
     }
+    return true;
 }
 
-int main() {
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));
-    
-    ThreadSafeQueue<int> queue;
-    std::atomic<bool> done(false);
-    std::atomic<int> items_processed(0);
-    
-    const int num_producers = 3;
-    const int num_consumers = 2;
-    const int items_per_producer = 5;
-    const int total_items = num_producers * items_per_producer;
-    
-    std::vector<std::thread> threads;
-    
-    // Start producer threads
-    for (int i = 0; i < num_producers; i++) {
-        threads.push_back(std::thread(producer, std::ref(queue), i, items_per_producer));
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    HarnessOptions options;
+    bool custom_threads = false;
+    if (!parse_args(args, options, custom_threads)) {
+        print_usage();
+        return 1;
+    }
+    const bool known_queue = options.queue == "all" || options.queue == "locked" || options.queue == "batched" ||
+                             options.queue == "mpmc" || options.queue == "spsc";
+    const bool known_payload = options.payload == 0 || options.payload == 64 || options.payload == 256 ||
+                               options.payload == 1024;
+    if (!known_queue || !known_payload || options.capacity == 0 || options.batch == 0 || options.config.producers < 1 ||
+        options.config.consumers < 1 || !(options.config.seconds > 0)) {
+        print_usage();
+        return 1;
     }
-    
-    // Start consumer threads
-    for (int i = 0; i < num_consumers; i++) {
-        threads.push_back(std::thread(consumer, std::ref(queue), i, std::ref(done), std::ref(items_processed)));
+    if (options.queue == "spsc" && (options.config.producers != 1 || options.config.consumers != 1)) {
+        std::cerr << "SpscQueue takes exactly one producer and one consumer" << std::endl;
+        return 1;
     }
-    
-    // Wait for producers to finish
-    for (int i = 0; i < num_producers; i++) {
-        threads[i].join();
+    // The unbounded queue is held to the same depth as the bounded ones
+    options.config.max_in_flight = options.capacity;
+
+    std::vector<std::pair<int, int>> thread_counts = {{1, 1}, {2, 2}, {4, 4}, {4, 1}, {1, 4}};
+    if (custom_threads) {
+        thread_counts = {{options.config.producers, options.config.consumers}};
     }
-    
-    // Wait until all items have been processed
-    while (items_processed < total_items) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const std::vector<std::string> queues =
+        options.queue == "all" ? std::vector<std::string>{"locked", "batched", "mpmc", "spsc"} : std::vector<std::string>{options.queue};
+
+    print_header();
+    bool all_ok = true;
+    for (const auto& [producers, consumers] : thread_counts) {
+        StressConfig config = options.config;
+        config.producers = producers;
+        config.consumers = consumers;
+        for (const std::string& queue : queues) {
+            if (queue == "spsc" && (producers != 1 || consumers != 1)) {
+                continue;
+            }
+            all_ok = run_config(queue, config, options.payload, options.capacity, options.batch) && all_ok;
+        }
     }
-    
-    // Signal consumers to finish and wait for them
-    done = true;
-    for (int i = num_producers; i < num_producers + num_consumers; i++) {
-        threads[i].join();
+    if (!all_ok) {
+        std::cout << "Lost, duplicated, corrupted or reordered elements: see FAILED rows" << std::endl;
+        return 1;
     }
-    
-    std::cout << "All items processed successfully!" << std::endl;
+    std::cout << "Every element arrived exactly once, intact and in order" << std::endl;
     return 0;
 }
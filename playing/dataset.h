@@ -0,0 +1,520 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv> // For std::from_chars, which parses in place without copying the field
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility> // For std::exchange
+#include <vector>
+
+#include "mapped_file.h"
+
+/**
+ * @struct DatasetChunk
+ * @brief A block of consecutive training rows: a row-major feature matrix and its targets.
+ *
+ * features and targets either point into storage owned by the chunk (for parsed formats)
+ * or straight into a memory-mapped file, so a chunk can be handed to
+ * Perceptron::train_epoch or predict_batch without copying either way.
+ */
+struct DatasetChunk {
+    const double* features = nullptr; // rows x num_features values, row-major.
+    const int* targets = nullptr;     // One label per row.
+    size_t rows = 0;
+
+    // Backing storage for readers that have to parse; unused for mapped files.
+    std::vector<double> feature_storage;
+    std::vector<int> target_storage;
+};
+
+/**
+ * @class MappedDataset
+ * @brief A binary training set read through a memory mapping.
+ *
+ * The file holds a 64-byte header (the magic "PDS1", the feature count as a 32-bit word,
+ * the row count as a 64-bit word, zero padding), then the row-major feature matrix as
+ * doubles, then one 32-bit label per row, all little-endian. The header size keeps the
+ * matrix 64-byte aligned inside the mapping, so chunks point directly at the file with no
+ * parsing and no copy.
+ *
+ * read_chunk hands out chunk_rows rows at a time. Before it returns a chunk it asks the
+ * kernel to read the chunk's pages ahead and touches them, so when this runs on a
+ * DatasetStream's background thread the trainer never waits on a page fault. It also drops
+ * the pages of the chunk before the previous one from the process, so the resident set
+ * stays at about three chunks however large the file is.
+ */
+class MappedDataset {
+public:
+    static constexpr char MAGIC[4] = {'P', 'D', 'S', '1'};
+    static constexpr size_t HEADER_SIZE = 64;
+
+    /**
+     * @brief Maps the dataset at path.
+     * @param chunk_rows Number of rows read_chunk hands out at a time.
+     *
+     * Throws std::runtime_error if the file cannot be opened or mapped, and
+     * std::invalid_argument if it is not a dataset or its size does not match its header.
+     */
+    MappedDataset(const std::string& path, size_t chunk_rows)
+        : mapping(path), chunk_rows(std::max<size_t>(chunk_rows, 1)) {
+        static_assert(sizeof(int) == sizeof(int32_t), "Labels are mapped as int");
+        const char* data = mapping.data();
+        const size_t length = mapping.size();
+        if (length < HEADER_SIZE) {
+            throw std::invalid_argument(path + " is not a dataset");
+        }
+        // The file is read front to back once per epoch
+        mapping.advise(MADV_SEQUENTIAL);
+
+        uint32_t features_per_row;
+        uint64_t rows;
+        std::memcpy(&features_per_row, data + 4, sizeof(features_per_row));
+        std::memcpy(&rows, data + 8, sizeof(rows));
+        const uint64_t row_bytes = uint64_t{features_per_row} * sizeof(double) + sizeof(int32_t);
+        if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || features_per_row == 0 ||
+            rows > (length - HEADER_SIZE) / row_bytes || HEADER_SIZE + rows * row_bytes != length) {
+            throw std::invalid_argument(path + " is not a dataset");
+        }
+        features = features_per_row;
+        row_count = static_cast<size_t>(rows);
+    }
+
+    MappedDataset(const MappedDataset&) = delete;
+    MappedDataset& operator=(const MappedDataset&) = delete;
+
+    size_t num_features() const { return features; }
+    size_t num_rows() const { return row_count; }
+
+    // The whole feature matrix and label array, for callers that want random access
+    const double* feature_data() const { return reinterpret_cast<const double*>(mapping.data() + HEADER_SIZE); }
+    const int* target_data() const {
+        return reinterpret_cast<const int*>(mapping.data() + HEADER_SIZE + row_count * features * sizeof(double));
+    }
+
+    /**
+     * @brief Points chunk at the next chunk_rows rows, with their pages resident.
+     * @return false once every row has been handed out.
+     */
+    bool read_chunk(DatasetChunk& chunk) {
+        if (cursor >= row_count) {
+            return false;
+        }
+        const size_t rows = std::min(chunk_rows, row_count - cursor);
+        chunk.features = feature_data() + cursor * features;
+        chunk.targets = target_data() + cursor;
+        chunk.rows = rows;
+
+        // The caller is done with everything before the previous chunk
+        release_rows(released, previous);
+        released = previous;
+        previous = cursor;
+        load_rows(cursor, rows);
+        cursor += rows;
+        return true;
+    }
+
+    // Starts over at the first row, e.g. for the next epoch
+    void rewind() {
+        release_rows(released, row_count);
+        cursor = released = previous = 0;
+    }
+
+    /**
+     * @brief Writes a dataset file, replacing any existing one.
+     * @param features Row-major matrix of num_rows rows with num_features values each.
+     * @param targets One label per row.
+     *
+     * Throws std::runtime_error if the file cannot be written.
+     */
+    static void write(const std::string& path, const double* features, const int* targets, size_t num_rows,
+                      size_t num_features) {
+        static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Dataset files are little-endian");
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Cannot create " + path + ": " + std::strerror(errno));
+        }
+        char header[HEADER_SIZE] = {};
+        const uint32_t features_per_row = static_cast<uint32_t>(num_features);
+        const uint64_t rows = num_rows;
+        std::memcpy(header, MAGIC, sizeof(MAGIC));
+        std::memcpy(header + 4, &features_per_row, sizeof(features_per_row));
+        std::memcpy(header + 8, &rows, sizeof(rows));
+        file.write(header, sizeof(header));
+        file.write(reinterpret_cast<const char*>(features),
+                   static_cast<std::streamsize>(num_rows * num_features * sizeof(double)));
+        file.write(reinterpret_cast<const char*>(targets), static_cast<std::streamsize>(num_rows * sizeof(int)));
+        file.close();
+        if (!file) {
+            throw std::runtime_error("Cannot write " + path + ": " + std::strerror(errno));
+        }
+    }
+
+private:
+    // Applies advice to the pages covering [begin, begin + bytes). Pages shared with a
+    // neighbouring range are included when widen is set and left alone otherwise.
+    static void advise(const void* begin, size_t bytes, int advice, bool widen) {
+        static const uintptr_t page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+        uintptr_t first = reinterpret_cast<uintptr_t>(begin);
+        uintptr_t last = first + bytes;
+        first = widen ? first / page * page : (first + page - 1) / page * page;
+        last = widen ? (last + page - 1) / page * page : last / page * page;
+        if (first < last) {
+            ::madvise(reinterpret_cast<void*>(first), last - first, advice);
+        }
+    }
+
+    void load_rows(size_t first, size_t rows) const {
+        const char* matrix = reinterpret_cast<const char*>(feature_data() + first * features);
+        const size_t matrix_bytes = rows * features * sizeof(double);
+        advise(matrix, matrix_bytes, MADV_WILLNEED, true);
+        advise(target_data() + first, rows * sizeof(int), MADV_WILLNEED, true);
+
+        // Readahead is only a hint; one load per page makes sure the pages are in
+        static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        volatile char sink = 0;
+        for (size_t offset = 0; offset < matrix_bytes; offset += page) {
+            sink = sink + matrix[offset];
+        }
+        const char* labels = reinterpret_cast<const char*>(target_data() + first);
+        for (size_t offset = 0; offset < rows * sizeof(int); offset += page) {
+            sink = sink + labels[offset];
+        }
+    }
+
+    void release_rows(size_t first, size_t last) const {
+        if (first >= last) {
+            return;
+        }
+        advise(feature_data() + first * features, (last - first) * features * sizeof(double), MADV_DONTNEED, false);
+        advise(target_data() + first, (last - first) * sizeof(int), MADV_DONTNEED, false);
+    }
+
+    MappedFile mapping;
+    size_t features = 0;
+    size_t row_count = 0;
+    size_t chunk_rows;
+    size_t cursor = 0;   // First row of the next chunk.
+    size_t previous = 0; // First row of the chunk handed out last.
+    size_t released = 0; // Rows before this have had their pages dropped.
+};
+
+/**
+ * @class CsvDataset
+ * @brief Streams a CSV training set in chunks with a fixed amount of memory.
+ *
+ * Each line holds num_features numbers followed by the integer label, separated by commas.
+ * The file is read in blocks of block_bytes with plain read() calls, and the fields are
+ * parsed with std::from_chars right where they sit in the block: no line or field is ever
+ * copied into a std::string. A line cut off at the end of a block is moved to the front of
+ * the buffer and finished by the next read. Memory use is the block plus one chunk of
+ * parsed rows, whatever the size of the file.
+ */
+class CsvDataset {
+public:
+    /**
+     * @brief Opens the CSV file at path.
+     * @param num_features Number of feature columns before the label.
+     * @param chunk_rows Number of rows read_chunk parses at a time.
+     * @param skip_header Whether the first line holds column names.
+     * @param block_bytes Size of each read from the file.
+     *
+     * Throws std::runtime_error if the file cannot be opened.
+     */
+    CsvDataset(const std::string& path, size_t num_features, size_t chunk_rows, bool skip_header = false,
+               size_t block_bytes = 1 << 20)
+        : path(path), features(num_features), chunk_rows(std::max<size_t>(chunk_rows, 1)),
+          skip_header(skip_header), buffer(std::max<size_t>(block_bytes, 64)) {
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+        }
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        rewind();
+    }
+
+    ~CsvDataset() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    CsvDataset(const CsvDataset&) = delete;
+    CsvDataset& operator=(const CsvDataset&) = delete;
+
+    size_t num_features() const { return features; }
+
+    /**
+     * @brief Parses up to chunk_rows rows into chunk's own storage.
+     * @return false once the file is exhausted.
+     *
+     * Throws std::invalid_argument naming the line if a line does not hold num_features
+     * numbers and a label, and std::runtime_error if reading fails.
+     */
+    bool read_chunk(DatasetChunk& chunk) {
+        chunk.feature_storage.resize(chunk_rows * features);
+        chunk.target_storage.resize(chunk_rows);
+        size_t rows = 0;
+        const char* line;
+        const char* line_end;
+        while (rows < chunk_rows && next_line(line, line_end)) {
+            if (line == line_end || (skip_header && line_number == 1)) {
+                continue; // Blank lines and the header carry no sample
+            }
+            parse_line(line, line_end, chunk.feature_storage.data() + rows * features, chunk.target_storage[rows]);
+            ++rows;
+        }
+        chunk.features = chunk.feature_storage.data();
+        chunk.targets = chunk.target_storage.data();
+        chunk.rows = rows;
+        return rows > 0;
+    }
+
+    // Starts over at the first line, e.g. for the next epoch
+    void rewind() {
+        if (::lseek(fd, 0, SEEK_SET) < 0) {
+            throw std::runtime_error("Cannot seek in " + path + ": " + std::strerror(errno));
+        }
+        begin = end = 0;
+        at_eof = false;
+        line_number = 0;
+    }
+
+    // Writes rows in the format read_chunk expects, with doubles in their shortest
+    // round-trip form so reading the file back gives the same values bit for bit
+    static void write(const std::string& path, const double* features, const int* targets, size_t num_rows,
+                      size_t num_features) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Cannot create " + path + ": " + std::strerror(errno));
+        }
+        std::string chunk;
+        char number[32];
+        for (size_t r = 0; r < num_rows; ++r) {
+            for (size_t i = 0; i < num_features; ++i) {
+                chunk.append(number, std::to_chars(number, number + sizeof(number), features[r * num_features + i]).ptr);
+                chunk += ',';
+            }
+            chunk.append(number, std::to_chars(number, number + sizeof(number), targets[r]).ptr);
+            chunk += '\n';
+            if (chunk.size() >= (1 << 20)) {
+                file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                chunk.clear();
+            }
+        }
+        file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        file.close();
+        if (!file) {
+            throw std::runtime_error("Cannot write " + path + ": " + std::strerror(errno));
+        }
+    }
+
+private:
+    // Finds the next line in the buffer, refilling it as needed. The line stays valid until
+    // the next call. A trailing '\r' is left out, so Windows line endings work.
+    bool next_line(const char*& line, const char*& line_end) {
+        for (;;) {
+            const char* start = buffer.data() + begin;
+            const char* newline = static_cast<const char*>(std::memchr(start, '\n', end - begin));
+            if (newline || (at_eof && begin < end)) {
+                line = start;
+                line_end = newline ? newline : buffer.data() + end;
+                begin = newline ? static_cast<size_t>(newline - buffer.data()) + 1 : end;
+                if (line_end > line && line_end[-1] == '\r') {
+                    --line_end;
+                }
+                ++line_number;
+                return true;
+            }
+            if (at_eof) {
+                return false;
+            }
+            // Keep the unfinished line, moved to the front, and read after it
+            std::memmove(buffer.data(), start, end - begin);
+            end -= begin;
+            begin = 0;
+            if (end == buffer.size()) {
+                buffer.resize(buffer.size() * 2); // A single line longer than the block
+            }
+            const ssize_t got = ::read(fd, buffer.data() + end, buffer.size() - end);
+            if (got < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("Cannot read " + path + ": " + std::strerror(errno));
+            }
+            at_eof = (got == 0);
+            end += static_cast<size_t>(got);
+        }
+    }
+
+    void parse_line(const char* p, const char* line_end, double* row, int& target) const {
+        for (size_t i = 0; i <= features; ++i) {
+            while (p < line_end && (*p == ' ' || *p == '\t')) {
+                ++p;
+            }
+            // from_chars rejects a leading '+', which some writers emit
+            if (p < line_end && *p == '+') {
+                ++p;
+            }
+            const std::from_chars_result result =
+                (i < features) ? std::from_chars(p, line_end, row[i]) : std::from_chars(p, line_end, target);
+            if (result.ec != std::errc()) {
+                break;
+            }
+            p = result.ptr;
+            while (p < line_end && (*p == ' ' || *p == '\t')) {
+                ++p;
+            }
+            if (i == features) {
+                if (p == line_end) {
+                    return;
+                }
+                break;
+            }
+            if (p == line_end || *p != ',') {
+                break;
+            }
+            ++p;
+        }
+        throw std::invalid_argument(path + ":" + std::to_string(line_number) + ": expected " +
+                                    std::to_string(features) + " numbers and a label");
+    }
+
+    std::string path;
+    int fd = -1;
+    size_t features;
+    size_t chunk_rows;
+    bool skip_header;
+    std::vector<char> buffer;
+    size_t begin = 0; // Unconsumed bytes of the buffer are [begin, end).
+    size_t end = 0;
+    bool at_eof = false;
+    size_t line_number = 0;
+};
+
+/**
+ * @class DatasetStream
+ * @brief Loads the next chunk on a background thread while the caller trains on this one.
+ *
+ * The stream owns two chunks. A loader thread fills whichever is free by calling the
+ * dataset's read_chunk, and next() hands them to the caller in order. The chunk returned
+ * by next() stays valid until the following call, which gives it back for refilling, so
+ * reading, parsing and page faults overlap with training and at most two chunks are ever
+ * in memory. An exception thrown by the loader is rethrown from next().
+ *
+ * @code
+ * MappedDataset data("train.bin", 65536);
+ * DatasetStream stream([&data](DatasetChunk& c) { return data.read_chunk(c); });
+ * while (const DatasetChunk* chunk = stream.next()) {
+ *     p.train_epoch(chunk->features, chunk->targets, chunk->rows, 32, gen);
+ * }
+ * @endcode
+ */
+class DatasetStream {
+public:
+    // Fills a chunk and returns true, or returns false when there are no more rows
+    using Loader = std::function<bool(DatasetChunk&)>;
+
+    explicit DatasetStream(Loader loader) : loader(std::move(loader)) {
+        free_slots = {0, 1};
+        worker = std::thread([this] { load_loop(); });
+    }
+
+    ~DatasetStream() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        slot_freed.notify_one();
+        worker.join();
+    }
+
+    DatasetStream(const DatasetStream&) = delete;
+    DatasetStream& operator=(const DatasetStream&) = delete;
+
+    /**
+     * @brief Waits for the next chunk.
+     * @return The chunk, or nullptr once the dataset is exhausted.
+     */
+    const DatasetChunk* next() {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (held >= 0) {
+            free_slots.push_back(held);
+            held = -1;
+            slot_freed.notify_one();
+        }
+        chunk_ready.wait(lock, [this] { return !ready_slots.empty() || finished; });
+        if (ready_slots.empty()) {
+            if (error) {
+                std::rethrow_exception(std::exchange(error, nullptr));
+            }
+            return nullptr;
+        }
+        held = ready_slots.front();
+        ready_slots.pop_front();
+        return &slots[held];
+    }
+
+private:
+    void load_loop() {
+        for (;;) {
+            int slot;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                slot_freed.wait(lock, [this] { return !free_slots.empty() || stopping; });
+                if (stopping) {
+                    return;
+                }
+                slot = free_slots.front();
+                free_slots.pop_front();
+            }
+
+            // The slot is ours alone until it is queued, so the load runs unlocked
+            bool loaded = false;
+            std::exception_ptr failure;
+            try {
+                loaded = loader(slots[slot]);
+            } catch (...) {
+                failure = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!loaded) {
+                error = failure;
+                finished = true;
+                chunk_ready.notify_one();
+                return;
+            }
+            ready_slots.push_back(slot);
+            chunk_ready.notify_one();
+        }
+    }
+
+    Loader loader;
+    DatasetChunk slots[2];
+    std::mutex mutex;
+    std::condition_variable chunk_ready;
+    std::condition_variable slot_freed;
+    std::deque<int> free_slots;  // Slots the loader may fill.
+    std::deque<int> ready_slots; // Filled slots in dataset order.
+    int held = -1;               // The slot the caller is using.
+    bool finished = false;
+    bool stopping = false;
+    std::exception_ptr error;
+    std::thread worker;
+};
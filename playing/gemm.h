@@ -0,0 +1,308 @@
+#pragma once
+
+#include <algorithm> // For std::min and std::fill
+#include <cstddef>
+#include <vector>
+
+// The AVX2 and AVX-512 micro-kernels are compiled with target attributes and only called
+// when the CPU reports support for them at run time
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define GEMM_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define GEMM_X86_SIMD 0
+#endif
+
+/**
+ * @class Gemm
+ * @brief Cache-blocked, register-tiled double-precision matrix multiply.
+ *
+ * Computes C = op(A) * op(B), or C += op(A) * op(B), for row-major matrices, where op()
+ * optionally transposes its argument. This is the kernel behind the MLP's forward and
+ * backward passes.
+ *
+ * The loops follow the usual BLIS/GotoBLAS layering: a KC x NC block of op(B) is packed
+ * into NR-wide column panels that stay in L2/L3, an MC x KC block of op(A) is packed into
+ * MR-tall row panels that stay in L2, and a micro-kernel multiplies one A panel by one B
+ * panel into an MR x NR tile of C held entirely in vector registers. Packing also takes
+ * care of the transposes and zero-pads partial panels, so the micro-kernel only ever sees
+ * full, contiguous tiles.
+ */
+class Gemm {
+private:
+    static constexpr size_t MR = 6;    // Rows of C per micro-tile
+    static constexpr size_t MC = 72;   // Rows of op(A) per packed block (a multiple of MR)
+    static constexpr size_t KC = 256;  // Depth of a packed block
+    static constexpr size_t NC = 4096; // Columns of op(B) per packed block (a multiple of every NR)
+
+    /**
+     * @brief Picks the widest micro-kernel this CPU can run.
+     * @return 2 for AVX-512, 1 for AVX2 with FMA, 0 for the portable loop.
+     */
+    static int detect_simd_level() {
+#if GEMM_X86_SIMD
+        if (__builtin_cpu_supports("avx512f")) {
+            return 2;
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            return 1;
+        }
+#endif
+        return 0;
+    }
+
+    // Columns of C per micro-tile: two vector registers' worth, or 8 for the portable loop
+    static size_t tile_width() {
+        return simd_level >= 2 ? 16 : 8;
+    }
+
+    // Packs rows [row0, row0 + mc) x depth [p0, p0 + kc) of op(A) as MR-row panels, each
+    // stored depth-major (MR values per depth step); rows past mc are zero
+    static void pack_a(bool trans, const double* a, size_t lda, size_t row0, size_t mc, size_t p0, size_t kc,
+                       double* packed) {
+        for (size_t i0 = 0; i0 < mc; i0 += MR) {
+            const size_t rows = std::min(MR, mc - i0);
+            for (size_t p = 0; p < kc; ++p) {
+                for (size_t i = 0; i < rows; ++i) {
+                    const size_t row = row0 + i0 + i;
+                    const size_t depth = p0 + p;
+                    packed[i] = trans ? a[depth * lda + row] : a[row * lda + depth];
+                }
+                std::fill(packed + rows, packed + MR, 0.0);
+                packed += MR;
+            }
+        }
+    }
+
+    // Packs depth [p0, p0 + kc) x columns [col0, col0 + nc) of op(B) as nr-column panels,
+    // each stored depth-major (nr values per depth step); columns past nc are zero
+    static void pack_b(bool trans, const double* b, size_t ldb, size_t p0, size_t kc, size_t col0, size_t nc,
+                       size_t nr, double* packed) {
+        for (size_t j0 = 0; j0 < nc; j0 += nr) {
+            const size_t cols = std::min(nr, nc - j0);
+            for (size_t p = 0; p < kc; ++p) {
+                const size_t depth = p0 + p;
+                if (!trans && cols == nr) {
+                    std::copy(b + depth * ldb + col0 + j0, b + depth * ldb + col0 + j0 + nr, packed);
+                } else {
+                    for (size_t j = 0; j < cols; ++j) {
+                        const size_t col = col0 + j0 + j;
+                        packed[j] = trans ? b[col * ldb + depth] : b[depth * ldb + col];
+                    }
+                    std::fill(packed + cols, packed + nr, 0.0);
+                }
+                packed += nr;
+            }
+        }
+    }
+
+    // The micro-kernels: tile (MR x nr, row stride ldt) = or += packed A panel * packed B
+    // panel over kc depth steps. They always produce a full tile; edge tiles go through a
+    // scratch tile in multiply_block.
+    static void kernel_scalar(size_t kc, const double* a, const double* b, double* tile, size_t ldt, bool accumulate) {
+        constexpr size_t NR = 8;
+        double acc[MR][NR] = {};
+        for (size_t p = 0; p < kc; ++p, a += MR, b += NR) {
+            for (size_t i = 0; i < MR; ++i) {
+                for (size_t j = 0; j < NR; ++j) {
+                    acc[i][j] += a[i] * b[j];
+                }
+            }
+        }
+        for (size_t i = 0; i < MR; ++i) {
+            for (size_t j = 0; j < NR; ++j) {
+                tile[i * ldt + j] = accumulate ? tile[i * ldt + j] + acc[i][j] : acc[i][j];
+            }
+        }
+    }
+
+#if GEMM_X86_SIMD
+    // 6 x 8 tile in twelve ymm accumulators; each depth step is two B loads, six A
+    // broadcasts and twelve FMAs
+    __attribute__((target("avx2,fma")))
+    static void kernel_avx2(size_t kc, const double* a, const double* b, double* tile, size_t ldt, bool accumulate) {
+        __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+        __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+        __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+        __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+        __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+        __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+        for (size_t p = 0; p < kc; ++p, a += MR, b += 8) {
+            const __m256d b0 = _mm256_loadu_pd(b);
+            const __m256d b1 = _mm256_loadu_pd(b + 4);
+            __m256d ai = _mm256_broadcast_sd(a);
+            c00 = _mm256_fmadd_pd(ai, b0, c00);
+            c01 = _mm256_fmadd_pd(ai, b1, c01);
+            ai = _mm256_broadcast_sd(a + 1);
+            c10 = _mm256_fmadd_pd(ai, b0, c10);
+            c11 = _mm256_fmadd_pd(ai, b1, c11);
+            ai = _mm256_broadcast_sd(a + 2);
+            c20 = _mm256_fmadd_pd(ai, b0, c20);
+            c21 = _mm256_fmadd_pd(ai, b1, c21);
+            ai = _mm256_broadcast_sd(a + 3);
+            c30 = _mm256_fmadd_pd(ai, b0, c30);
+            c31 = _mm256_fmadd_pd(ai, b1, c31);
+            ai = _mm256_broadcast_sd(a + 4);
+            c40 = _mm256_fmadd_pd(ai, b0, c40);
+            c41 = _mm256_fmadd_pd(ai, b1, c41);
+            ai = _mm256_broadcast_sd(a + 5);
+            c50 = _mm256_fmadd_pd(ai, b0, c50);
+            c51 = _mm256_fmadd_pd(ai, b1, c51);
+        }
+        const __m256d rows[MR][2] = {{c00, c01}, {c10, c11}, {c20, c21}, {c30, c31}, {c40, c41}, {c50, c51}};
+        for (size_t i = 0; i < MR; ++i) {
+            double* out = tile + i * ldt;
+            __m256d lo = rows[i][0], hi = rows[i][1];
+            if (accumulate) {
+                lo = _mm256_add_pd(lo, _mm256_loadu_pd(out));
+                hi = _mm256_add_pd(hi, _mm256_loadu_pd(out + 4));
+            }
+            _mm256_storeu_pd(out, lo);
+            _mm256_storeu_pd(out + 4, hi);
+        }
+    }
+
+    // 6 x 16 tile in twelve zmm accumulators
+    __attribute__((target("avx512f")))
+    static void kernel_avx512(size_t kc, const double* a, const double* b, double* tile, size_t ldt, bool accumulate) {
+        __m512d c00 = _mm512_setzero_pd(), c01 = _mm512_setzero_pd();
+        __m512d c10 = _mm512_setzero_pd(), c11 = _mm512_setzero_pd();
+        __m512d c20 = _mm512_setzero_pd(), c21 = _mm512_setzero_pd();
+        __m512d c30 = _mm512_setzero_pd(), c31 = _mm512_setzero_pd();
+        __m512d c40 = _mm512_setzero_pd(), c41 = _mm512_setzero_pd();
+        __m512d c50 = _mm512_setzero_pd(), c51 = _mm512_setzero_pd();
+        for (size_t p = 0; p < kc; ++p, a += MR, b += 16) {
+            const __m512d b0 = _mm512_loadu_pd(b);
+            const __m512d b1 = _mm512_loadu_pd(b + 8);
+            __m512d ai = _mm512_set1_pd(a[0]);
+            c00 = _mm512_fmadd_pd(ai, b0, c00);
+            c01 = _mm512_fmadd_pd(ai, b1, c01);
+            ai = _mm512_set1_pd(a[1]);
+            c10 = _mm512_fmadd_pd(ai, b0, c10);
+            c11 = _mm512_fmadd_pd(ai, b1, c11);
+            ai = _mm512_set1_pd(a[2]);
+            c20 = _mm512_fmadd_pd(ai, b0, c20);
+            c21 = _mm512_fmadd_pd(ai, b1, c21);
+            ai = _mm512_set1_pd(a[3]);
+            c30 = _mm512_fmadd_pd(ai, b0, c30);
+            c31 = _mm512_fmadd_pd(ai, b1, c31);
+            ai = _mm512_set1_pd(a[4]);
+            c40 = _mm512_fmadd_pd(ai, b0, c40);
+            c41 = _mm512_fmadd_pd(ai, b1, c41);
+            ai = _mm512_set1_pd(a[5]);
+            c50 = _mm512_fmadd_pd(ai, b0, c50);
+            c51 = _mm512_fmadd_pd(ai, b1, c51);
+        }
+        const __m512d rows[MR][2] = {{c00, c01}, {c10, c11}, {c20, c21}, {c30, c31}, {c40, c41}, {c50, c51}};
+        for (size_t i = 0; i < MR; ++i) {
+            double* out = tile + i * ldt;
+            __m512d lo = rows[i][0], hi = rows[i][1];
+            if (accumulate) {
+                lo = _mm512_add_pd(lo, _mm512_loadu_pd(out));
+                hi = _mm512_add_pd(hi, _mm512_loadu_pd(out + 8));
+            }
+            _mm512_storeu_pd(out, lo);
+            _mm512_storeu_pd(out + 8, hi);
+        }
+    }
+#endif
+
+    // Runs the widest micro-kernel simd_level allows on one full tile
+    static void kernel(size_t kc, const double* a, const double* b, double* tile, size_t ldt, bool accumulate) {
+#if GEMM_X86_SIMD
+        if (simd_level >= 2) {
+            kernel_avx512(kc, a, b, tile, ldt, accumulate);
+            return;
+        }
+        if (simd_level >= 1) {
+            kernel_avx2(kc, a, b, tile, ldt, accumulate);
+            return;
+        }
+#endif
+        kernel_scalar(kc, a, b, tile, ldt, accumulate);
+    }
+
+    // Multiplies a packed mc x kc block of A by a packed kc x nc block of B into C. Full
+    // tiles are written in place; edge tiles are computed in a scratch tile and copied.
+    static void multiply_block(size_t mc, size_t nc, size_t kc, size_t nr, const double* packed_a,
+                               const double* packed_b, double* c, size_t ldc, bool accumulate) {
+        double edge[MR * 16];
+        for (size_t j0 = 0; j0 < nc; j0 += nr) {
+            const size_t cols = std::min(nr, nc - j0);
+            const double* b_panel = packed_b + j0 * kc;
+            for (size_t i0 = 0; i0 < mc; i0 += MR) {
+                const size_t rows = std::min(MR, mc - i0);
+                const double* a_panel = packed_a + i0 * kc;
+                double* tile = c + i0 * ldc + j0;
+                if (rows == MR && cols == nr) {
+                    kernel(kc, a_panel, b_panel, tile, ldc, accumulate);
+                    continue;
+                }
+                kernel(kc, a_panel, b_panel, edge, nr, false);
+                for (size_t i = 0; i < rows; ++i) {
+                    for (size_t j = 0; j < cols; ++j) {
+                        tile[i * ldc + j] = accumulate ? tile[i * ldc + j] + edge[i * nr + j] : edge[i * nr + j];
+                    }
+                }
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief Widest micro-kernel to use: 2 = AVX-512, 1 = AVX2 with FMA, 0 = portable.
+     *
+     * Starts at the best the CPU supports; lowering it selects a narrower kernel, which is
+     * how the tests and benchmarks reach the others.
+     */
+    static inline int simd_level = detect_simd_level();
+
+    /**
+     * @brief C = op(A) * op(B), or C += op(A) * op(B) when accumulate is set.
+     * @param trans_a If true, op(A) is the transpose of the stored A.
+     * @param trans_b If true, op(B) is the transpose of the stored B.
+     * @param m Rows of op(A) and of C.
+     * @param n Columns of op(B) and of C.
+     * @param k Columns of op(A), rows of op(B).
+     * @param a Row-major storage of A with row stride lda (A is m x k, or k x m if trans_a).
+     * @param b Row-major storage of B with row stride ldb (B is k x n, or n x k if trans_b).
+     * @param c Row-major m x n output with row stride ldc; must not overlap A or B.
+     *
+     * The packing buffers are thread-local and reused, so steady-state calls do not allocate.
+     */
+    static void multiply(bool trans_a, bool trans_b, size_t m, size_t n, size_t k, const double* a, size_t lda,
+                         const double* b, size_t ldb, double* c, size_t ldc, bool accumulate = false) {
+        if (m == 0 || n == 0) {
+            return;
+        }
+        if (k == 0) {
+            if (!accumulate) {
+                for (size_t i = 0; i < m; ++i) {
+                    std::fill(c + i * ldc, c + i * ldc + n, 0.0);
+                }
+            }
+            return;
+        }
+
+        const size_t nr = tile_width();
+        thread_local std::vector<double> packed_a;
+        thread_local std::vector<double> packed_b;
+        packed_a.resize(MC * KC);
+        packed_b.resize(KC * NC);
+
+        for (size_t jc = 0; jc < n; jc += NC) {
+            const size_t nc = std::min(NC, n - jc);
+            for (size_t pc = 0; pc < k; pc += KC) {
+                const size_t kc = std::min(KC, k - pc);
+                pack_b(trans_b, b, ldb, pc, kc, jc, nc, nr, packed_b.data());
+                // Only the first depth block may overwrite C; the rest add to it
+                const bool add = accumulate || pc > 0;
+                for (size_t ic = 0; ic < m; ic += MC) {
+                    const size_t mc = std::min(MC, m - ic);
+                    pack_a(trans_a, a, lda, ic, mc, pc, kc, packed_a.data());
+                    multiply_block(mc, nc, kc, nr, packed_a.data(), packed_b.data(), c + ic * ldc + jc, ldc, add);
+                }
+            }
+        }
+    }
+};
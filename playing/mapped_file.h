@@ -0,0 +1,100 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility> // For std::exchange
+
+/**
+ * @class MappedFile
+ * @brief A whole file mapped read-only into memory, unmapped again when the object goes.
+ *
+ * The constructor opens the file, maps all of it and closes the descriptor straight away;
+ * the mapping keeps the file alive, so no descriptor is held however long the object lives.
+ * The mapping is private and read-only. An empty file is not mapped at all: data() is null
+ * and size() is 0, which a reader's own header check then rejects.
+ *
+ * MappedModel, MappedDataset and BigNumArchive each hold one and read their format from
+ * data(). It is move-only, since two owners would unmap the same pages twice.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    /**
+     * @brief Maps the file at path.
+     *
+     * Throws std::runtime_error if the file cannot be opened, inspected or mapped.
+     */
+    explicit MappedFile(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            const int error = errno;
+            ::close(fd);
+            throw std::runtime_error("Cannot stat " + path + ": " + std::strerror(error));
+        }
+        const size_t length = static_cast<size_t>(info.st_size);
+        if (length == 0) {
+            ::close(fd); // mmap rejects a zero length
+            return;
+        }
+        void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        const int error = errno;
+        ::close(fd); // The mapping keeps the file alive
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("Cannot map " + path + ": " + std::strerror(error));
+        }
+        bytes = static_cast<const char*>(mapping);
+        length_ = length;
+    }
+
+    ~MappedFile() { unmap(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : bytes(std::exchange(other.bytes, nullptr)), length_(std::exchange(other.length_, 0)) {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            bytes = std::exchange(other.bytes, nullptr);
+            length_ = std::exchange(other.length_, 0);
+        }
+        return *this;
+    }
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length_; }
+
+    // Passes advice (MADV_SEQUENTIAL, ...) on the whole mapping to the kernel
+    void advise(int advice) const {
+        if (bytes) {
+            ::madvise(const_cast<char*>(bytes), length_, advice);
+        }
+    }
+
+private:
+    void unmap() {
+        if (bytes) {
+            ::munmap(const_cast<char*>(bytes), length_);
+            bytes = nullptr;
+            length_ = 0;
+        }
+    }
+
+    const char* bytes = nullptr;
+    size_t length_ = 0;
+};
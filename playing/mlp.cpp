@@ -0,0 +1,317 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>     // For std::remove
+#include <filesystem> // For std::filesystem::temp_directory_path
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gemm.h"
+#include "mlp.h"
+#include "model_file.h"
+#include "perceptron.h"
+#include "quantized.h"
+
+// Checks Gemm::multiply against a plain triple loop on random shapes, every transpose
+// combination, with and without accumulation, on every micro-kernel the CPU supports.
+// Shapes straddle the tile and block sizes so the edge tiles and the depth blocking run.
+int runGemmDifferentialTest(int trials) {
+    std::mt19937 gen(2718);
+    std::uniform_int_distribution<size_t> dim(1, 300);
+    std::uniform_real_distribution<> dis(-1.0, 1.0);
+    const int saved_level = Gemm::simd_level;
+
+    int matches = 0;
+    for (int t = 0; t < trials; ++t) {
+        const size_t m = dim(gen), n = dim(gen), k = (t % 5 == 0) ? 600 : dim(gen);
+        const bool trans_a = t & 1, trans_b = t & 2, accumulate = t & 4;
+        std::vector<double> a(m * k), b(k * n), c0(m * n);
+        for (double& x : a) x = dis(gen);
+        for (double& x : b) x = dis(gen);
+        for (double& x : c0) x = dis(gen);
+
+        // op(A)(i, p) and op(B)(p, j) read straight from the stored layout
+        std::vector<double> expected = c0;
+        for (size_t i = 0; i < m; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                double sum = accumulate ? c0[i * n + j] : 0.0;
+                for (size_t p = 0; p < k; ++p) {
+                    sum += (trans_a ? a[p * m + i] : a[i * k + p]) * (trans_b ? b[j * k + p] : b[p * n + j]);
+                }
+                expected[i * n + j] = sum;
+            }
+        }
+
+        bool ok = true;
+        for (int level = 0; level <= saved_level; ++level) {
+            Gemm::simd_level = level;
+            std::vector<double> c = c0;
+            Gemm::multiply(trans_a, trans_b, m, n, k, a.data(), trans_a ? m : k, b.data(), trans_b ? k : n, c.data(), n,
+                           accumulate);
+            for (size_t i = 0; i < m * n; ++i) {
+                ok = ok && std::fabs(c[i] - expected[i]) <= 1e-9 * (1.0 + std::fabs(expected[i]));
+            }
+        }
+        if (ok) {
+            ++matches;
+        }
+    }
+    Gemm::simd_level = saved_level;
+    return matches;
+}
+
+// Checks every int8 dot-product kernel the CPU supports against the portable one, with
+// lengths around the 32-byte vector step, three input rows by five weight rows (so full
+// tiles and every leftover path run) and values at the +-127 extremes.
+int runInt8DotTest(int trials) {
+    std::mt19937 gen(1618);
+    std::uniform_int_distribution<int> value(-127, 127);
+    const int saved_level = Int8Dot::simd_level;
+
+    int matches = 0;
+    for (int t = 0; t < trials; ++t) {
+        const size_t n = 1 + t * 7 % 200, rows = 3, cols = 5;
+        std::vector<int8_t> x(rows * n), w(cols * n);
+        for (int8_t& v : x) v = static_cast<int8_t>(t % 4 == 0 ? 127 : value(gen));
+        for (int8_t& v : w) v = static_cast<int8_t>(t % 4 == 0 ? -127 : value(gen));
+
+        std::vector<int32_t> expected(rows * cols), actual(rows * cols);
+        Int8Dot::simd_level = 0;
+        Int8Dot::dot_rows(x.data(), rows, w.data(), cols, n, expected.data());
+        bool ok = true;
+        for (int level = 1; level <= saved_level; ++level) {
+            Int8Dot::simd_level = level;
+            Int8Dot::dot_rows(x.data(), rows, w.data(), cols, n, actual.data());
+            ok = ok && actual == expected;
+        }
+        if (ok) {
+            ++matches;
+        }
+    }
+    Int8Dot::simd_level = saved_level;
+    return matches;
+}
+
+// Saves random Perceptrons and MLPs, maps the files back and checks that the mapped models
+// predict bit for bit what the originals do. Each trial also damages the file (truncating
+// it, or claiming a newer format version) and checks that opening it is refused.
+int runModelFileTest(int trials) {
+    std::mt19937 gen(577);
+    std::uniform_int_distribution<size_t> width(1, 90);
+    std::uniform_real_distribution<> dis(-2.0, 2.0);
+    const std::string path = std::filesystem::temp_directory_path().string() + "/mlp_model_test.pmf";
+
+    int matches = 0;
+    for (int t = 0; t < trials; ++t) {
+        const size_t rows = 1 + gen() % 40;
+        std::vector<size_t> sizes = {width(gen)};
+        if (t % 2 == 1) {
+            for (size_t l = gen() % 3; l-- > 0;) sizes.push_back(width(gen));
+            sizes.push_back(1 + gen() % 3);
+        }
+        std::vector<double> x(rows * sizes[0]);
+        for (double& v : x) v = dis(gen);
+
+        std::vector<double> expected, actual;
+        std::vector<int> expected_classes(rows), actual_classes(rows);
+        if (t % 2 == 0) {
+            Perceptron p(static_cast<int>(sizes[0]));
+            p.train_epoch(x.data(), expected_classes.data(), rows, 4, gen); // Moves the weights off their start
+            p.predict_batch(x.data(), rows, expected_classes.data());
+            expected.assign(expected_classes.begin(), expected_classes.end());
+            MappedModel::write(path, p);
+        } else {
+            MLP mlp(sizes, (t % 4 == 1) ? MLP::Activation::ReLU : MLP::Activation::Sigmoid, 0.1, t);
+            expected.resize(rows * mlp.num_outputs());
+            mlp.predict_batch(x.data(), rows, expected.data());
+            for (size_t r = 0; r < rows; ++r) {
+                expected_classes[r] = expected[r * mlp.num_outputs()] >= 0.5 ? 1 : 0;
+            }
+            MappedModel::write(path, mlp);
+        }
+
+        bool ok;
+        {
+            MappedModel model(path);
+            actual.resize(rows * model.num_outputs());
+            model.predict_batch(x.data(), rows, actual.data());
+            model.predict_batch(x.data(), rows, actual_classes.data());
+            ok = model.num_inputs() == sizes[0] && actual == expected && actual_classes == expected_classes;
+        }
+
+        // Damaged files must be refused rather than read out of bounds
+        if (t % 2 == 0) {
+            std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+        } else {
+            const uint32_t newer = MappedModel::FORMAT_VERSION + 1;
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(4);
+            file.write(reinterpret_cast<const char*>(&newer), sizeof(newer));
+        }
+        try {
+            MappedModel damaged(path);
+            ok = false;
+        } catch (const std::invalid_argument&) {
+        }
+        if (ok) {
+            ++matches;
+        }
+    }
+    std::remove(path.c_str());
+    return matches;
+}
+
+// Startup cost of serving from a model file: saves a 160 MB MLP, then times opening the
+// file and the first prediction, which pulls the weights in from the page cache.
+void run_model_file_report() {
+    MLP mlp({1024, 4096, 4096, 1}, MLP::Activation::ReLU, 0.1, 3);
+    const std::string path = std::filesystem::temp_directory_path().string() + "/mlp_model_report.pmf";
+    MappedModel::write(path, mlp);
+    std::vector<double> x(1024, 0.5);
+    double expected, actual;
+    mlp.predict_batch(x.data(), 1, &expected);
+
+    auto start = std::chrono::steady_clock::now();
+    MappedModel model(path);
+    auto opened = std::chrono::steady_clock::now();
+    model.predict_batch(x.data(), 1, &actual);
+    auto predicted = std::chrono::steady_clock::now();
+    model.predict_batch(x.data(), 1, &actual);
+    auto warm = std::chrono::steady_clock::now();
+    auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+    std::cout << "Model file " << std::filesystem::file_size(path) / (1 << 20) << " MB: open " << ms(start, opened)
+              << " ms, first prediction " << ms(opened, predicted) << " ms, warm prediction " << ms(predicted, warm)
+              << " ms (" << (actual == expected ? "matches" : "differs from") << " the in-memory MLP)" << std::endl;
+    std::remove(path.c_str());
+}
+
+// Accuracy delta of int8 post-training quantization: trains a Perceptron on a linear
+// problem and an MLP on a nonlinear one in double precision, quantizes both with the
+// training data as calibration set, and compares them on held-out data.
+void run_quantization_report() {
+    const size_t num_inputs = 64, train_rows = 20000, test_rows = 5000;
+    std::mt19937 gen(99);
+    std::normal_distribution<> dis(0.0, 1.0);
+    auto make_data = [&](size_t rows, std::vector<double>& x, std::vector<int>& linear, std::vector<double>& ring) {
+        x.resize(rows * num_inputs);
+        linear.resize(rows);
+        ring.resize(rows);
+        for (size_t r = 0; r < rows; ++r) {
+            double dot = 0.0, norm = 0.0;
+            for (size_t i = 0; i < num_inputs; ++i) {
+                const double v = dis(gen);
+                x[r * num_inputs + i] = v;
+                dot += v * ((i % 3 == 0) ? 1.0 : -0.5);
+                norm += (i < 4) ? v * v : 0.0;
+            }
+            linear[r] = dot >= 0 ? 1 : 0;
+            ring[r] = norm < 3.36 ? 1.0 : 0.0; // Inside a sphere in the first 4 features: about half the samples
+        }
+    };
+    std::vector<double> train_x, test_x, train_ring, test_ring;
+    std::vector<int> train_linear, test_linear;
+    make_data(train_rows, train_x, train_linear, train_ring);
+    make_data(test_rows, test_x, test_linear, test_ring);
+
+    Perceptron perceptron(static_cast<int>(num_inputs));
+    MLP mlp({num_inputs, 128, 64, 1}, MLP::Activation::ReLU, 0.05, 5);
+    for (int epoch = 0; epoch < 20; ++epoch) {
+        perceptron.train_epoch(train_x.data(), train_linear.data(), train_rows, 32, gen);
+        mlp.train_epoch(train_x.data(), train_ring.data(), train_rows, 64, gen);
+    }
+    QuantizedPerceptron quantized_perceptron(perceptron, train_x.data(), train_rows);
+    QuantizedMLP quantized_mlp(mlp, train_x.data(), train_rows);
+
+    std::vector<int8_t> test_q(test_rows * num_inputs);
+    std::vector<int> predicted(test_rows), predicted_q(test_rows);
+    perceptron.predict_batch(test_x.data(), test_rows, predicted.data());
+    quantized_perceptron.quantize_inputs(test_x.data(), test_rows, test_q.data());
+    quantized_perceptron.predict_batch(test_q.data(), test_rows, predicted_q.data());
+    size_t correct = 0, correct_q = 0, agree = 0;
+    for (size_t r = 0; r < test_rows; ++r) {
+        correct += predicted[r] == test_linear[r];
+        correct_q += predicted_q[r] == test_linear[r];
+        agree += predicted[r] == predicted_q[r];
+    }
+    std::cout << "Perceptron: double " << 100.0 * correct / test_rows << "%, int8 " << 100.0 * correct_q / test_rows
+              << "% accuracy; " << 100.0 * agree / test_rows << "% of predictions unchanged" << std::endl;
+
+    std::vector<double> probability(test_rows), probability_q(test_rows);
+    mlp.predict_batch(test_x.data(), test_rows, probability.data());
+    quantized_mlp.quantize_inputs(test_x.data(), test_rows, test_q.data());
+    quantized_mlp.predict_batch(test_q.data(), test_rows, probability_q.data());
+    correct = correct_q = agree = 0;
+    double max_delta = 0.0;
+    for (size_t r = 0; r < test_rows; ++r) {
+        const int label = static_cast<int>(test_ring[r]);
+        correct += (probability[r] >= 0.5) == label;
+        correct_q += (probability_q[r] >= 0.5) == label;
+        agree += (probability[r] >= 0.5) == (probability_q[r] >= 0.5);
+        max_delta = std::max(max_delta, std::fabs(probability[r] - probability_q[r]));
+    }
+    std::cout << "MLP " << num_inputs << "-128-64-1: double " << 100.0 * correct / test_rows << "%, int8 "
+              << 100.0 * correct_q / test_rows << "% accuracy; " << 100.0 * agree / test_rows
+              << "% of predictions unchanged, largest probability change " << max_delta << std::endl;
+}
+
+int main() {
+    // --- 1. The matrix multiply behind the MLP ---
+    const int gemm_trials = 64;
+    std::cout << "--- GEMM Differential Test ---" << std::endl;
+    std::cout << runGemmDifferentialTest(gemm_trials) << "/" << gemm_trials
+              << " products match the reference loop on every kernel" << std::endl;
+
+    const int int8_trials = 64;
+    std::cout << "\n--- Int8 Dot Product Test ---" << std::endl;
+    std::cout << runInt8DotTest(int8_trials) << "/" << int8_trials
+              << " dot products match the portable kernel on every kernel" << std::endl;
+
+    const int model_trials = 40;
+    std::cout << "\n--- Model File Test ---" << std::endl;
+    std::cout << runModelFileTest(model_trials) << "/" << model_trials
+              << " mapped models predict exactly like the originals" << std::endl;
+
+    // --- 2. Setup ---
+    // XOR is the textbook problem a single Perceptron cannot learn: no straight line
+    // separates {[0, 1], [1, 0]} from {[0, 0], [1, 1]}. One hidden layer is enough.
+    MLP mlp({2, 8, 1}, MLP::Activation::ReLU, 0.5, 7);
+    std::cout << "\n--- XOR with an MLP ---" << std::endl;
+    mlp.print_layers();
+
+    // --- 3. Training Data (for a logical XOR gate), one row-major matrix ---
+    std::vector<double> training_inputs = {0, 0,
+                                           0, 1,
+                                           1, 0,
+                                           1, 1};
+    std::vector<double> targets = {0, 1, 1, 0};
+
+    // --- 4. Training Loop ---
+    // The whole dataset is one batch, so every epoch is one forward and one backward pass.
+    int epochs = 2000;
+    std::mt19937 gen(42);
+    for (int i = 1; i <= epochs; ++i) {
+        double loss = mlp.train_epoch(training_inputs.data(), targets.data(), targets.size(), targets.size(), gen);
+        if (i % 500 == 0) {
+            std::cout << "Epoch " << i << ": loss " << loss << std::endl;
+        }
+    }
+
+    // --- 5. Testing ---
+    std::cout << "\n--- Testing the Trained MLP ---" << std::endl;
+    std::cout << "Input: [0, 0] -> Prediction: " << mlp.predict({0, 0}) << " (Expected: 0)" << std::endl;
+    std::cout << "Input: [0, 1] -> Prediction: " << mlp.predict({0, 1}) << " (Expected: 1)" << std::endl;
+    std::cout << "Input: [1, 0] -> Prediction: " << mlp.predict({1, 0}) << " (Expected: 1)" << std::endl;
+    std::cout << "Input: [1, 1] -> Prediction: " << mlp.predict({1, 1}) << " (Expected: 0)" << std::endl;
+
+    // --- 6. Int8 Quantization ---
+    std::cout << "\n--- Int8 Quantization (held-out accuracy) ---" << std::endl;
+    run_quantization_report();
+
+    // --- 7. Serving from a Model File ---
+    std::cout << "\n--- Model File Startup ---" << std::endl;
+    run_model_file_report();
+    return 0;
+}
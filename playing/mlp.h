@@ -0,0 +1,259 @@
+#pragma once
+
+#include <algorithm> // For std::shuffle, std::min and std::copy
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <numeric>   // For std::iota
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "gemm.h"
+
+/**
+ * @class MLP
+ * @brief A multi-layer perceptron: stacked dense layers trained with backpropagation.
+ *
+ * Where a Perceptron is one neuron with a hard step, an MLP is layers of neurons with
+ * smooth activations, which lets it learn problems that are not linearly separable (the
+ * classic example being XOR, which a single Perceptron cannot). Each layer stores its
+ * weights like a row of Perceptrons: one row of weights per neuron, plus a bias.
+ *
+ * Hidden layers use ReLU or sigmoid; the output layer always uses sigmoid, so each output
+ * is a probability in (0, 1) and training minimizes binary cross-entropy. All work on a
+ * batch is done as whole-matrix products through Gemm: the forward pass is X * W^T, the
+ * backward pass dW = delta^T * X and delta_prev = delta * W. The matrices live in member
+ * buffers that are reused from batch to batch, so training does not allocate once the
+ * buffers have grown to the batch size.
+ */
+class MLP {
+public:
+    enum class Activation { ReLU, Sigmoid };
+
+private:
+    // One dense layer and the per-batch state backpropagation needs
+    struct Layer {
+        size_t inputs;
+        size_t outputs;
+        Activation activation;
+        std::vector<double> weights;      // outputs x inputs, row-major: row j holds neuron j's weights.
+        std::vector<double> bias;         // One bias per neuron.
+        std::vector<double> output;       // rows x outputs activations from the last forward pass.
+        std::vector<double> delta;        // rows x outputs gradient of the loss w.r.t. the pre-activations.
+        std::vector<double> weight_grad;  // outputs x inputs gradient of the loss w.r.t. the weights.
+    };
+
+    std::vector<Layer> layers;
+    double learning_rate; // Step size of the gradient descent updates.
+
+    // Scratch space for train_epoch, kept between calls so an epoch does not allocate.
+    std::vector<size_t> sample_order;   // Row indices of the dataset in their shuffled order.
+    std::vector<double> batch_inputs;   // The current mini-batch gathered into contiguous rows.
+    std::vector<double> batch_targets;
+
+    static double sigmoid(double x) {
+        return 1.0 / (1.0 + std::exp(-x));
+    }
+
+    /**
+     * @brief Runs a batch through every layer, leaving each layer's activations in its output.
+     * @param features Row-major matrix of rows rows with num_inputs() values each.
+     * @param rows Number of samples in the batch.
+     * @return The output layer's activations, rows x num_outputs().
+     */
+    const double* forward(const double* features, size_t rows) {
+        const double* in = features;
+        for (Layer& layer : layers) {
+            layer.output.resize(rows * layer.outputs);
+            // Z = X * W^T: every sample against every neuron's weights in one product
+            Gemm::multiply(false, true, rows, layer.outputs, layer.inputs, in, layer.inputs, layer.weights.data(),
+                           layer.inputs, layer.output.data(), layer.outputs);
+            for (size_t r = 0; r < rows; ++r) {
+                double* z = layer.output.data() + r * layer.outputs;
+                for (size_t j = 0; j < layer.outputs; ++j) {
+                    const double x = z[j] + layer.bias[j];
+                    z[j] = (layer.activation == Activation::ReLU) ? std::max(x, 0.0) : sigmoid(x);
+                }
+            }
+            in = layer.output.data();
+        }
+        return in;
+    }
+
+public:
+    /**
+     * @brief Constructor for the MLP class.
+     * @param layer_sizes Neurons per layer, starting with the number of inputs and ending
+     *                    with the number of outputs, e.g. {2, 8, 1}.
+     * @param hidden Activation of the hidden layers. Defaults to ReLU.
+     * @param lr The learning rate for training. Defaults to 0.1.
+     * @param seed Seed for the weight initialization; random unless given.
+     *
+     * Weights start uniformly random with the scale each activation trains best from (He
+     * initialization for ReLU, Xavier for sigmoid); biases start at zero.
+     */
+    MLP(const std::vector<size_t>& layer_sizes, Activation hidden = Activation::ReLU, double lr = 0.1,
+        unsigned seed = std::random_device{}())
+        : learning_rate(lr) {
+        if (layer_sizes.size() < 2) {
+            throw std::invalid_argument("An MLP needs at least an input and an output layer");
+        }
+        std::mt19937 gen(seed);
+        for (size_t l = 1; l < layer_sizes.size(); ++l) {
+            Layer layer;
+            layer.inputs = layer_sizes[l - 1];
+            layer.outputs = layer_sizes[l];
+            layer.activation = (l + 1 == layer_sizes.size()) ? Activation::Sigmoid : hidden;
+            const double fan = (layer.activation == Activation::ReLU)
+                                   ? 2.0 / layer.inputs
+                                   : 2.0 / (layer.inputs + layer.outputs);
+            const double limit = std::sqrt(3.0 * fan);
+            std::uniform_real_distribution<> dis(-limit, limit);
+            layer.weights.resize(layer.outputs * layer.inputs);
+            for (double& w : layer.weights) {
+                w = dis(gen);
+            }
+            layer.bias.assign(layer.outputs, 0.0);
+            layer.weight_grad.resize(layer.weights.size());
+            layers.push_back(std::move(layer));
+        }
+    }
+
+    size_t num_inputs() const { return layers.front().inputs; }
+    size_t num_outputs() const { return layers.back().outputs; }
+
+    // Read-only access to layer l (0 is the first hidden layer), e.g. for quantizing the
+    // model. layer_output holds the activations from the most recent forward pass.
+    size_t num_layers() const { return layers.size(); }
+    Activation layer_activation(size_t l) const { return layers[l].activation; }
+    const std::vector<double>& layer_weights(size_t l) const { return layers[l].weights; }
+    const std::vector<double>& layer_bias(size_t l) const { return layers[l].bias; }
+    const std::vector<double>& layer_output(size_t l) const { return layers[l].output; }
+
+    /**
+     * @brief Computes the output probabilities for a batch of samples.
+     * @param features Row-major matrix of rows rows with num_inputs() values each.
+     * @param rows Number of samples in the batch.
+     * @param out Receives rows x num_outputs() probabilities, row-major.
+     */
+    void predict_batch(const double* features, size_t rows, double* out) {
+        const double* result = forward(features, rows);
+        std::copy(result, result + rows * num_outputs(), out);
+    }
+
+    /**
+     * @brief Predicts the class of one sample, like Perceptron::predict.
+     * @param inputs A vector of num_inputs() input values.
+     * @return 1 if the first output's probability is at least 0.5, otherwise 0.
+     */
+    int predict(const std::vector<double>& inputs) {
+        if (inputs.size() != num_inputs()) {
+            throw std::invalid_argument("Number of inputs must match the input layer");
+        }
+        return forward(inputs.data(), 1)[0] >= 0.5 ? 1 : 0;
+    }
+
+    /**
+     * @brief One gradient descent step on a mini-batch.
+     * @param features Row-major matrix of rows rows with num_inputs() values each.
+     * @param targets Row-major matrix of rows rows with num_outputs() values in [0, 1].
+     * @param rows Number of samples in the batch.
+     * @return The mean binary cross-entropy of the batch before the update.
+     */
+    double train_batch(const double* features, const double* targets, size_t rows) {
+        const double* prediction = forward(features, rows);
+
+        // With a sigmoid output and cross-entropy loss, dLoss/dZ is simply prediction - target
+        Layer& last = layers.back();
+        last.delta.resize(rows * last.outputs);
+        double loss = 0.0;
+        for (size_t i = 0; i < rows * last.outputs; ++i) {
+            const double p = std::min(std::max(prediction[i], 1e-12), 1.0 - 1e-12);
+            loss -= targets[i] * std::log(p) + (1.0 - targets[i]) * std::log(1.0 - p);
+            last.delta[i] = (prediction[i] - targets[i]) / rows;
+        }
+
+        for (size_t l = layers.size(); l-- > 0;) {
+            Layer& layer = layers[l];
+            const double* in = (l == 0) ? features : layers[l - 1].output.data();
+
+            // dW = delta^T * X, and the bias gradient is the column sums of delta
+            Gemm::multiply(true, false, layer.outputs, layer.inputs, rows, layer.delta.data(), layer.outputs, in,
+                           layer.inputs, layer.weight_grad.data(), layer.inputs);
+
+            // Propagate before updating: delta_prev = (delta * W) scaled by the previous activation's slope
+            if (l > 0) {
+                Layer& previous = layers[l - 1];
+                previous.delta.resize(rows * previous.outputs);
+                Gemm::multiply(false, false, rows, layer.inputs, layer.outputs, layer.delta.data(), layer.outputs,
+                               layer.weights.data(), layer.inputs, previous.delta.data(), previous.outputs);
+                for (size_t i = 0; i < rows * previous.outputs; ++i) {
+                    const double a = previous.output[i];
+                    previous.delta[i] *= (previous.activation == Activation::ReLU) ? (a > 0.0 ? 1.0 : 0.0)
+                                                                                   : a * (1.0 - a);
+                }
+            }
+
+            for (size_t i = 0; i < layer.weights.size(); ++i) {
+                layer.weights[i] -= learning_rate * layer.weight_grad[i];
+            }
+            for (size_t r = 0; r < rows; ++r) {
+                const double* d = layer.delta.data() + r * layer.outputs;
+                for (size_t j = 0; j < layer.outputs; ++j) {
+                    layer.bias[j] -= learning_rate * d[j];
+                }
+            }
+        }
+        return loss / rows;
+    }
+
+    /**
+     * @brief Runs one epoch of mini-batch training over a contiguous dataset.
+     * @param features Row-major matrix of num_rows rows with num_inputs() values each.
+     * @param targets Row-major matrix of num_rows rows with num_outputs() values each.
+     * @param num_rows Number of rows in the dataset.
+     * @param batch_size Number of rows per gradient step.
+     * @param gen Random generator used to shuffle the row order for this epoch.
+     * @return The mean loss over the epoch's batches.
+     *
+     * Each shuffled batch is gathered into a contiguous buffer so it can go through the
+     * matrix products as one block.
+     */
+    template <typename Generator>
+    double train_epoch(const double* features, const double* targets, size_t num_rows, size_t batch_size,
+                       Generator& gen) {
+        sample_order.resize(num_rows);
+        std::iota(sample_order.begin(), sample_order.end(), size_t{0});
+        std::shuffle(sample_order.begin(), sample_order.end(), gen);
+
+        const size_t n_in = num_inputs();
+        const size_t n_out = num_outputs();
+        batch_size = std::max<size_t>(batch_size, 1);
+        double loss = 0.0;
+        size_t batches = 0;
+        for (size_t start = 0; start < num_rows; start += batch_size) {
+            const size_t rows = std::min(batch_size, num_rows - start);
+            batch_inputs.resize(rows * n_in);
+            batch_targets.resize(rows * n_out);
+            for (size_t k = 0; k < rows; ++k) {
+                const size_t r = sample_order[start + k];
+                std::copy(features + r * n_in, features + (r + 1) * n_in, batch_inputs.data() + k * n_in);
+                std::copy(targets + r * n_out, targets + (r + 1) * n_out, batch_targets.data() + k * n_out);
+            }
+            loss += train_batch(batch_inputs.data(), batch_targets.data(), rows);
+            ++batches;
+        }
+        return batches ? loss / batches : 0.0;
+    }
+
+    // A helper function to print the shape of the network
+    void print_layers() const {
+        std::cout << "Layers: " << num_inputs();
+        for (const Layer& layer : layers) {
+            std::cout << " -> " << layer.outputs
+                      << (layer.activation == Activation::ReLU ? " (ReLU)" : " (sigmoid)");
+        }
+        std::cout << std::endl;
+    }
+};
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gemm.h"
+#include "mapped_file.h"
+#include "mlp.h"
+#include "perceptron.h"
+
+/**
+ * @class MappedModel
+ * @brief A trained Perceptron or MLP served straight out of a memory-mapped model file.
+ *
+ * Layout, all little-endian:
+ *
+ *     0   64-byte header: magic "PMF1", u32 format version, u32 kind (0 = Perceptron,
+ *         1 = MLP), u32 layer count, u64 file size, zero padding
+ *     64  one 32-byte entry per layer: u32 inputs, u32 outputs, u32 activation
+ *         (0 = step, 1 = ReLU, 2 = sigmoid), u32 zero, u64 offset of the weights,
+ *         u64 offset of the biases
+ *     ... the arrays, each a 64-byte aligned run of doubles: outputs x inputs weights in
+ *         row-major order (row j holds neuron j's weights), then outputs biases
+ *
+ * A Perceptron is stored as one layer with a single step output. Opening a file maps it and
+ * checks the header and the layer table, which is a handful of reads whatever the size of
+ * the model; the weight pointers then point into the mapping, so nothing is parsed or
+ * copied and pages are read from disk (or shared from the page cache) as predictions touch
+ * them. The mapping is read-only and predict_batch keeps its scratch space per thread, so
+ * one MappedModel can serve several threads at once.
+ *
+ * Readers reject files with a newer version than FORMAT_VERSION. A format change that older
+ * readers could misread bumps the version.
+ */
+class MappedModel {
+public:
+    static constexpr char MAGIC[4] = {'P', 'M', 'F', '1'};
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 64;
+    static constexpr size_t LAYER_ENTRY_SIZE = 32;
+    static constexpr size_t ALIGNMENT = 64;
+
+    enum class Kind : uint32_t { Perceptron = 0, MLP = 1 };
+    enum class Activation : uint32_t { Step = 0, ReLU = 1, Sigmoid = 2 };
+
+    // One layer's shape and parameters, pointing into the mapping
+    struct Layer {
+        size_t inputs;
+        size_t outputs;
+        Activation activation;
+        const double* weights; // outputs x inputs, row-major.
+        const double* bias;    // One bias per neuron.
+    };
+
+    /**
+     * @brief Maps the model file at path.
+     *
+     * Throws std::runtime_error if the file cannot be opened or mapped, and
+     * std::invalid_argument if it is not a model file, has a newer version, or its layer
+     * table does not describe a consistent network that fits in the file.
+     */
+    explicit MappedModel(const std::string& path) : mapping(path) {
+        static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Model files are little-endian");
+        if (mapping.size() < HEADER_SIZE) {
+            throw std::invalid_argument(path + " is not a model file");
+        }
+        parse_tables(path);
+    }
+
+    MappedModel(const MappedModel&) = delete;
+    MappedModel& operator=(const MappedModel&) = delete;
+
+    Kind kind() const { return model_kind; }
+    size_t num_layers() const { return layers.size(); }
+    const Layer& layer(size_t l) const { return layers[l]; }
+    size_t num_inputs() const { return layers.front().inputs; }
+    size_t num_outputs() const { return layers.back().outputs; }
+
+    /**
+     * @brief Runs a batch through the model.
+     * @param features Row-major matrix of rows rows with num_inputs() values each.
+     * @param rows Number of samples in the batch.
+     * @param out Receives rows x num_outputs() output activations: the 0 or 1 of a
+     *            Perceptron, or an MLP's output probabilities.
+     */
+    void predict_batch(const double* features, size_t rows, double* out) const {
+        if (model_kind == Kind::Perceptron) {
+            thread_local std::vector<int> classes;
+            classes.resize(rows);
+            predict_batch(features, rows, classes.data());
+            std::copy(classes.begin(), classes.end(), out);
+            return;
+        }
+        const double* result = forward(features, rows);
+        std::copy(result, result + rows * num_outputs(), out);
+    }
+
+    /**
+     * @brief Classifies a batch: the Perceptron's prediction, or 1 where an MLP's first
+     *        output is at least 0.5, as in Perceptron::predict_batch and MLP::predict.
+     * @param out Receives one 0 or 1 per row.
+     */
+    void predict_batch(const double* features, size_t rows, int* out) const {
+        const Layer& last = layers.back();
+        if (model_kind == Kind::Perceptron) {
+            Perceptron::predict_rows(features, rows, last.inputs, last.weights, last.bias[0], out);
+            return;
+        }
+        const double* result = forward(features, rows);
+        for (size_t r = 0; r < rows; ++r) {
+            out[r] = result[r * last.outputs] >= 0.5 ? 1 : 0;
+        }
+    }
+
+    // Writes p as a model file, replacing any existing file. Throws std::runtime_error if
+    // the file cannot be written.
+    static void write(const std::string& path, const Perceptron& p) {
+        const std::vector<double> bias = {p.get_bias()};
+        write(path, Kind::Perceptron, {LayerSource{p.num_inputs(), 1, Activation::Step, p.get_weights().data(),
+                                                   bias.data()}});
+    }
+
+    // Writes mlp as a model file, replacing any existing file. Throws std::runtime_error if
+    // the file cannot be written.
+    static void write(const std::string& path, const MLP& mlp) {
+        std::vector<LayerSource> sources;
+        size_t inputs = mlp.num_inputs();
+        for (size_t l = 0; l < mlp.num_layers(); ++l) {
+            const size_t outputs = mlp.layer_bias(l).size();
+            sources.push_back({inputs, outputs,
+                               mlp.layer_activation(l) == MLP::Activation::ReLU ? Activation::ReLU
+                                                                                : Activation::Sigmoid,
+                               mlp.layer_weights(l).data(), mlp.layer_bias(l).data()});
+            inputs = outputs;
+        }
+        write(path, Kind::MLP, sources);
+    }
+
+private:
+    struct LayerSource {
+        size_t inputs;
+        size_t outputs;
+        Activation activation;
+        const double* weights;
+        const double* bias;
+    };
+
+    static uint64_t align_up(uint64_t offset) {
+        return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    static void write(const std::string& path, Kind kind, const std::vector<LayerSource>& sources) {
+        // Lay the arrays out first so the header can carry the final size
+        std::vector<char> tables(HEADER_SIZE + sources.size() * LAYER_ENTRY_SIZE, 0);
+        uint64_t offset = align_up(tables.size());
+        for (size_t l = 0; l < sources.size(); ++l) {
+            const uint32_t shape[4] = {static_cast<uint32_t>(sources[l].inputs),
+                                       static_cast<uint32_t>(sources[l].outputs),
+                                       static_cast<uint32_t>(sources[l].activation), 0};
+            const uint64_t weights_offset = offset;
+            const uint64_t bias_offset = align_up(weights_offset + sources[l].inputs * sources[l].outputs * sizeof(double));
+            offset = align_up(bias_offset + sources[l].outputs * sizeof(double));
+            char* entry = tables.data() + HEADER_SIZE + l * LAYER_ENTRY_SIZE;
+            std::memcpy(entry, shape, sizeof(shape));
+            std::memcpy(entry + 16, &weights_offset, sizeof(weights_offset));
+            std::memcpy(entry + 24, &bias_offset, sizeof(bias_offset));
+        }
+        const uint32_t fields[3] = {FORMAT_VERSION, static_cast<uint32_t>(kind),
+                                    static_cast<uint32_t>(sources.size())};
+        std::memcpy(tables.data(), MAGIC, sizeof(MAGIC));
+        std::memcpy(tables.data() + 4, fields, sizeof(fields));
+        std::memcpy(tables.data() + 16, &offset, sizeof(offset));
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Cannot create " + path + ": " + std::strerror(errno));
+        }
+        file.write(tables.data(), static_cast<std::streamsize>(tables.size()));
+        const char padding[ALIGNMENT] = {};
+        uint64_t written = tables.size();
+        auto write_array = [&](const double* values, size_t count) {
+            const uint64_t start = align_up(written);
+            file.write(padding, static_cast<std::streamsize>(start - written));
+            file.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(count * sizeof(double)));
+            written = start + count * sizeof(double);
+        };
+        for (const LayerSource& source : sources) {
+            write_array(source.weights, source.inputs * source.outputs);
+            write_array(source.bias, source.outputs);
+        }
+        file.write(padding, static_cast<std::streamsize>(offset - written));
+        file.close();
+        if (!file) {
+            throw std::runtime_error("Cannot write " + path + ": " + std::strerror(errno));
+        }
+    }
+
+    // Reads the header and layer table, checking everything the predict paths rely on
+    void parse_tables(const std::string& path) {
+        const std::string invalid = path + " is not a model file";
+        const char* data = mapping.data();
+        const size_t length = mapping.size();
+        uint32_t fields[3];
+        uint64_t file_size;
+        std::memcpy(fields, data + 4, sizeof(fields));
+        std::memcpy(&file_size, data + 16, sizeof(file_size));
+        if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || file_size != length) {
+            throw std::invalid_argument(invalid);
+        }
+        if (fields[0] > FORMAT_VERSION) {
+            throw std::invalid_argument(path + " has model format version " + std::to_string(fields[0]) +
+                                        "; this reader supports up to " + std::to_string(FORMAT_VERSION));
+        }
+        if (fields[1] > static_cast<uint32_t>(Kind::MLP) || fields[2] == 0 ||
+            fields[2] > (length - HEADER_SIZE) / LAYER_ENTRY_SIZE) {
+            throw std::invalid_argument(invalid);
+        }
+        model_kind = static_cast<Kind>(fields[1]);
+
+        // An array must be aligned, lie inside the file and not overflow on the way there
+        auto array = [&](uint64_t offset, uint64_t count) -> const double* {
+            if (offset % ALIGNMENT != 0 || offset > length || count > (length - offset) / sizeof(double)) {
+                throw std::invalid_argument(invalid);
+            }
+            return reinterpret_cast<const double*>(data + offset);
+        };
+        for (uint32_t l = 0; l < fields[2]; ++l) {
+            const char* entry = data + HEADER_SIZE + l * LAYER_ENTRY_SIZE;
+            uint32_t shape[3];
+            uint64_t offsets[2];
+            std::memcpy(shape, entry, sizeof(shape));
+            std::memcpy(offsets, entry + 16, sizeof(offsets));
+            if (shape[0] == 0 || shape[1] == 0 || shape[2] > static_cast<uint32_t>(Activation::Sigmoid) ||
+                (!layers.empty() && layers.back().outputs != shape[0])) {
+                throw std::invalid_argument(invalid);
+            }
+            const Activation activation = static_cast<Activation>(shape[2]);
+            const bool last = l + 1 == fields[2];
+            // A Perceptron is exactly one step neuron; an MLP never uses the step
+            if (model_kind == Kind::Perceptron ? (fields[2] != 1 || shape[1] != 1 || activation != Activation::Step)
+                                               : (activation == Activation::Step ||
+                                                  (last && activation != Activation::Sigmoid))) {
+                throw std::invalid_argument(invalid);
+            }
+            layers.push_back({shape[0], shape[1], activation, array(offsets[0], uint64_t{shape[0]} * shape[1]),
+                              array(offsets[1], shape[1])});
+        }
+    }
+
+    // The MLP forward pass over the mapped weights, with the activations in per-thread
+    // buffers that are reused from call to call
+    const double* forward(const double* features, size_t rows) const {
+        thread_local std::vector<double> buffers[2];
+        const double* in = features;
+        for (size_t l = 0; l < layers.size(); ++l) {
+            const Layer& layer = layers[l];
+            std::vector<double>& output = buffers[l % 2];
+            output.resize(rows * layer.outputs);
+            Gemm::multiply(false, true, rows, layer.outputs, layer.inputs, in, layer.inputs, layer.weights,
+                           layer.inputs, output.data(), layer.outputs);
+            for (size_t r = 0; r < rows; ++r) {
+                double* z = output.data() + r * layer.outputs;
+                for (size_t j = 0; j < layer.outputs; ++j) {
+                    const double x = z[j] + layer.bias[j];
+                    z[j] = (layer.activation == Activation::ReLU) ? std::max(x, 0.0) : 1.0 / (1.0 + std::exp(-x));
+                }
+            }
+            in = output.data();
+        }
+        return in;
+    }
+
+    MappedFile mapping;
+    Kind model_kind = Kind::Perceptron;
+    std::vector<Layer> layers;
+};
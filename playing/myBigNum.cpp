@@ -2,288 +2,802 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <sstream>
+#include <thread>
 
-/**
- * BigNum class - A class for handling very large numbers
- * Supports operations like addition and multiplication for numbers with hundreds of digits
- */
-class BigNum {
-private:
-    std::vector<int> digits; // Stores digits in reverse order for easier operations
-    bool isNegative;        // Flag to indicate if the number is negative
-    
-    // Helper method to remove leading zeros
-    void removeLeadingZeros() {
-        while (digits.size() > 1 && digits.back() == 0) {
-            digits.pop_back();
-        }
-        // If only a single zero remains, make sure it's not marked as negative
-        if (digits.size() == 1 && digits[0] == 0) {
-            isNegative = false;
-        }
+#include "bignum.h"
+#if BIGNUM_LITTLE_ENDIAN
+#include "bignum_archive.h" // Reads records in place, so only on hosts with the format's byte order
+#endif
+
+// ---------------------------------------------------------------------------
+// Benchmark (run with --bench)
+//
+// Times the limb-based BigNum against the previous one-decimal-digit-per-int
+// kernels, kept below verbatim as a reference, on 10k-1M digit operands.
+// ---------------------------------------------------------------------------
+
+// Previous representation: one decimal digit per int, least significant first
+std::vector<int> legacyFromString(const std::string& numStr) {
+    std::vector<int> digits;
+    for (size_t i = numStr.size(); i-- > 0;) {
+        digits.push_back(numStr[i] - '0');
     }
+    return digits;
+}
 
-public:
-    // Default constructor - initializes to 0
-    BigNum() : isNegative(false) {
-        digits.push_back(0);
+std::string legacyToString(const std::vector<int>& digits) {
+    std::string result;
+    for (size_t i = digits.size(); i-- > 0;) {
+        result += std::to_string(digits[i]);
     }
+    return result;
+}
 
-    // Constructor from long long
-    BigNum(long long num) {
-        isNegative = (num < 0);
-        if (num < 0) {
-            num = -num; // Make positive for digit extraction
+std::vector<int> legacyAdd(const std::vector<int>& a, const std::vector<int>& b) {
+    std::vector<int> result;
+    int carry = 0;
+    size_t maxSize = std::max(a.size(), b.size());
+    for (size_t i = 0; i < maxSize || carry; ++i) {
+        int sum = carry;
+        if (i < a.size()) {
+            sum += a[i];
         }
-        
-        if (num == 0) {
-            digits.push_back(0);
-        } else {
-            while (num > 0) {
-                digits.push_back(num % 10);
-                num /= 10;
-            }
+        if (i < b.size()) {
+            sum += b[i];
         }
+        carry = sum / 10;
+        result.push_back(sum % 10);
     }
+    return result;
+}
 
-    // Constructor from string
-    BigNum(const std::string& numStr) {
-        if (numStr.empty()) {
-            isNegative = false;
-            digits.push_back(0);
-            return;
+std::vector<int> legacySubtract(const std::vector<int>& a, const std::vector<int>& b) {
+    std::vector<int> result;
+    int borrow = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        int diff = a[i] - borrow;
+        if (i < b.size()) {
+            diff -= b[i];
         }
-        
-        size_t start = 0;
-        isNegative = (numStr[0] == '-');
-        if (isNegative || numStr[0] == '+') {
-            start = 1;
-        }
-        
-        // Initialize with 0 if the string is just a sign
-        if (start >= numStr.size()) {
-            digits.push_back(0);
-            isNegative = false;
-            return;
-        }
-        
-        // Parse digits in reverse order
-        for (int i = numStr.size() - 1; i >= static_cast<int>(start); --i) {
-            if (!std::isdigit(numStr[i])) {
-                throw std::invalid_argument("Invalid character in number string");
-            }
-            digits.push_back(numStr[i] - '0');
+        if (diff < 0) {
+            diff += 10;
+            borrow = 1;
+        } else {
+            borrow = 0;
         }
-        
-        removeLeadingZeros();
+        result.push_back(diff);
     }
+    return result;
+}
 
-    // Addition operator
-    BigNum operator+(const BigNum& other) const {
-        // If signs are different, delegate to subtraction
-        if (isNegative != other.isNegative) {
-            if (isNegative) {
-                // (-a) + b = b - a
-                BigNum temp = *this;
-                temp.isNegative = false;
-                return other - temp;
-            } else {
-                // a + (-b) = a - b
-                BigNum temp = other;
-                temp.isNegative = false;
-                return *this - temp;
+std::vector<int> legacyMultiply(const std::vector<int>& a, const std::vector<int>& b) {
+    std::vector<int> result(a.size() + b.size(), 0);
+    for (size_t i = 0; i < a.size(); ++i) {
+        int carry = 0;
+        for (size_t j = 0; j < b.size() || carry; ++j) {
+            long long product = result[i + j] + carry;
+            if (j < b.size()) {
+                product += (long long)a[i] * b[j];
             }
+            result[i + j] = product % 10;
+            carry = product / 10;
         }
+    }
+    return result;
+}
+
+std::string randomDigits(size_t count, std::mt19937_64& gen) {
+    std::uniform_int_distribution<int> digit(0, 9);
+    std::string s(count, '0');
+    for (char& c : s) {
+        c = static_cast<char>('0' + digit(gen));
+    }
+    s[0] = static_cast<char>('1' + digit(gen) % 9); // No leading zero
+    return s;
+}
+
+// Returns the best-of-N wall time of fn in milliseconds
+template <typename Fn>
+double timeMs(Fn&& fn, int repetitions) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+// Counts heap allocations so the benchmark can show which operator forms allocate per call
+static std::atomic<size_t> allocationCount{0}; // Atomic: the multiplication pool allocates too
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// Kept out of line: once inlined, GCC pairs the free() with the new-expression and warns
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+// Runs fn repetitions times after one warm-up call and returns the allocations per call
+template <typename Fn>
+double allocationsPerCall(Fn&& fn, int repetitions) {
+    fn();
+    size_t before = allocationCount;
+    for (int r = 0; r < repetitions; ++r) {
+        fn();
+    }
+    return static_cast<double>(allocationCount - before) / repetitions;
+}
+
+void benchmarkRow(const char* op, size_t digits, double legacyMs, double limbMs) {
+    std::cout << "  " << op << "  " << digits << " digits: legacy " << legacyMs << " ms, limbs "
+              << limbMs << " ms, speedup " << (legacyMs / limbMs) << "x" << std::endl;
+}
+
+void runBenchmarks() {
+    std::mt19937_64 gen(12345);
+    volatile size_t sink = 0; // Keeps results observable so the work is not optimized away
+    
+    std::cout << "BigNum benchmark (best of 3, base 10^9 limbs vs. one digit per int)" << std::endl;
+    for (size_t digits : {10000, 100000, 1000000}) {
+        std::string sa = randomDigits(digits, gen);
+        std::string sb = randomDigits(digits - 1, gen);
+        BigNum a(sa), b(sb);
+        std::vector<int> la = legacyFromString(sa), lb = legacyFromString(sb);
         
-        BigNum result;
-        result.digits.clear();
-        result.isNegative = isNegative; // Result has the same sign as both operands
+        double legacyAddMs = timeMs([&] { sink = sink + legacyAdd(la, lb).size(); }, 3);
+        double limbAddMs = timeMs([&] { sink = sink + (a + b).compareAbsoluteValue(a); }, 3);
+        benchmarkRow("add", digits, legacyAddMs, limbAddMs);
         
-        int carry = 0;
-        size_t maxSize = std::max(digits.size(), other.digits.size());
+        double legacySubMs = timeMs([&] { sink = sink + legacySubtract(la, lb).size(); }, 3);
+        double limbSubMs = timeMs([&] { sink = sink + (a - b).compareAbsoluteValue(a); }, 3);
+        benchmarkRow("sub", digits, legacySubMs, limbSubMs);
+    }
+    
+    // Schoolbook multiplication is quadratic; keep the legacy side to sizes that finish in seconds
+    for (size_t digits : {10000, 30000}) {
+        std::string sa = randomDigits(digits, gen);
+        std::string sb = randomDigits(digits, gen);
+        BigNum a(sa), b(sb);
+        std::vector<int> la = legacyFromString(sa), lb = legacyFromString(sb);
         
-        for (size_t i = 0; i < maxSize || carry; ++i) {
-            int sum = carry;
-            if (i < digits.size()) {
-                sum += digits[i];
-            }
-            if (i < other.digits.size()) {
-                sum += other.digits[i];
-            }
-            
-            carry = sum / 10;
-            result.digits.push_back(sum % 10);
+        double legacyMulMs = timeMs([&] { sink = sink + legacyMultiply(la, lb).size(); }, 1);
+        double limbMulMs = timeMs([&] { sink = sink + (a * b).compareAbsoluteValue(a); }, 3);
+        benchmarkRow("mul", digits, legacyMulMs, limbMulMs);
+    }
+    
+    // Decimal conversion: the previous per-digit to_string print against toString, toChars
+    // into a reused buffer and operator<<; parsing against the previous per-digit push_back
+    std::cout << "\nDecimal conversion" << std::endl;
+    for (size_t digits : {100000, 1000000, 10000000}) {
+        std::string text = randomDigits(digits, gen);
+        BigNum x(text);
+        std::vector<int> legacy = legacyFromString(text);
+        std::vector<char> buffer(x.decimalLength());
+        std::ostringstream stream;
+        double legacyPrintMs = timeMs([&] { sink = sink + legacyToString(legacy).size(); }, 3);
+        double toStringMs = timeMs([&] { sink = sink + x.toString().size(); }, 3);
+        double toCharsMs = timeMs([&] { sink = sink + x.toChars(buffer.data(), buffer.size()); }, 3);
+        double streamMs = timeMs([&] { stream.str(std::string()); stream << x; sink = sink + stream.tellp(); }, 3);
+        std::cout << "  print " << digits << " digits: legacy " << legacyPrintMs << " ms, toString " << toStringMs
+                  << " ms, toChars " << toCharsMs << " ms, operator<< " << streamMs << " ms" << std::endl;
+        double legacyParseMs = timeMs([&] { sink = sink + legacyFromString(text).size(); }, 3);
+        double parseMs = timeMs([&] { sink = sink + BigNum(text).compareAbsoluteValue(x); }, 3);
+        std::cout << "  parse " << digits << " digits: legacy " << legacyParseMs << " ms, limbs " << parseMs << " ms"
+                  << std::endl;
+    }
+    
+    // Assigned expressions and compound assignment evaluate into acc's buffer, and 256-bit
+    // values never leave the inline limbs
+    std::cout << "\nAllocations per call and time for 100k calls (256-bit and 10k-digit operands)" << std::endl;
+    for (size_t digits : {77, 10000}) {
+        BigNum x(randomDigits(digits, gen)), y(randomDigits(digits, gen));
+        BigNum acc = x;
+        auto row = [&](const char* form, auto&& fn) {
+            double allocations = allocationsPerCall(fn, 1000);
+            double ms = timeMs([&] { for (int i = 0; i < 100000; ++i) fn(); }, 1);
+            std::cout << "  " << form << "  " << digits << " digits: " << allocations << " allocations, "
+                      << ms << " ms" << std::endl;
+        };
+        row("acc = acc + x", [&] { acc = acc + x; acc = acc - x; });
+        row("acc += x", [&] { acc += x; acc -= x; });
+        row("acc = std::move(acc) + x", [&] { acc = std::move(acc) + x; acc = std::move(acc) - x; });
+        row("BigNum(x + y) - y into a new BigNum", [&] {
+            BigNum fresh = BigNum(x + y) - y;
+            sink = sink + fresh.compareAbsoluteValue(x);
+        });
+        if (digits <= 100) {
+            // Half-width factors so the product still fits the inline limbs
+            BigNum hx(randomDigits(digits / 2, gen)), hy(randomDigits(digits / 2, gen));
+            row("acc = hx * hy", [&] { acc = hx * hy; });
+            row("acc = hx; acc *= hy", [&] { acc = hx; acc *= hy; });
         }
-        
-        result.removeLeadingZeros();
-        return result;
+        sink = sink + acc.compareAbsoluteValue(x);
     }
     
-    // Subtraction helper - assumes |a| >= |b|
-    static BigNum absoluteSubtract(const BigNum& a, const BigNum& b) {
-        BigNum result;
-        result.digits.clear();
-        
-        int borrow = 0;
-        for (size_t i = 0; i < a.digits.size(); ++i) {
-            int diff = a.digits[i] - borrow;
-            if (i < b.digits.size()) {
-                diff -= b.digits[i];
-            }
-            
-            if (diff < 0) {
-                diff += 10;
-                borrow = 1;
-            } else {
-                borrow = 0;
+    // The add/subtract kernels at every SIMD level the CPU supports, on long operands and on a
+    // vector-sum workload of a million 80-digit values
+    std::cout << "\nAdd/subtract kernels (0 = scalar, 1 = SSE2, 2 = AVX2)" << std::endl;
+    const int savedLevel = BigNum::simdLevel;
+    for (size_t digits : {1000, 100000, 1000000}) {
+        BigNum a(randomDigits(digits, gen)), b(randomDigits(digits - 1, gen));
+        BigNum r = a + b;
+        for (int level = 0; level <= savedLevel; ++level) {
+            BigNum::simdLevel = level;
+            double addMs = timeMs([&] { r = a + b; sink = sink + r.compareAbsoluteValue(a); }, 5);
+            double subMs = timeMs([&] { r = a - b; sink = sink + r.compareAbsoluteValue(a); }, 5);
+            std::cout << "  level " << level << "  " << digits << " digits: add " << addMs << " ms, sub " << subMs
+                      << " ms" << std::endl;
+        }
+    }
+    std::vector<BigNum> values;
+    values.reserve(1000000);
+    for (int i = 0; i < 1000000; ++i) {
+        values.emplace_back(randomDigits(80, gen));
+    }
+    for (int level = 0; level <= savedLevel; ++level) {
+        BigNum::simdLevel = level;
+        double ms = timeMs([&] {
+            BigNum total;
+            for (const BigNum& value : values) {
+                total += value;
             }
-            
-            result.digits.push_back(diff);
+            sink = sink + total.compareAbsoluteValue(values[0]);
+        }, 3);
+        std::cout << "  level " << level << "  sum of 1M 80-digit values: " << ms << " ms" << std::endl;
+    }
+    BigNum::simdLevel = savedLevel;
+    
+    // Fused expression evaluation against materializing a BigNum after every operator, which
+    // is what each + and - did before they returned expression templates
+    std::cout << "\nFused expressions (one pass into r vs. a temporary per operator)" << std::endl;
+    for (size_t digits : {77, 10000, 1000000}) {
+        BigNum a(randomDigits(digits, gen)), b(randomDigits(digits, gen));
+        BigNum c(randomDigits(digits, gen)), d(randomDigits(digits, gen));
+        BigNum r = a;
+        auto row = [&](const char* form, int calls, auto&& fn) {
+            double allocations = allocationsPerCall(fn, 10);
+            double ms = timeMs([&] { for (int i = 0; i < calls; ++i) fn(); }, 1);
+            std::cout << "  " << form << "  " << digits << " digits: " << allocations << " allocations, "
+                      << ms << " ms for " << calls << " calls" << std::endl;
+        };
+        const int addCalls = (digits >= 1000000) ? 100 : 100000;
+        row("r = a + b + c - d", addCalls, [&] { r = a + b + c - d; });
+        row("r = BigNum(BigNum(a + b) + c) - d", addCalls, [&] { r = BigNum(BigNum(a + b) + c) - d; });
+        if (digits <= 10000) {
+            const int mulCalls = (digits >= 10000) ? 1000 : 100000;
+            row("r = a * b + c", mulCalls, [&] { r = a * b + c; });
+            row("r = BigNum(a * b) + c", mulCalls, [&] { r = BigNum(a * b) + c; });
         }
-        
-        result.removeLeadingZeros();
-        return result;
+        sink = sink + r.compareAbsoluteValue(a);
     }
-
-    // Subtraction operator
-    BigNum operator-(const BigNum& other) const {
-        // If signs are different, delegate to addition
-        if (isNegative != other.isNegative) {
-            if (isNegative) {
-                // (-a) - b = -(a + b)
-                BigNum temp = *this;
-                temp.isNegative = false;
-                BigNum result = temp + other;
-                result.isNegative = true;
-                return result;
-            } else {
-                // a - (-b) = a + b
-                BigNum temp = other;
-                temp.isNegative = false;
-                return *this + temp;
+    
+    // Tiered multiplication against the schoolbook reference at sizes where the old code took seconds
+    std::cout << "\nMultiplication tiers (Karatsuba from " << BigNum::karatsubaThreshold
+              << " limbs, Toom-3 from " << BigNum::toom3Threshold << " limbs, NTT from "
+              << BigNum::nttThreshold << " limbs)" << std::endl;
+    for (size_t digits : {10000, 100000, 1000000, 10000000}) {
+        BigNum a(randomDigits(digits, gen)), b(randomDigits(digits, gen));
+        int repetitions = (digits >= 10000000) ? 1 : 3;
+        double tieredMs = timeMs([&] { sink = sink + (a * b).compareAbsoluteValue(a); }, repetitions);
+        double squareMs = timeMs([&] { sink = sink + a.square().compareAbsoluteValue(a); }, repetitions);
+        std::cout << "  mul  " << digits << " digits: tiered " << tieredMs << " ms, square " << squareMs << " ms";
+        if (digits <= 100000) {
+            double schoolbookMs = timeMs([&] { sink = sink + BigNum::multiplySchoolbook(a, b).compareAbsoluteValue(a); }, 1);
+            std::cout << ", schoolbook " << schoolbookMs << " ms, speedup " << (schoolbookMs / tieredMs) << "x";
+        }
+        std::cout << std::endl;
+    }
+    
+    // Parallel scaling: the same products on pools of 1 to 8 threads. Speedups beyond the
+    // hardware thread count reported here are not to be expected.
+    std::cout << "\nParallel multiplication scaling (" << std::thread::hardware_concurrency()
+              << " hardware threads, parallel from " << BigNum::parallelThreshold << " limbs)" << std::endl;
+    for (size_t digits : {300000, 1000000, 10000000}) {
+        BigNum a(randomDigits(digits, gen)), b(randomDigits(digits, gen));
+        int repetitions = (digits >= 10000000) ? 1 : 3;
+        double serialMs = 0;
+        std::cout << "  mul  " << digits << " digits:";
+        for (unsigned threads : {1, 2, 4, 8}) {
+            BigNum::setMultiplyThreads(threads);
+            double ms = timeMs([&] { sink = sink + (a * b).compareAbsoluteValue(a); }, repetitions);
+            if (threads == 1) {
+                serialMs = ms;
             }
+            std::cout << "  " << threads << "T " << ms << " ms (" << (serialMs / ms) << "x)";
         }
-        
-        // Compare absolute values to determine the result sign
-        bool resultNegative = false;
-        const BigNum* larger = this;
-        const BigNum* smaller = &other;
-        
-        if (compareAbsoluteValue(other) < 0) {
-            larger = &other;
-            smaller = this;
-            resultNegative = !isNegative; // Flip the sign
-        } else {
-            resultNegative = isNegative;
+        BigNum::setMultiplyThreads(1);
+        std::cout << std::endl;
+    }
+    
+    // Threshold sweeps: the fastest row of each is the setting to use on this machine.
+    // Each sweep switches off the tiers above the one being tuned.
+    const size_t savedKaratsuba = BigNum::karatsubaThreshold;
+    const size_t savedToom3 = BigNum::toom3Threshold;
+    const size_t savedNtt = BigNum::nttThreshold;
+    auto sweep = [&](const char* title, size_t& threshold, std::initializer_list<size_t> candidates) {
+        BigNum x(randomDigits(50000, gen)), y(randomDigits(50000, gen));
+        std::cout << title << " (50k digits)" << std::endl;
+        for (size_t candidate : candidates) {
+            threshold = candidate;
+            std::cout << "  " << (candidate == SIZE_MAX ? std::string("off") : std::to_string(candidate) + " limbs")
+                      << ": " << timeMs([&] { sink = sink + (x * y).compareAbsoluteValue(x); }, 3) << " ms" << std::endl;
         }
-        
-        BigNum result = absoluteSubtract(*larger, *smaller);
-        result.isNegative = resultNegative;
-        result.removeLeadingZeros();
-        return result;
+    };
+    BigNum::nttThreshold = SIZE_MAX;
+    BigNum::toom3Threshold = SIZE_MAX;
+    std::cout << std::endl;
+    sweep("Karatsuba threshold sweep, Toom-3 and NTT off", BigNum::karatsubaThreshold, {16, 24, 32, 48, 64, 96, 128});
+    BigNum::karatsubaThreshold = savedKaratsuba;
+    sweep("Toom-3 threshold sweep, NTT off", BigNum::toom3Threshold, {128, 192, 256, 384, 512, 768, SIZE_MAX});
+    BigNum::toom3Threshold = savedToom3;
+    
+    // The NTT crossover is easier to read off by operand size: use NTT from the first row where it wins
+    std::cout << "NTT crossover (Toom-3 vs. NTT by operand size)" << std::endl;
+    for (size_t limbCount : {256, 512, 1024, 2048, 4096, 8192}) {
+        BigNum x(randomDigits(limbCount * 9, gen)), y(randomDigits(limbCount * 9, gen));
+        BigNum::nttThreshold = SIZE_MAX;
+        double toomMs = timeMs([&] { sink = sink + (x * y).compareAbsoluteValue(x); }, 3);
+        BigNum::nttThreshold = 0;
+        double nttMs = timeMs([&] { sink = sink + (x * y).compareAbsoluteValue(x); }, 3);
+        std::cout << "  " << limbCount << " limbs: Toom-3 " << toomMs << " ms, NTT " << nttMs << " ms" << std::endl;
     }
-
-    // Multiplication operator
-    BigNum operator*(const BigNum& other) const {
-        // Handle special cases (multiplication by 0)
-        if ((digits.size() == 1 && digits[0] == 0) || 
-            (other.digits.size() == 1 && other.digits[0] == 0)) {
-            return BigNum(0);
+    BigNum::nttThreshold = savedNtt;
+    
+    // Division: Knuth's Algorithm D against the Newton reciprocal, 2n-digit by n-digit
+    const size_t savedNewton = BigNum::newtonDivisionThreshold;
+    std::cout << "\nDivision (2n / n digits)" << std::endl;
+    for (size_t digits : {1000, 10000, 100000, 1000000}) {
+        BigNum u(randomDigits(2 * digits, gen)), v(randomDigits(digits, gen));
+        BigNum::newtonDivisionThreshold = 0;
+        double newtonMs = timeMs([&] { sink = sink + (u / v).compareAbsoluteValue(v); }, 3);
+        std::cout << "  div  " << digits << " digits: newton " << newtonMs << " ms";
+        if (digits <= 100000) {
+            BigNum::newtonDivisionThreshold = SIZE_MAX;
+            double knuthMs = timeMs([&] { sink = sink + (u / v).compareAbsoluteValue(v); }, digits >= 100000 ? 1 : 3);
+            std::cout << ", knuth " << knuthMs << " ms";
+        }
+        std::cout << std::endl;
+    }
+    BigNum::newtonDivisionThreshold = savedNewton;
+    
+    // RSA-size modular exponentiation: full-size exponent, odd (Montgomery) and even (Barrett) moduli
+    std::cout << "\nModular exponentiation (exponent as wide as the modulus)" << std::endl;
+    for (int bits : {1024, 2048, 4096}) {
+        BigNum modulus = BigNum(2).pow(bits) - BigNum(randomDigits(30, gen)) * BigNum(2) - BigNum(1);
+        if (modulus % BigNum(5) == BigNum(0)) {
+            modulus = modulus - BigNum(2); // Keep it coprime to 10 so it takes the Montgomery path
+        }
+        BigNum exponent = modulus - BigNum(randomDigits(20, gen));
+        BigNum base(randomDigits(bits * 3 / 10, gen));
+        double montgomeryMs = timeMs([&] { sink = sink + BigNum::powMod(base, exponent, modulus).compareAbsoluteValue(base); }, 3);
+        BigNum evenModulus = modulus + BigNum(1);
+        double barrettMs = timeMs([&] { sink = sink + BigNum::powMod(base, exponent, evenModulus).compareAbsoluteValue(base); }, 3);
+        std::cout << "  powMod " << bits << "-bit: montgomery " << montgomeryMs << " ms, barrett " << barrettMs << " ms"
+                  << std::endl;
+    }
+    
+    // Storage: decimal text parsed back with fromChars against the binary archive read in
+    // place through BigNumViews and against full deserialization into BigNums
+    std::cout << "\nSerialization (1M values each)" << std::endl;
+    for (size_t digits : {20, 200}) {
+        std::vector<BigNum> values;
+        std::string text;
+        for (int i = 0; i < 1000000; ++i) {
+            values.emplace_back(randomDigits(digits, gen));
+            values.back().appendTo(text);
+            text += '\n';
         }
-
-        // Determine the sign of the result
-        bool resultNegative = (isNegative != other.isNegative);
-        
-        // Initialize result with zeros
-        BigNum result;
-        result.digits.resize(digits.size() + other.digits.size(), 0);
         
-        // Perform long multiplication algorithm
-        for (size_t i = 0; i < digits.size(); ++i) {
-            int carry = 0;
-            for (size_t j = 0; j < other.digits.size() || carry; ++j) {
-                long long product = result.digits[i + j] + carry;
-                if (j < other.digits.size()) {
-                    product += (long long)digits[i] * other.digits[j];
+        double textMs = timeMs([&] {
+            const char* p = text.data();
+            const char* end = p + text.size();
+            while (p < end) {
+                const char* line = p;
+                while (*p != '\n') {
+                    ++p;
                 }
-                
-                result.digits[i + j] = product % 10;
-                carry = product / 10;
+                sink = sink + BigNum::fromChars(line, static_cast<size_t>(p - line)).decimalLength();
+                ++p;
             }
+        }, 3);
+        size_t binaryBytes = 16; // BigNumArchive::HEADER_SIZE
+        for (const BigNum& value : values) {
+            binaryBytes += value.serializedSize();
         }
-        
-        result.isNegative = resultNegative;
-        result.removeLeadingZeros();
-        return result;
+        std::cout << "  " << digits << " digits: text " << text.size() << " bytes, binary " << binaryBytes
+                  << " bytes; parse text " << textMs << " ms";
+#if BIGNUM_LITTLE_ENDIAN
+        const std::string archivePath = "bignum_bench.bna";
+        BigNumArchive::write(archivePath, values);
+        double viewMs = timeMs([&] {
+            BigNumArchive archive(archivePath);
+            for (BigNumView view : archive) {
+                sink = sink + view.limbs()[0];
+            }
+        }, 3);
+        double loadMs = timeMs([&] {
+            BigNumArchive archive(archivePath);
+            for (BigNumView view : archive) {
+                sink = sink + view.toBigNum().decimalLength();
+            }
+        }, 3);
+        std::remove(archivePath.c_str());
+        std::cout << ", mmap views " << viewMs << " ms, mmap + deserialize " << loadMs << " ms";
+#endif
+        std::cout << std::endl;
     }
+}
 
-    // Compare the absolute values of two BigNum objects
-    int compareAbsoluteValue(const BigNum& other) const {
-        if (digits.size() != other.digits.size()) {
-            return (digits.size() > other.digits.size()) ? 1 : -1;
+// Randomized differential test of the multiplication tiers against the schoolbook
+// reference. The thresholds are lowered while it runs so that small operands already
+// recurse through Karatsuba, Toom-3, NTT and the unbalanced-operand split; every
+// fourth trial is a square. Each trial also runs the compound-assignment and rvalue
+// forms, including operands that alias the destination.
+int runMultiplyDifferentialTest(int trials) {
+    std::mt19937_64 gen(2024);
+    std::uniform_int_distribution<size_t> length(1, 600);
+    std::uniform_int_distribution<int> shape(0, 3);
+    
+    auto randomOperand = [&](size_t digits) {
+        std::string s;
+        switch (shape(gen)) {
+            case 0: s = std::string(digits, '9'); break;                  // Carries everywhere
+            case 1: s = "1" + std::string(digits - 1, '0'); break;        // Mostly zero limbs
+            default: s = randomDigits(digits, gen); break;
         }
-        
-        for (int i = digits.size() - 1; i >= 0; --i) {
-            if (digits[i] != other.digits[i]) {
-                return (digits[i] > other.digits[i]) ? 1 : -1;
+        return BigNum((gen() & 1) ? "-" + s : s);
+    };
+    
+    const size_t savedKaratsuba = BigNum::karatsubaThreshold;
+    const size_t savedToom3 = BigNum::toom3Threshold;
+    const size_t savedNtt = BigNum::nttThreshold;
+    BigNum::karatsubaThreshold = 4;
+    BigNum::toom3Threshold = 8;
+    
+    int matches = 0;
+    for (int t = 0; t < trials; ++t) {
+        // Alternate between the NTT tier kicking in early and not at all
+        BigNum::nttThreshold = (t % 2 == 0) ? 24 : SIZE_MAX;
+        BigNum a = randomOperand(length(gen));
+        if (t % 4 == 3) {
+            BigNum selfProduct = a;
+            selfProduct *= selfProduct;
+            if (a * a == BigNum::multiplySchoolbook(a, a) && a.square() == a * a && selfProduct == a * a) {
+                ++matches;
             }
+            continue;
+        }
+        BigNum b = randomOperand(length(gen));
+        BigNum expected = BigNum::multiplySchoolbook(a, b);
+        BigNum inPlace = a;
+        inPlace *= b;
+        BigNum roundTrip = a;
+        roundTrip += b;
+        roundTrip -= b;
+        if (a * b == expected && inPlace == expected && BigNum(a) * BigNum(b) == expected &&
+            roundTrip == a && (a + b) - b == a && a - (a + b) == BigNum(0) - b) {
+            ++matches;
         }
-        
-        return 0; // Equal
     }
     
-    // Compare operator
-    bool operator==(const BigNum& other) const {
-        return (isNegative == other.isNegative) && (digits == other.digits);
-    }
+    BigNum::karatsubaThreshold = savedKaratsuba;
+    BigNum::toom3Threshold = savedToom3;
+    BigNum::nttThreshold = savedNtt;
+    return matches;
+}
+
+// Randomized differential test of the fused expression evaluation against the same values
+// built one compound assignment at a time. Covers mixed signs, nesting, integer operands,
+// multiply-accumulate, destinations that are also operands or factors, and rvalue operands
+// whose storage the destination takes over.
+int runExpressionDifferentialTest(int trials) {
+    std::mt19937_64 gen(31337);
+    std::uniform_int_distribution<size_t> length(1, 200);
+    auto randomOperand = [&]() {
+        std::string s = randomDigits(length(gen), gen);
+        return BigNum((gen() & 1) ? "-" + s : s);
+    };
     
-    bool operator!=(const BigNum& other) const {
-        return !(*this == other);
+    int matches = 0;
+    for (int t = 0; t < trials; ++t) {
+        BigNum a = randomOperand(), b = randomOperand(), c = randomOperand(), d = randomOperand();
+        BigNum ab = BigNum::multiplySchoolbook(a, b);
+        BigNum cd = BigNum::multiplySchoolbook(c, d);
+        
+        BigNum sum = a;
+        sum += b;
+        sum += c;
+        sum -= d;
+        BigNum macc = ab;
+        macc += c;
+        BigNum twoProducts = ab;
+        twoProducts -= cd;
+        twoProducts -= a;
+        
+        BigNum self = a;
+        self = self + self - b;        // Destination read twice as an operand
+        BigNum accumulated = c;
+        accumulated += a * b;          // Fused multiply-accumulate in place
+        BigNum factor = a;
+        factor = d - factor * b;       // Destination is a factor of a product
+        BigNum selfAccumulated = a;
+        selfAccumulated -= selfAccumulated * b;
+        
+        BigNum expectedSelf = a;
+        expectedSelf += a;
+        expectedSelf -= b;
+        BigNum expectedFactor = d;
+        expectedFactor -= ab;
+        BigNum expectedSelfAccumulated = a;
+        expectedSelfAccumulated -= ab;
+        BigNum expectedIntegers = BigNum::multiplySchoolbook(a, BigNum(3));
+        expectedIntegers -= BigNum(7);
+        expectedIntegers += b;
+        BigNum expectedNested = a;
+        expectedNested -= b;
+        expectedNested += c;
+        
+        // Rvalue operands lend their limbs to the destination, which must not change the
+        // value, nor take an operand that the expression reads a second time
+        BigNum movedA = a, movedD = d;
+        BigNum fromRvalues = std::move(movedA) + b + c - std::move(movedD);
+        BigNum small(1);
+        small = BigNum(d) - BigNum(a) * b;
+        BigNum twice = a;
+        BigNum readTwice = std::move(twice) + twice - b;
+        
+        if ((a + b + c - d) == sum && (a * b + c) == macc && (a * b - c * d - a) == twoProducts &&
+            (-1 * (c - a * b)) == macc - c - c && BigNum(a) + BigNum(b) + c - d == sum &&
+            self == expectedSelf && accumulated == macc && factor == expectedFactor &&
+            selfAccumulated == expectedSelfAccumulated && (a * 3 - 7 + b) == expectedIntegers &&
+            a - (b - c) == expectedNested && (a + b) * (c - d) == BigNum::multiplySchoolbook(a + b, c - d) &&
+            (a - a) == BigNum(0) && (a + b - b - a) == BigNum(0) && fromRvalues == sum &&
+            small == expectedFactor && readTwice == expectedSelf) {
+            ++matches;
+        }
     }
+    return matches;
+}
+
+// The SSE2 and AVX2 add/subtract kernels against the scalar loop, on every level the CPU
+// supports. Operands made of 9s and of 0s make carries and borrows ripple across whole
+// vector blocks; lengths straddle the 4- and 8-limb block sizes.
+int runAddSubKernelTest(int trials) {
+    std::mt19937_64 gen(99991);
+    std::uniform_int_distribution<size_t> length(1, 400);
+    std::uniform_int_distribution<int> shape(0, 3);
+    auto randomOperand = [&]() {
+        size_t digits = length(gen);
+        std::string s;
+        switch (shape(gen)) {
+            case 0: s = std::string(digits, '9'); break;
+            case 1: s = "1" + std::string(digits - 1, '0'); break;
+            default: s = randomDigits(digits, gen); break;
+        }
+        return BigNum((gen() & 1) ? "-" + s : s);
+    };
     
-    bool operator<(const BigNum& other) const {
-        if (isNegative != other.isNegative) {
-            return isNegative;
+    const int savedLevel = BigNum::simdLevel;
+    int matches = 0;
+    for (int t = 0; t < trials; ++t) {
+        BigNum a = randomOperand(), b = randomOperand();
+        BigNum::simdLevel = 0;
+        BigNum sum = a + b, difference = a - b;
+        bool ok = true;
+        for (int level = 1; level <= savedLevel; ++level) {
+            BigNum::simdLevel = level;
+            BigNum inPlace = a;
+            inPlace -= b;
+            ok = ok && BigNum(a + b) == sum && BigNum(a - b) == difference && inPlace == difference &&
+                 BigNum(sum - b) == a && BigNum::multiplySchoolbook(a, b) == a * b;
         }
+        if (ok) {
+            ++matches;
+        }
+    }
+    BigNum::simdLevel = savedLevel;
+    return matches;
+}
+
+// Products computed on a four-thread multiplication pool must match the serial ones. Sizes
+// run up to ~70k limbs so that the butterfly ranges and the CRT ranges get split; every other
+// trial switches the NTT off so the Karatsuba/Toom-3 sub-products run in parallel instead.
+int runParallelMultiplyTest(int trials) {
+    std::mt19937_64 gen(777);
+    std::uniform_int_distribution<size_t> length(1000, 600000);
+    const size_t savedParallel = BigNum::parallelThreshold;
+    const size_t savedNtt = BigNum::nttThreshold;
+    
+    int matches = 0;
+    for (int t = 0; t < trials; ++t) {
+        BigNum::nttThreshold = (t % 2 == 0) ? savedNtt : SIZE_MAX;
+        BigNum a(randomDigits(length(gen), gen));
+        BigNum b = (t % 3 == 2) ? a : BigNum(randomDigits(length(gen), gen));
+        BigNum serial = (t % 3 == 2) ? a.square() : a * b;
         
-        int absComp = compareAbsoluteValue(other);
-        return isNegative ? absComp > 0 : absComp < 0;
+        BigNum::parallelThreshold = 64;
+        BigNum::setMultiplyThreads(4);
+        BigNum parallel = (t % 3 == 2) ? a.square() : a * b;
+        BigNum::setMultiplyThreads(1);
+        BigNum::parallelThreshold = savedParallel;
+        if (parallel == serial) {
+            ++matches;
+        }
     }
     
-    bool operator<=(const BigNum& other) const {
-        return (*this < other) || (*this == other);
+    BigNum::nttThreshold = savedNtt;
+    return matches;
+}
+
+// Randomized differential test of division: checks a == q * b + r with |r| < |b| and the
+// sign rules, and that the Newton-reciprocal path (forced on for every other trial by
+// lowering its threshold) agrees with Knuth's Algorithm D.
+int runDivisionDifferentialTest(int trials) {
+    std::mt19937_64 gen(4242);
+    std::uniform_int_distribution<size_t> length(1, 3000);
+    const size_t savedNewton = BigNum::newtonDivisionThreshold;
+    
+    int passes = 0;
+    for (int t = 0; t < trials; ++t) {
+        size_t aDigits = length(gen);
+        size_t bDigits = std::uniform_int_distribution<size_t>(1, aDigits + 20)(gen);
+        BigNum a((gen() & 1) ? "-" + randomDigits(aDigits, gen) : randomDigits(aDigits, gen));
+        BigNum b((gen() & 1) ? "-" + randomDigits(bDigits, gen) : randomDigits(bDigits, gen));
+        
+        BigNum q, r, qKnuth, rKnuth;
+        BigNum::newtonDivisionThreshold = SIZE_MAX;
+        BigNum::divMod(a, b, qKnuth, rKnuth);
+        BigNum::newtonDivisionThreshold = (t % 2 == 0) ? 2 : savedNewton;
+        BigNum::divMod(a, b, q, r);
+        
+        bool remainderSignOk = (r == BigNum(0)) || ((r < BigNum(0)) == (a < BigNum(0)));
+        if (q == qKnuth && r == rKnuth && q * b + r == a && r.compareAbsoluteValue(b) < 0 && remainderSignOk) {
+            ++passes;
+        }
     }
     
-    bool operator>(const BigNum& other) const {
-        return !(*this <= other);
+    BigNum::newtonDivisionThreshold = savedNewton;
+    return passes;
+}
+
+// Round trips through the binary format: serialize/deserialize, in-place views over a
+// buffer and over a memory-mapped archive, and rejection of truncated and non-canonical
+// records. Values include zero, single limbs and limb-boundary lengths.
+int runSerializationTest(int trials) {
+    std::mt19937_64 gen(8080);
+    std::uniform_int_distribution<size_t> length(1, 300);
+    std::vector<BigNum> values;
+    for (int t = 0; t < trials; ++t) {
+        std::string s = (t % 50 == 0) ? "0" : randomDigits(length(gen), gen);
+        values.emplace_back((s != "0" && (gen() & 1)) ? "-" + s : s);
     }
     
-    bool operator>=(const BigNum& other) const {
-        return !(*this < other);
+    int matches = 0;
+    std::string buffer;
+    std::vector<size_t> offsets;
+    for (const BigNum& value : values) {
+        offsets.push_back(buffer.size());
+        value.appendSerialized(buffer);
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+        size_t consumed = 0;
+        BigNum back = BigNum::deserialize(buffer.data() + offsets[i], buffer.size() - offsets[i], &consumed);
+        bool ok = back == values[i] && consumed == values[i].serializedSize();
+#if BIGNUM_LITTLE_ENDIAN
+        BigNumView view(buffer.data() + offsets[i], buffer.size() - offsets[i]);
+        ok = ok && view == values[i] && view.byteSize() == consumed && view.toString() == values[i].toString() &&
+             view.toBigNum() == values[i];
+#endif
+        if (ok) {
+            ++matches;
+        }
     }
     
-    // Convert to string representation
-    std::string toString() const {
-        if (digits.empty()) {
-            return "0";
+#if BIGNUM_LITTLE_ENDIAN
+    const std::string path = "bignum_test.bna";
+    BigNumArchive::write(path, values);
+    {
+        BigNumArchive archive(path);
+        size_t i = 0;
+        for (BigNumView view : archive) {
+            if (i >= values.size() || view != values[i]) {
+                --matches;
+            }
+            ++i;
         }
-        
-        std::string result = isNegative ? "-" : "";
-        for (int i = digits.size() - 1; i >= 0; --i) {
-            result += std::to_string(digits[i]);
+        if (archive.size() != values.size() || i != values.size()) {
+            --matches;
         }
-        return result;
     }
+    std::remove(path.c_str());
+#endif
     
-    // Friend function to enable cout << BigNum
-    friend std::ostream& operator<<(std::ostream& os, const BigNum& num) {
-        os << num.toString();
-        return os;
+    // A record cut short, a limb of 10^9 and a negative zero must all be refused
+    auto rejects = [](const std::string& record) {
+        try {
+            BigNum::deserialize(record.data(), record.size());
+            return false;
+        } catch (const std::invalid_argument&) {
+            return true;
+        }
+    };
+    std::string truncated;
+    BigNum("123456789012345678901234567890").appendSerialized(truncated);
+    truncated.pop_back();
+    std::string oversized;
+    BigNum("999999999").appendSerialized(oversized);
+    oversized[4] = static_cast<char>(0x00);
+    oversized[5] = static_cast<char>(0xCA);
+    oversized[6] = static_cast<char>(0x9A);
+    oversized[7] = static_cast<char>(0x3B); // 1000000000 little-endian
+    std::string negativeZero;
+    BigNum(0).appendSerialized(negativeZero);
+    negativeZero[3] = static_cast<char>(0x80);
+    if (!rejects(truncated) || !rejects(oversized) || !rejects(negativeZero) || !rejects(std::string())) {
+        --matches;
+    }
+#if BIGNUM_LITTLE_ENDIAN
+    // A view must refuse to print the same corrupt records rather than index past the digit
+    // tables; {1, 4000000000} is a one-limb record whose limb is far above 10^9 - 1
+    auto viewRejects = [](const std::string& record) {
+        alignas(uint32_t) char aligned[64];
+        std::copy(record.begin(), record.end(), aligned);
+        BigNumView view(aligned, record.size());
+        for (int call = 0; call < 2; ++call) {
+            try {
+                if (call == 0) {
+                    view.toString();
+                } else {
+                    char out[32];
+                    view.toChars(out, sizeof(out));
+                }
+                return false;
+            } catch (const std::invalid_argument&) {
+            }
+        }
+        return true;
+    };
+    std::string hugeLimb;
+    BigNum(1).appendSerialized(hugeLimb);
+    const uint32_t huge = 4000000000u;
+    std::memcpy(&hugeLimb[4], &huge, sizeof(huge));
+    std::string leadingZero;
+    BigNum("1000000000").appendSerialized(leadingZero);
+    std::memset(&leadingZero[8], 0, 4); // Top limb 0
+    if (!viewRejects(hugeLimb) || !viewRejects(oversized) || !viewRejects(leadingZero)) {
+        --matches;
     }
-};
+#endif
+    return matches;
+}
 
 // Test the BigNum implementation
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runBenchmarks();
+        return 0;
+    }
+    
     // Test constructors
     BigNum a("12345678901234567890");
     BigNum b("98765432109876543210");
@@ -334,5 +848,93 @@ int main() {
     std::cout << "Sum = " << (superLarge1 + superLarge2) << std::endl;
     std::cout << "Product = " << (superLarge1 * superLarge2) << std::endl;
     
+    // Test division, modulo and powers
+    std::cout << "\nDivision Tests:" << std::endl;
+    std::cout << "b / a = " << (b / a) << std::endl;
+    std::cout << "b % a = " << (b % a) << std::endl;
+    std::cout << "c / e = " << (c / e) << std::endl;
+    std::cout << "c % e = " << (c % e) << std::endl;
+    std::cout << "superLarge2 / superLarge1 = " << (superLarge2 / superLarge1) << std::endl;
+    std::cout << "e^20 = " << e.pow(20) << std::endl;
+    
+    // Fermat's little theorem on the Mersenne primes 2^127 - 1 and 2^521 - 1: a^(p-1) mod p == 1
+    std::cout << "\nModular Exponentiation Tests:" << std::endl;
+    BigNum m127 = BigNum(2).pow(127) - BigNum(1);
+    BigNum m521 = BigNum(2).pow(521) - BigNum(1);
+    std::cout << "3^(M127-1) mod M127 = " << BigNum::powMod(BigNum(3), m127 - BigNum(1), m127) << std::endl;
+    std::cout << "a^(M521-1) mod M521 = " << BigNum::powMod(a, m521 - BigNum(1), m521) << std::endl;
+    std::cout << "e^1000 mod 10^30 = " << BigNum::powMod(e, BigNum(1000), BigNum(10).pow(30))
+              << " (expected " << (e.pow(1000) % BigNum(10).pow(30)) << ")" << std::endl;
+    
+    // Random bases, exponents and moduli (odd ones take the Montgomery path, the rest Barrett)
+    std::mt19937_64 powGen(99);
+    const int powTrials = 100;
+    int powMatches = 0;
+    for (int t = 0; t < powTrials; ++t) {
+        BigNum base(randomDigits(1 + powGen() % 60, powGen));
+        BigNum modulus(randomDigits(1 + powGen() % 40, powGen));
+        unsigned long long exponent = powGen() % 300;
+        if (BigNum::powMod(base, BigNum(static_cast<long long>(exponent)), modulus) == base.pow(exponent) % modulus) {
+            ++powMatches;
+        }
+    }
+    std::cout << powMatches << "/" << powTrials << " random powMod results match pow() % modulus" << std::endl;
+    
+    // Decimal round trips: random digit strings (with leading zeros) through the string
+    // constructor, toString, toChars, appendTo and the buffered operator<<
+    std::cout << "\nDecimal Conversion Tests:" << std::endl;
+    std::mt19937_64 ioGen(7);
+    const int ioTrials = 200;
+    int ioMatches = 0;
+    for (int t = 0; t < ioTrials; ++t) {
+        std::string digits = randomDigits(1 + ioGen() % 3000, ioGen);
+        std::string sign = (t % 2) ? "-" : "";
+        std::string text = sign + digits;
+        BigNum parsed(sign + std::string(t % 7, '0') + digits);
+        std::ostringstream streamed;
+        streamed << parsed;
+        std::string appended = "x=";
+        parsed.appendTo(appended);
+        std::vector<char> buffer(text.size());
+        bool fits = parsed.toChars(buffer.data(), buffer.size()) == text.size() &&
+                    parsed.toChars(buffer.data(), buffer.size() - 1) == 0;
+        if (parsed.toString() == text && streamed.str() == text && appended == "x=" + text && fits &&
+            std::string(buffer.begin(), buffer.end()) == text &&
+            BigNum::fromChars(text.data(), text.size()) == parsed) {
+            ++ioMatches;
+        }
+    }
+    std::cout << ioMatches << "/" << ioTrials << " numbers survive the round trip" << std::endl;
+    
+    // Randomized differential test of Karatsuba/Toom-3/NTT against schoolbook multiplication
+    const int trials = 2000;
+    std::cout << "\nRandomized Multiplication Differential Test:" << std::endl;
+    std::cout << runMultiplyDifferentialTest(trials) << "/" << trials << " products match schoolbook" << std::endl;
+    
+    const int kernelTrials = 1000;
+    std::cout << "\nAdd/Subtract Kernel Test (SIMD level " << BigNum::simdLevel << "):" << std::endl;
+    std::cout << runAddSubKernelTest(kernelTrials) << "/" << kernelTrials
+              << " sums and differences match the scalar kernels" << std::endl;
+    
+    const int expressionTrials = 1000;
+    std::cout << "\nRandomized Expression Differential Test:" << std::endl;
+    std::cout << runExpressionDifferentialTest(expressionTrials) << "/" << expressionTrials
+              << " fused expressions match step-by-step evaluation" << std::endl;
+    
+    const int parallelTrials = 12;
+    std::cout << "\nParallel Multiplication Test:" << std::endl;
+    std::cout << runParallelMultiplyTest(parallelTrials) << "/" << parallelTrials
+              << " products on a 4-thread pool match the serial ones" << std::endl;
+    
+    const int divisionTrials = 500;
+    std::cout << "\nRandomized Division Differential Test:" << std::endl;
+    std::cout << runDivisionDifferentialTest(divisionTrials) << "/" << divisionTrials
+              << " quotients and remainders check out" << std::endl;
+    
+    const int serializationTrials = 1000;
+    std::cout << "\nBinary Serialization Test:" << std::endl;
+    std::cout << runSerializationTest(serializationTrials) << "/" << serializationTrials
+              << " values survive serialize, view and archive round trips" << std::endl;
+    
     return 0;
 }
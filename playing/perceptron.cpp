@@ -1,122 +1,303 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>     // For std::remove
+#include <filesystem> // For std::filesystem::temp_directory_path
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
-#include <numeric> // For std::inner_product
-#include <random>  // For random weight initialization
-
-/**
- * @class Perceptron
- * @brief Represents a single neuron, the simplest form of a neural network.
- *
- * This class encapsulates the logic for a perceptron, which can be trained
- * to solve binary linear classification problems. It has weights, a bias,
-_TITLE_ and methods to predict an output and to train itself based on feedback.
- */
-class Perceptron {
-private:
-    // Member Variables
-    std::vector<double> weights; // Stores the weight for each input feature.
-    double bias;                 // The bias term, acts like an adjustable threshold.
-    double learning_rate;        // Controls how much the weights and bias are adjusted during training.
-
-    /**
-     * @brief The activation function.
-     * @param x The weighted sum of inputs plus bias.
-     * @return 1 if x is greater than or equal to 0, otherwise 0.
-     *
-     * This is a simple "Heaviside step function". It's the decision-making
-     * part of the neuron. If the combined signal (x) is strong enough, it "fires" (returns 1).
-     */
-    int step_function(double x) {
-        return (x >= 0) ? 1 : 0;
-    }
 
-public:
-    /**
-     * @brief Constructor for the Perceptron class.
-     * @param num_inputs The number of input features the perceptron will have.
-     * @param lr The learning rate for training. Defaults to 0.01.
-     *
-     * Initializes the perceptron with a specific number of inputs.
-     * Weights are initialized to small random values to break symmetry,
-     * and the bias is also initialized randomly.
-     */
-    Perceptron(int num_inputs, double lr = 0.01) : learning_rate(lr) {
-        // Setup for random number generation
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_real_distribution<> dis(0.0, 1.0);
-
-        // Initialize weights with small random numbers
-        for (int i = 0; i < num_inputs; ++i) {
-            weights.push_back(dis(gen));
+#include "dataset.h"
+#include "perceptron.h"
+
+// Writes random datasets in both file formats and checks that streaming them back through
+// DatasetStream returns every row unchanged and in order. Chunk and read sizes are small
+// and random so rows straddle chunks and lines straddle reads; some CSV files get a header
+// line and Windows line endings.
+int runDatasetStreamTest(int trials) {
+    std::mt19937 gen(31);
+    std::normal_distribution<> dis(0.0, 1e3);
+    const std::string dir = std::filesystem::temp_directory_path().string();
+    const std::string bin_path = dir + "/perceptron_stream_test.bin";
+    const std::string csv_path = dir + "/perceptron_stream_test.csv";
+
+    int matches = 0;
+    for (int t = 0; t < trials; ++t) {
+        const size_t rows = gen() % 3000, num_inputs = 1 + gen() % 20, chunk_rows = 1 + gen() % 700;
+        const size_t block_bytes = 64 + gen() % 4096;
+        std::vector<double> features(rows * num_inputs);
+        std::vector<int> targets(rows);
+        for (double& x : features) x = dis(gen);
+        for (int& y : targets) y = static_cast<int>(gen() % 2);
+
+        MappedDataset::write(bin_path, features.data(), targets.data(), rows, num_inputs);
+        CsvDataset::write(csv_path, features.data(), targets.data(), rows, num_inputs);
+        const bool header = t % 3 == 0, crlf = t % 2 == 1;
+        if (header || crlf) {
+            std::ifstream in(csv_path, std::ios::binary);
+            std::stringstream text;
+            text << in.rdbuf();
+            std::string csv = header ? "x,y\n" + text.str() : text.str();
+            std::string rewritten;
+            for (char c : csv) {
+                rewritten += (crlf && c == '\n') ? std::string("\r\n") : std::string(1, c);
+            }
+            std::ofstream(csv_path, std::ios::binary | std::ios::trunc) << rewritten;
+        }
+
+        MappedDataset mapped(bin_path, chunk_rows);
+        CsvDataset csv(csv_path, num_inputs, chunk_rows, header, block_bytes);
+        bool ok = mapped.num_rows() == rows && mapped.num_features() == num_inputs;
+        for (int pass = 0; pass < 2; ++pass) {
+            size_t mapped_seen = 0, csv_seen = 0;
+            DatasetStream mapped_stream([&mapped](DatasetChunk& c) { return mapped.read_chunk(c); });
+            while (const DatasetChunk* chunk = mapped_stream.next()) {
+                for (size_t i = 0; i < chunk->rows * num_inputs && ok; ++i) {
+                    ok = chunk->features[i] == features[mapped_seen * num_inputs + i];
+                }
+                for (size_t r = 0; r < chunk->rows && ok; ++r) {
+                    ok = chunk->targets[r] == targets[mapped_seen + r];
+                }
+                mapped_seen += chunk->rows;
+            }
+            DatasetStream csv_stream([&csv](DatasetChunk& c) { return csv.read_chunk(c); });
+            while (const DatasetChunk* chunk = csv_stream.next()) {
+                for (size_t i = 0; i < chunk->rows * num_inputs && ok; ++i) {
+                    ok = chunk->features[i] == features[csv_seen * num_inputs + i];
+                }
+                for (size_t r = 0; r < chunk->rows && ok; ++r) {
+                    ok = chunk->targets[r] == targets[csv_seen + r];
+                }
+                csv_seen += chunk->rows;
+            }
+            ok = ok && mapped_seen == rows && csv_seen == rows;
+            // The second pass checks that rewind starts each reader over
+            mapped.rewind();
+            csv.rewind();
+        }
+        if (ok) {
+            ++matches;
         }
-        // Initialize bias with a small random number
-        bias = dis(gen);
     }
+    std::remove(bin_path.c_str());
+    std::remove(csv_path.c_str());
+    return matches;
+}
+
+// Runs predict_batch at every simd_level this CPU supports for every row length from 1 to
+// 70, which crosses each kernel's dispatch threshold and unroll width and every masked tail
+// length of the AVX-512 kernels, and compares each prediction with the scalar kernel's. A
+// vector kernel sums in a different order, so it may only disagree on a row whose weighted
+// sum is within rounding error of zero. Returns the number of (level, length) runs that agree.
+template <typename T>
+int runSimdKernelTest(int max_level, size_t max_inputs) {
+    const size_t rows = 33;
+    const int saved_level = Perceptron::simd_level;
+    std::mt19937 gen(5);
+    std::normal_distribution<T> dis(0, 1);
+    int matches = 0;
+    for (size_t n = 1; n <= max_inputs; ++n) {
+        Perceptron p(static_cast<int>(n));
+        std::vector<T> features(rows * n);
+        for (T& x : features) x = dis(gen);
+        std::vector<T> w(p.get_weights().begin(), p.get_weights().end());
+        const T bias = static_cast<T>(p.get_bias());
 
-    /**
-     * @brief Predicts the output for a given set of inputs.
-     * @param inputs A vector of input values.
-     * @return The predicted output (0 or 1).
-     *
-     * This method calculates the weighted sum of the inputs, adds the bias,
-     * and then passes the result through the activation function to get the final prediction.
-     */
-    int predict(const std::vector<double>& inputs) {
-        // Ensure the number of inputs matches the number of weights
-        if (inputs.size() != weights.size()) {
-            std::cerr << "Error: Number of inputs must match number of weights." << std::endl;
-            return -1; // Indicate an error
+        std::vector<int> expected(rows), predicted(rows);
+        Perceptron::simd_level = 0;
+        p.predict_batch(features.data(), rows, expected.data());
+        for (int level = 1; level <= max_level; ++level) {
+            Perceptron::simd_level = level;
+            p.predict_batch(features.data(), rows, predicted.data());
+            bool ok = true;
+            for (size_t r = 0; r < rows; ++r) {
+                long double sum = bias, magnitude = std::abs(bias);
+                for (size_t i = 0; i < n; ++i) {
+                    sum += static_cast<long double>(features[r * n + i]) * w[i];
+                    magnitude += std::abs(static_cast<long double>(features[r * n + i]) * w[i]);
+                }
+                const long double rounding = 4 * (n + 1) * std::numeric_limits<T>::epsilon() * magnitude;
+                ok = ok && (predicted[r] == expected[r] || std::abs(sum) <= rounding);
+            }
+            matches += ok ? 1 : 0;
         }
+    }
+    Perceptron::simd_level = saved_level;
+    return matches;
+}
 
-        // Calculate the weighted sum using std::inner_product for efficiency and clarity.
-        // It computes: (inputs[0]*weights[0] + inputs[1]*weights[1] + ...)
-        double weighted_sum = std::inner_product(inputs.begin(), inputs.end(), weights.begin(), 0.0);
-        
-        // Pass the weighted sum plus bias to the activation function
-        return step_function(weighted_sum + bias);
+// Streaming report (run with --stream [rows]): writes a synthetic dataset of rows rows in
+// both file formats and trains one epoch from each, streamed in chunks, next to one epoch
+// over the same data in memory. Only two chunks of the streamed data are in memory at once.
+void run_stream_report(size_t num_rows) {
+    const size_t num_inputs = 32, chunk_rows = 1 << 16, batch_size = 32;
+    std::mt19937 gen(11);
+    std::normal_distribution<> dis(0.0, 1.0);
+    std::vector<double> plane(num_inputs);
+    for (double& w : plane) {
+        w = dis(gen);
+    }
+    std::vector<double> features(num_rows * num_inputs);
+    std::vector<int> targets(num_rows);
+    for (size_t r = 0; r < num_rows; ++r) {
+        double sum = 0.0;
+        for (size_t i = 0; i < num_inputs; ++i) {
+            features[r * num_inputs + i] = dis(gen);
+            sum += features[r * num_inputs + i] * plane[i];
+        }
+        targets[r] = sum >= 0 ? 1 : 0;
     }
+    const std::string dir = std::filesystem::temp_directory_path().string();
+    const std::string bin_path = dir + "/perceptron_stream.bin";
+    const std::string csv_path = dir + "/perceptron_stream.csv";
+    MappedDataset::write(bin_path, features.data(), targets.data(), num_rows, num_inputs);
+    CsvDataset::write(csv_path, features.data(), targets.data(), num_rows, num_inputs);
 
-    /**
-     * @brief Trains the perceptron on a single data sample.
-     * @param inputs The vector of input values for the training sample.
-     * @param target The correct output (0 or 1) for the given inputs.
-     *
-     * This is the core of the learning algorithm. It makes a prediction,
-     * calculates the error, and then adjusts the weights and bias to reduce
-     * that error in the future.
-     */
-    void train(const std::vector<double>& inputs, int target) {
-        int prediction = predict(inputs);
-        
-        // Calculate the error: (correct_answer - our_prediction)
-        double error = target - prediction;
-
-        // The Perceptron Learning Rule:
-        // Update each weight based on the error.
-        // If the error is 0, no changes are made.
-        // If the error is non-zero, the weights are "nudged" in the direction
-        // that would have reduced the error.
-        for (size_t i = 0; i < weights.size(); ++i) {
-            weights[i] += learning_rate * error * inputs[i];
+    std::cout << "Streaming training: " << num_rows << " rows x " << num_inputs << " features, chunks of "
+              << chunk_rows << " rows (" << chunk_rows * num_inputs * sizeof(double) / (1 << 20) << " MB)"
+              << std::endl;
+    std::cout << "source             rows/s      MB/s   accuracy" << std::endl;
+    std::vector<int> predictions(num_rows);
+    auto report = [&](const char* name, double seconds, size_t bytes, const Perceptron& p) {
+        p.predict_batch(features.data(), num_rows, predictions.data());
+        size_t correct = 0;
+        for (size_t r = 0; r < num_rows; ++r) {
+            correct += (predictions[r] == targets[r]) ? 1 : 0;
         }
+        std::cout << "  " << name << "\t" << static_cast<long long>(num_rows / seconds) << "\t"
+                  << static_cast<long long>(bytes / seconds / (1 << 20)) << "\t" << 100.0 * correct / num_rows << "%"
+                  << std::endl;
+    };
+    auto elapsed = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
 
-        // Update the bias as well.
-        bias += learning_rate * error;
+    {
+        Perceptron p(static_cast<int>(num_inputs));
+        std::mt19937 shuffle(1);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t first = 0; first < num_rows; first += chunk_rows) {
+            const size_t rows = std::min(chunk_rows, num_rows - first);
+            p.train_epoch(features.data() + first * num_inputs, targets.data() + first, rows, batch_size, shuffle);
+        }
+        report("in memory", elapsed(start), features.size() * sizeof(double), p);
+    }
+    {
+        Perceptron p(static_cast<int>(num_inputs));
+        std::mt19937 shuffle(1);
+        MappedDataset data(bin_path, chunk_rows);
+        auto start = std::chrono::steady_clock::now();
+        DatasetStream stream([&data](DatasetChunk& c) { return data.read_chunk(c); });
+        while (const DatasetChunk* chunk = stream.next()) {
+            p.train_epoch(chunk->features, chunk->targets, chunk->rows, batch_size, shuffle);
+        }
+        report("mmap binary", elapsed(start), std::filesystem::file_size(bin_path), p);
     }
+    for (bool prefetch : {false, true}) {
+        Perceptron p(static_cast<int>(num_inputs));
+        std::mt19937 shuffle(1);
+        CsvDataset data(csv_path, num_inputs, chunk_rows);
+        auto start = std::chrono::steady_clock::now();
+        if (prefetch) {
+            DatasetStream stream([&data](DatasetChunk& c) { return data.read_chunk(c); });
+            while (const DatasetChunk* chunk = stream.next()) {
+                p.train_epoch(chunk->features, chunk->targets, chunk->rows, batch_size, shuffle);
+            }
+        } else {
+            DatasetChunk chunk;
+            while (data.read_chunk(chunk)) {
+                p.train_epoch(chunk.features, chunk.targets, chunk.rows, batch_size, shuffle);
+            }
+        }
+        report(prefetch ? "csv, prefetched" : "csv, inline", elapsed(start), std::filesystem::file_size(csv_path), p);
+    }
+    std::remove(bin_path.c_str());
+    std::remove(csv_path.c_str());
+}
+
+// Hogwild scaling report (run with --hogwild [max_threads]): trains on a large synthetic
+// dataset with 1, 2, 4, ... threads up to max_threads (default: the core count) and prints
+// throughput and accuracy after each epoch.
+// The labels come from a random hyperplane, so the data is linearly separable and a
+// converged perceptron approaches 100% accuracy.
+void run_hogwild_report(unsigned max_threads) {
+    const size_t num_rows = 1 << 20;
+    const size_t num_inputs = 32;
+    const int epochs = 5;
+
+    std::mt19937 gen(7);
+    std::normal_distribution<> dis(0.0, 1.0);
+    std::vector<double> plane(num_inputs);
+    for (double& w : plane) {
+        w = dis(gen);
+    }
+    std::vector<double> features(num_rows * num_inputs);
+    std::vector<int> targets(num_rows);
+    for (size_t r = 0; r < num_rows; ++r) {
+        double sum = 0.0;
+        for (size_t i = 0; i < num_inputs; ++i) {
+            features[r * num_inputs + i] = dis(gen);
+            sum += features[r * num_inputs + i] * plane[i];
+        }
+        targets[r] = sum >= 0 ? 1 : 0;
+    }
+    std::vector<int> predictions(num_rows);
+
+    std::cout << "Hogwild training: " << num_rows << " rows x " << num_inputs << " features, " << epochs
+              << " epochs" << std::endl;
+    std::cout << "threads  samples/s    accuracy after each epoch" << std::endl;
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        Perceptron p(static_cast<int>(num_inputs));
+        double seconds = 0.0;
+        std::string accuracies;
+        for (int epoch = 0; epoch < epochs; ++epoch) {
+            auto start = std::chrono::steady_clock::now();
+            p.train_hogwild(features.data(), targets.data(), num_rows, 1, threads, 100 + epoch);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 
-    // A helper function to print the current weights and bias
-    void print_weights() {
-        std::cout << "Weights: [ ";
-        for (double w : weights) {
-            std::cout << w << " ";
+            p.predict_batch(features.data(), num_rows, predictions.data());
+            size_t correct = 0;
+            for (size_t r = 0; r < num_rows; ++r) {
+                correct += (predictions[r] == targets[r]) ? 1 : 0;
+            }
+            accuracies += "  " + std::to_string(100.0 * correct / num_rows).substr(0, 5) + "%";
         }
-        std::cout << "], Bias: " << bias << std::endl;
+        std::cout << "  " << threads << "\t " << static_cast<long long>(epochs * num_rows / seconds) << "\t"
+                  << accuracies << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--hogwild") {
+        unsigned max_threads = (argc > 2) ? static_cast<unsigned>(std::stoul(argv[2]))
+                                          : std::max(1u, std::thread::hardware_concurrency());
+        run_hogwild_report(max_threads);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--stream") {
+        run_stream_report((argc > 2) ? std::stoul(argv[2]) : size_t{1} << 20);
+        return 0;
     }
-};
 
+    // --- 0. The file readers behind --stream ---
+    const int stream_trials = 40;
+    std::cout << "--- Dataset Stream Test ---" << std::endl;
+    std::cout << runDatasetStreamTest(stream_trials) << "/" << stream_trials
+              << " datasets stream back unchanged from both file formats\n" << std::endl;
+
+    // --- 0b. The vector kernels behind predict_batch ---
+    const int max_level = Perceptron::simd_level;
+    const size_t max_inputs = 70;
+    std::cout << "--- SIMD Kernel Test (levels 1 to " << max_level << ") ---" << std::endl;
+    std::cout << runSimdKernelTest<double>(max_level, max_inputs) << "/" << max_level * max_inputs
+              << " double row lengths match the scalar kernel" << std::endl;
+    std::cout << runSimdKernelTest<float>(max_level, max_inputs) << "/" << max_level * max_inputs
+              << " float row lengths match the scalar kernel\n" << std::endl;
 
-int main() {
     // --- 1. Setup ---
     // Create a Perceptron with 2 inputs (since an AND gate takes two inputs)
     Perceptron p(2);
@@ -126,21 +307,27 @@ int main() {
     // Input: [0, 1], Target: 0
     // Input: [1, 0], Target: 0
     // Input: [1, 1], Target: 1
-    std::vector<std::vector<double>> training_inputs = {{0, 0}, {0, 1}, {1, 0}, {1, 1}};
+    // The inputs are stored as one row-major matrix (two values per row) so the whole
+    // dataset is a single contiguous block, with the targets in a parallel array.
+    std::vector<double> training_inputs = {0, 0,
+                                           0, 1,
+                                           1, 0,
+                                           1, 1};
     std::vector<int> targets = {0, 0, 0, 1};
+    const size_t num_rows = targets.size();
 
     std::cout << "--- Before Training ---" << std::endl;
     p.print_weights();
 
     // --- 3. Training Loop ---
     // We will loop through the entire dataset multiple times (epochs)
-    // to give the perceptron enough chances to learn.
+    // to give the perceptron enough chances to learn. Each epoch visits the
+    // samples in a fresh random order, two samples per weight update.
     int epochs = 100;
+    const size_t batch_size = 2;
+    std::mt19937 gen(42);
     for (int i = 0; i < epochs; ++i) {
-        // In each epoch, train on every sample in our dataset
-        for (size_t j = 0; j < training_inputs.size(); ++j) {
-            p.train(training_inputs[j], targets[j]);
-        }
+        p.train_epoch(training_inputs.data(), targets.data(), num_rows, batch_size, gen);
     }
 
     std::cout << "\n--- After " << epochs << " Epochs of Training ---" << std::endl;
@@ -153,5 +340,14 @@ int main() {
     std::cout << "Input: [0, 1] -> Prediction: " << p.predict({0, 1}) << " (Expected: 0)" << std::endl;
     std::cout << "Input: [1, 0] -> Prediction: " << p.predict({1, 0}) << " (Expected: 0)" << std::endl;
     std::cout << "Input: [1, 1] -> Prediction: " << p.predict({1, 1}) << " (Expected: 1)" << std::endl;
+
+    // The same four samples scored in one call, straight from the training matrix
+    std::vector<int> batch_predictions(num_rows);
+    p.predict_batch(training_inputs.data(), num_rows, batch_predictions.data());
+    std::cout << "Batch predictions: [ ";
+    for (int prediction : batch_predictions) {
+        std::cout << prediction << " ";
+    }
+    std::cout << "] (Expected: [ 0 0 0 1 ])" << std::endl;
     return 0;
 }
@@ -0,0 +1,482 @@
+#pragma once
+
+#include <algorithm> // For std::shuffle and std::min
+#include <atomic>    // For the shared weights of train_hogwild
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <numeric> // For std::inner_product and std::iota
+#include <random>  // For random weight initialization
+
+// The batch predict kernels for AVX2 and AVX-512 are compiled with target attributes and
+// only called when the CPU reports support for them at run time
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PERCEPTRON_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define PERCEPTRON_X86_SIMD 0
+#endif
+
+/**
+ * @class Perceptron
+ * @brief Represents a single neuron, the simplest form of a neural network.
+ *
+ * This class encapsulates the logic for a perceptron, which can be trained
+ * to solve binary linear classification problems. It has weights, a bias,
+_TITLE_ and methods to predict an output and to train itself based on feedback.
+ */
+class Perceptron {
+private:
+    friend class MappedModel; // Serves saved models through predict_rows
+    // Member Variables
+    std::vector<double> weights; // Stores the weight for each input feature.
+    double bias;                 // The bias term, acts like an adjustable threshold.
+    double learning_rate;        // Controls how much the weights and bias are adjusted during training.
+    std::vector<float> weights_f32; // Single-precision copy of weights for float predict_batch, kept in sync.
+
+    // Scratch space for batched training, kept between calls so an epoch does not allocate.
+    std::vector<double> weight_updates; // Summed weight updates of the current mini-batch.
+    std::vector<size_t> sample_order;   // Row indices of the dataset in their shuffled order.
+
+    /**
+     * @brief The weighted sum plus bias for one row of a contiguous feature matrix.
+     * @param row Pointer to weights.size() consecutive feature values.
+     */
+    double activation(const double* row) const {
+        return std::inner_product(row, row + weights.size(), weights.begin(), bias);
+    }
+
+    /**
+     * @brief The activation function.
+     * @param x The weighted sum of inputs plus bias.
+     * @return 1 if x is greater than or equal to 0, otherwise 0.
+     *
+     * This is a simple "Heaviside step function". It's the decision-making
+     * part of the neuron. If the combined signal (x) is strong enough, it "fires" (returns 1).
+     */
+    int step_function(double x) {
+        return (x >= 0) ? 1 : 0;
+    }
+
+    /**
+     * @brief Picks the widest batch predict kernel this CPU can run.
+     * @return 2 for AVX-512, 1 for AVX2 with FMA, 0 for the portable loop.
+     */
+    static int detect_simd_level() {
+#if PERCEPTRON_X86_SIMD
+        if (__builtin_cpu_supports("avx512f")) {
+            return 2;
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            return 1;
+        }
+#endif
+        return 0;
+    }
+
+    // The batch predict kernels: out[r] = step(row r . w + bias) for each row of a row-major
+    // matrix x with n values per row. The vector kernels keep several partial sums per row,
+    // so a weighted sum can differ from predict() in its last bits.
+    template <typename T>
+    static void predict_rows_scalar(const T* x, size_t rows, size_t n, const T* w, T bias, int* out) {
+        for (size_t r = 0; r < rows; ++r, x += n) {
+            T sum = bias;
+            for (size_t i = 0; i < n; ++i) {
+                sum += x[i] * w[i];
+            }
+            out[r] = (sum >= 0) ? 1 : 0;
+        }
+    }
+
+#if PERCEPTRON_X86_SIMD
+    __attribute__((target("avx2,fma")))
+    static void predict_rows_avx2(const double* x, size_t rows, size_t n, const double* w, double bias, int* out) {
+        for (size_t r = 0; r < rows; ++r, x += n) {
+            __m256d acc0 = _mm256_setzero_pd();
+            __m256d acc1 = _mm256_setzero_pd();
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(w + i), acc0);
+                acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(w + i + 4), acc1);
+            }
+            if (i + 4 <= n) {
+                acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(w + i), acc0);
+                i += 4;
+            }
+            acc0 = _mm256_add_pd(acc0, acc1);
+            __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+            double sum = bias + _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+            for (; i < n; ++i) {
+                sum += x[i] * w[i];
+            }
+            out[r] = (sum >= 0) ? 1 : 0;
+        }
+    }
+
+    __attribute__((target("avx2,fma")))
+    static void predict_rows_avx2(const float* x, size_t rows, size_t n, const float* w, float bias, int* out) {
+        for (size_t r = 0; r < rows; ++r, x += n) {
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+            size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(w + i), acc0);
+                acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(w + i + 8), acc1);
+            }
+            if (i + 8 <= n) {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(w + i), acc0);
+                i += 8;
+            }
+            acc0 = _mm256_add_ps(acc0, acc1);
+            __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+            half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+            float sum = bias + _mm_cvtss_f32(_mm_add_ss(half, _mm_movehdup_ps(half)));
+            for (; i < n; ++i) {
+                sum += x[i] * w[i];
+            }
+            out[r] = (sum >= 0) ? 1 : 0;
+        }
+    }
+
+    // GCC 12 builds _mm512_reduce_add_pd/ps on _mm256_undefined_pd(), which initializes a
+    // variable with itself on purpose, and -Wmaybe-uninitialized flags it once inlined. The
+    // undefined half is never read, so the warning is silenced for these two wrappers only.
+#if !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+    __attribute__((target("avx512f")))
+    static double reduce_add(__m512d v) {
+        return _mm512_reduce_add_pd(v);
+    }
+
+    __attribute__((target("avx512f")))
+    static float reduce_add(__m512 v) {
+        return _mm512_reduce_add_ps(v);
+    }
+#if !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+    // The AVX-512 kernels finish each row with a masked load instead of a scalar tail.
+    __attribute__((target("avx512f")))
+    static void predict_rows_avx512(const double* x, size_t rows, size_t n, const double* w, double bias, int* out) {
+        for (size_t r = 0; r < rows; ++r, x += n) {
+            __m512d acc0 = _mm512_setzero_pd();
+            __m512d acc1 = _mm512_setzero_pd();
+            size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(w + i), acc0);
+                acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(w + i + 8), acc1);
+            }
+            for (; i < n; i += 8) {
+                const __mmask8 mask = (n - i >= 8) ? __mmask8(0xFF) : static_cast<__mmask8>((1u << (n - i)) - 1);
+                acc0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, w + i), acc0);
+            }
+            out[r] = (bias + reduce_add(_mm512_add_pd(acc0, acc1)) >= 0) ? 1 : 0;
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    static void predict_rows_avx512(const float* x, size_t rows, size_t n, const float* w, float bias, int* out) {
+        for (size_t r = 0; r < rows; ++r, x += n) {
+            __m512 acc0 = _mm512_setzero_ps();
+            __m512 acc1 = _mm512_setzero_ps();
+            size_t i = 0;
+            for (; i + 32 <= n; i += 32) {
+                acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(w + i), acc0);
+                acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 16), _mm512_loadu_ps(w + i + 16), acc1);
+            }
+            for (; i < n; i += 16) {
+                const __mmask16 mask = (n - i >= 16) ? __mmask16(0xFFFF) : static_cast<__mmask16>((1u << (n - i)) - 1);
+                acc0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, x + i), _mm512_maskz_loadu_ps(mask, w + i), acc0);
+            }
+            out[r] = (bias + reduce_add(_mm512_add_ps(acc0, acc1)) >= 0) ? 1 : 0;
+        }
+    }
+#endif
+
+    // Runs the widest kernel simd_level allows, as long as rows are long enough to fill its
+    // registers twice; below that the horizontal sum per row costs more than it saves.
+    template <typename T>
+    static void predict_rows(const T* x, size_t rows, size_t n, const T* w, T bias, int* out) {
+#if PERCEPTRON_X86_SIMD
+        constexpr size_t avx2_lanes = 32 / sizeof(T);
+        if (simd_level >= 2 && n >= 4 * avx2_lanes) {
+            predict_rows_avx512(x, rows, n, w, bias, out);
+            return;
+        }
+        if (simd_level >= 1 && n >= 2 * avx2_lanes) {
+            predict_rows_avx2(x, rows, n, w, bias, out);
+            return;
+        }
+#endif
+        predict_rows_scalar(x, rows, n, w, bias, out);
+    }
+
+public:
+    /**
+     * @brief Widest batch predict kernel to use: 2 = AVX-512, 1 = AVX2 with FMA, 0 = portable.
+     *
+     * Starts at the best the CPU supports; lowering it selects a narrower kernel, which is
+     * how the benchmarks compare them.
+     */
+    static inline int simd_level = detect_simd_level();
+
+    /**
+     * @brief Constructor for the Perceptron class.
+     * @param num_inputs The number of input features the perceptron will have.
+     * @param lr The learning rate for training. Defaults to 0.01.
+     *
+     * Initializes the perceptron with a specific number of inputs.
+     * Weights are initialized to small random values to break symmetry,
+     * and the bias is also initialized randomly.
+     */
+    Perceptron(int num_inputs, double lr = 0.01) : learning_rate(lr) {
+        // Setup for random number generation
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<> dis(0.0, 1.0);
+
+        // Initialize weights with small random numbers
+        for (int i = 0; i < num_inputs; ++i) {
+            weights.push_back(dis(gen));
+        }
+        // Initialize bias with a small random number
+        bias = dis(gen);
+        weights_f32.assign(weights.begin(), weights.end());
+    }
+
+    /**
+     * @brief Predicts the output for a given set of inputs.
+     * @param inputs A vector of input values.
+     * @return The predicted output (0 or 1).
+     *
+     * This method calculates the weighted sum of the inputs, adds the bias,
+     * and then passes the result through the activation function to get the final prediction.
+     */
+    int predict(const std::vector<double>& inputs) {
+        // Ensure the number of inputs matches the number of weights
+        if (inputs.size() != weights.size()) {
+            std::cerr << "Error: Number of inputs must match number of weights." << std::endl;
+            return -1; // Indicate an error
+        }
+
+        // Calculate the weighted sum using std::inner_product for efficiency and clarity.
+        // It computes: (inputs[0]*weights[0] + inputs[1]*weights[1] + ...)
+        double weighted_sum = std::inner_product(inputs.begin(), inputs.end(), weights.begin(), 0.0);
+        
+        // Pass the weighted sum plus bias to the activation function
+        return step_function(weighted_sum + bias);
+    }
+
+    /**
+     * @brief Predicts the outputs for a batch of samples stored as one matrix.
+     * @param features Row-major matrix of rows rows with num_inputs() values each.
+     * @param rows Number of samples in the batch.
+     * @param out Receives the predicted output (0 or 1) of each sample; room for rows values.
+     *
+     * The hot-path counterpart of predict(): no allocation, no size checks and no I/O, with
+     * the dot products done by the widest vector kernel the CPU supports (see simd_level).
+     * The buffers are the caller's responsibility.
+     */
+    void predict_batch(const double* features, size_t rows, int* out) const {
+        predict_rows(features, rows, weights.size(), weights.data(), bias, out);
+    }
+
+    /**
+     * @brief Single-precision predict_batch.
+     *
+     * Reads float features against a float copy of the weights, which halves the memory
+     * traffic per sample and doubles the lanes per instruction. Samples whose weighted sum
+     * is within float rounding of zero may be classified differently from predict().
+     */
+    void predict_batch(const float* features, size_t rows, int* out) const {
+        predict_rows(features, rows, weights_f32.size(), weights_f32.data(), static_cast<float>(bias), out);
+    }
+
+    /**
+     * @brief Trains the perceptron on a single data sample.
+     * @param inputs The vector of input values for the training sample.
+     * @param target The correct output (0 or 1) for the given inputs.
+     *
+     * This is the core of the learning algorithm. It makes a prediction,
+     * calculates the error, and then adjusts the weights and bias to reduce
+     * that error in the future.
+     */
+    void train(const std::vector<double>& inputs, int target) {
+        int prediction = predict(inputs);
+        
+        // Calculate the error: (correct_answer - our_prediction)
+        double error = target - prediction;
+
+        // The Perceptron Learning Rule:
+        // Update each weight based on the error.
+        // If the error is 0, no changes are made.
+        // If the error is non-zero, the weights are "nudged" in the direction
+        // that would have reduced the error.
+        for (size_t i = 0; i < weights.size(); ++i) {
+            weights[i] += learning_rate * error * inputs[i];
+            weights_f32[i] = static_cast<float>(weights[i]);
+        }
+
+        // Update the bias as well.
+        bias += learning_rate * error;
+    }
+
+    /**
+     * @brief Trains on one mini-batch of rows from a contiguous feature matrix.
+     * @param features Row-major matrix with num_inputs() values per row.
+     * @param targets The correct output (0 or 1) for each row of the matrix.
+     * @param rows Indices of the rows that make up the batch.
+     * @param count Number of indices in rows.
+     *
+     * Every row in the batch is scored with the weights as they were when the batch
+     * started; the updates the perceptron rule asks for are summed and applied once at
+     * the end. A batch of one row is therefore exactly train(). Indexing through rows
+     * lets callers shuffle the dataset without moving any feature data.
+     */
+    void train_batch(const double* features, const int* targets, const size_t* rows, size_t count) {
+        const size_t num_inputs = weights.size();
+        weight_updates.assign(num_inputs, 0.0);
+        double bias_update = 0.0;
+
+        for (size_t k = 0; k < count; ++k) {
+            const double* row = features + rows[k] * num_inputs;
+            const double error = targets[rows[k]] - step_function(activation(row));
+            if (error == 0) {
+                continue; // Correctly classified rows contribute nothing.
+            }
+            for (size_t i = 0; i < num_inputs; ++i) {
+                weight_updates[i] += error * row[i];
+            }
+            bias_update += error;
+        }
+
+        for (size_t i = 0; i < num_inputs; ++i) {
+            weights[i] += learning_rate * weight_updates[i];
+            weights_f32[i] = static_cast<float>(weights[i]);
+        }
+        bias += learning_rate * bias_update;
+    }
+
+    /**
+     * @brief Runs one epoch of mini-batch training over a contiguous dataset.
+     * @param features Row-major matrix of num_rows rows with num_inputs() values each.
+     * @param targets The correct output (0 or 1) for each of the num_rows rows.
+     * @param num_rows Number of rows in the dataset.
+     * @param batch_size Number of rows per weight update; 1 gives classic online training.
+     * @param gen Random generator used to shuffle the row order for this epoch.
+     *
+     * Only the index array is shuffled, so the feature matrix is read in place and the
+     * epoch allocates nothing once the scratch buffers have reached the dataset size.
+     */
+    template <typename Generator>
+    void train_epoch(const double* features, const int* targets, size_t num_rows, size_t batch_size, Generator& gen) {
+        sample_order.resize(num_rows);
+        std::iota(sample_order.begin(), sample_order.end(), size_t{0});
+        std::shuffle(sample_order.begin(), sample_order.end(), gen);
+
+        batch_size = std::max<size_t>(batch_size, 1);
+        for (size_t start = 0; start < num_rows; start += batch_size) {
+            train_batch(features, targets, sample_order.data() + start, std::min(batch_size, num_rows - start));
+        }
+    }
+
+    /**
+     * @brief Trains on a contiguous dataset with several threads and no locks (Hogwild).
+     * @param features Row-major matrix of num_rows rows with num_inputs() values each.
+     * @param targets The correct output (0 or 1) for each of the num_rows rows.
+     * @param num_rows Number of rows in the dataset.
+     * @param epochs Number of passes each thread makes over its shard.
+     * @param num_threads Number of worker threads; 0 or 1 trains on the calling thread.
+     * @param seed Seeds the per-thread generators that shuffle each shard every epoch.
+     *
+     * The rows are split into one contiguous shard per thread. Every thread runs the
+     * ordinary perceptron rule over its own shard against one shared set of weights,
+     * without any locking: a thread may read weights halfway through another thread's
+     * update, and concurrent updates to the same weight may overwrite each other. For
+     * perceptron-style learning those lost and stale updates are rare and harmless, and
+     * they cost far less than synchronizing would. The shared weights are atomics accessed
+     * with relaxed loads and stores, which compile to plain moves but keep the races
+     * well-defined. The threads are not synchronized between epochs either.
+     */
+    void train_hogwild(const double* features, const int* targets, size_t num_rows, int epochs, unsigned num_threads,
+                       unsigned seed = 0) {
+        const size_t n = weights.size();
+        // Slot n holds the bias
+        std::unique_ptr<std::atomic<double>[]> shared(new std::atomic<double>[n + 1]);
+        for (size_t i = 0; i < n; ++i) {
+            shared[i].store(weights[i], std::memory_order_relaxed);
+        }
+        shared[n].store(bias, std::memory_order_relaxed);
+
+        auto worker = [&](size_t begin, size_t end, unsigned thread_seed) {
+            std::vector<size_t> order(end - begin);
+            std::iota(order.begin(), order.end(), begin);
+            std::mt19937 gen(thread_seed);
+            for (int epoch = 0; epoch < epochs; ++epoch) {
+                std::shuffle(order.begin(), order.end(), gen);
+                for (size_t r : order) {
+                    const double* row = features + r * n;
+                    double sum = shared[n].load(std::memory_order_relaxed);
+                    for (size_t i = 0; i < n; ++i) {
+                        sum += row[i] * shared[i].load(std::memory_order_relaxed);
+                    }
+                    const double error = targets[r] - step_function(sum);
+                    if (error == 0) {
+                        continue;
+                    }
+                    for (size_t i = 0; i < n; ++i) {
+                        const double w = shared[i].load(std::memory_order_relaxed);
+                        shared[i].store(w + learning_rate * error * row[i], std::memory_order_relaxed);
+                    }
+                    const double b = shared[n].load(std::memory_order_relaxed);
+                    shared[n].store(b + learning_rate * error, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        num_threads = std::max(1u, num_threads);
+        std::vector<std::thread> threads;
+        for (unsigned t = 1; t < num_threads; ++t) {
+            threads.emplace_back(worker, num_rows * t / num_threads, num_rows * (t + 1) / num_threads, seed + t);
+        }
+        worker(0, num_rows / num_threads, seed); // The calling thread takes the first shard
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            weights[i] = shared[i].load(std::memory_order_relaxed);
+            weights_f32[i] = static_cast<float>(weights[i]);
+        }
+        bias = shared[n].load(std::memory_order_relaxed);
+    }
+
+    // Read-only access to the learned parameters, e.g. for quantizing the model.
+    const std::vector<double>& get_weights() const {
+        return weights;
+    }
+
+    double get_bias() const {
+        return bias;
+    }
+
+    // The number of input features the perceptron expects.
+    size_t num_inputs() const {
+        return weights.size();
+    }
+
+    // A helper function to print the current weights and bias
+    void print_weights() {
+        std::cout << "Weights: [ ";
+        for (double w : weights) {
+            std::cout << w << " ";
+        }
+        std::cout << "], Bias: " << bias << std::endl;
+    }
+};
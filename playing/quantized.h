@@ -0,0 +1,492 @@
+#pragma once
+
+#include <algorithm> // For std::max and std::min
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mlp.h"
+#include "perceptron.h"
+
+// The AVX2 and VNNI dot-product kernels are compiled with target attributes and only called
+// when the CPU reports support for them at run time
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define INT8_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define INT8_X86_SIMD 0
+#endif
+
+/**
+ * @class Int8Dot
+ * @brief Integer dot products between rows of int8 matrices, accumulated in int32.
+ *
+ * Values are symmetric int8 in [-127, 127]. The x86 instructions multiply an unsigned
+ * byte by a signed one. The AVX2 kernel feeds maddubs |x| and w carrying the sign of x,
+ * which has the same product; with |x|, |w| <= 127 a pair of products is at most 32258,
+ * so its 16-bit pair sums cannot saturate. VNNI's dpbusd sums straight into 32 bits, so
+ * that kernel can use the cheaper zero-point form described at tile_vnni.
+ */
+class Int8Dot {
+private:
+    /**
+     * @brief Picks the widest kernel this CPU can run.
+     * @return 2 for AVX-512 VNNI (on 256-bit vectors), 1 for AVX2, 0 for the portable loop.
+     */
+    static int detect_simd_level() {
+#if INT8_X86_SIMD
+        if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512vl")) {
+            return 2;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return 1;
+        }
+#endif
+        return 0;
+    }
+
+    static int32_t dot_scalar(const int8_t* x, const int8_t* w, size_t n) {
+        int32_t sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += int32_t{x[i]} * int32_t{w[i]};
+        }
+        return sum;
+    }
+
+    // out[r * cols + j] = x row r . w row j, for a row-major rows x n matrix x and a
+    // row-major cols x n matrix w
+    static void dot_rows_scalar(const int8_t* x, size_t rows, const int8_t* w, size_t cols, size_t n, int32_t* out) {
+        for (size_t r = 0; r < rows; ++r) {
+            for (size_t j = 0; j < cols; ++j) {
+                out[r * cols + j] = dot_scalar(x + r * n, w + j * n, n);
+            }
+        }
+    }
+
+#if INT8_X86_SIMD
+    __attribute__((target("avx2")))
+    static int32_t horizontal_sum(__m256i v) {
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(s);
+    }
+
+    // The four sums of a tile row's accumulators, reduced together
+    __attribute__((target("avx2")))
+    static __m128i horizontal_sums(const __m256i acc[4]) {
+        const __m256i pairs = _mm256_hadd_epi32(_mm256_hadd_epi32(acc[0], acc[1]), _mm256_hadd_epi32(acc[2], acc[3]));
+        return _mm_add_epi32(_mm256_castsi256_si128(pairs), _mm256_extracti128_si256(pairs, 1));
+    }
+
+    // The x86 kernels work on tiles of TILE_ROWS rows of x by 4 rows of w, so every x load
+    // and every w load feeds several multiply-add chains and the horizontal sums are shared.
+    // The tile loops are unrolled explicitly so the accumulators stay in registers at -O2.
+    // Leftover rows of w go one at a time; the bytes past the last 32-byte step are added
+    // by dot_scalar.
+    static constexpr size_t TILE_ROWS = 2;
+
+    // AVX2 multiplies |x| by w carrying the sign of x (see the class comment)
+    template <size_t R>
+    __attribute__((target("avx2")))
+    static void tile_avx2(const int8_t* x, size_t n, const int8_t* w, int32_t* out, size_t cols) {
+        const __m256i ones = _mm256_set1_epi16(1);
+        const size_t vector_end = n / 32 * 32;
+        __m256i acc[R][4];
+        #pragma GCC unroll 4
+        for (size_t r = 0; r < R; ++r) {
+            #pragma GCC unroll 4
+            for (size_t k = 0; k < 4; ++k) {
+                acc[r][k] = _mm256_setzero_si256();
+            }
+        }
+        for (size_t i = 0; i < vector_end; i += 32) {
+            __m256i wv[4];
+            #pragma GCC unroll 4
+            for (size_t k = 0; k < 4; ++k) {
+                wv[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + k * n + i));
+            }
+            #pragma GCC unroll 4
+            for (size_t r = 0; r < R; ++r) {
+                const __m256i xv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + r * n + i));
+                const __m256i ax = _mm256_abs_epi8(xv);
+                #pragma GCC unroll 4
+                for (size_t k = 0; k < 4; ++k) {
+                    const __m256i pairs = _mm256_maddubs_epi16(ax, _mm256_sign_epi8(wv[k], xv));
+                    acc[r][k] = _mm256_add_epi32(acc[r][k], _mm256_madd_epi16(pairs, ones));
+                }
+            }
+        }
+        #pragma GCC unroll 4
+        for (size_t r = 0; r < R; ++r) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + r * cols), horizontal_sums(acc[r]));
+            if (vector_end < n) {
+                #pragma GCC unroll 4
+                for (size_t k = 0; k < 4; ++k) {
+                    out[r * cols + k] += dot_scalar(x + r * n + vector_end, w + k * n + vector_end, n - vector_end);
+                }
+            }
+        }
+    }
+
+    __attribute__((target("avx2")))
+    static int32_t dot_avx2(const int8_t* x, const int8_t* w, size_t n) {
+        const __m256i ones = _mm256_set1_epi16(1);
+        __m256i acc0 = _mm256_setzero_si256();
+        __m256i acc1 = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 64 <= n; i += 64) {
+            const __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+            const __m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i + 32));
+            const __m256i w0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+            const __m256i w1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i + 32));
+            acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_maddubs_epi16(_mm256_abs_epi8(x0), _mm256_sign_epi8(w0, x0)), ones));
+            acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_maddubs_epi16(_mm256_abs_epi8(x1), _mm256_sign_epi8(w1, x1)), ones));
+        }
+        if (i + 32 <= n) {
+            const __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+            const __m256i w0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+            acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_maddubs_epi16(_mm256_abs_epi8(x0), _mm256_sign_epi8(w0, x0)), ones));
+            i += 32;
+        }
+        return horizontal_sum(_mm256_add_epi32(acc0, acc1)) + dot_scalar(x + i, w + i, n - i);
+    }
+
+    // VNNI multiplies without saturating, so it takes x as unsigned bytes x + 128 (a sign-bit
+    // flip) and subtracts 128 * sum(w) afterwards: one load and one dpbusd per 32 bytes.
+    // offsets[k] holds 128 * the sum of w row k over the vector part of the row.
+    template <size_t R>
+    __attribute__((target("avx2,avx512vnni,avx512vl")))
+    static void tile_vnni(const int8_t* x, size_t n, const int8_t* w, const int32_t* offsets, int32_t* out,
+                          size_t cols) {
+        const __m256i flip = _mm256_set1_epi8(static_cast<char>(0x80));
+        const size_t vector_end = n / 32 * 32;
+        __m256i acc[R][4];
+        #pragma GCC unroll 4
+        for (size_t r = 0; r < R; ++r) {
+            #pragma GCC unroll 4
+            for (size_t k = 0; k < 4; ++k) {
+                acc[r][k] = _mm256_setzero_si256();
+            }
+        }
+        for (size_t i = 0; i < vector_end; i += 32) {
+            __m256i wv[4];
+            #pragma GCC unroll 4
+            for (size_t k = 0; k < 4; ++k) {
+                wv[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + k * n + i));
+            }
+            #pragma GCC unroll 4
+            for (size_t r = 0; r < R; ++r) {
+                const __m256i xu = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + r * n + i)), flip);
+                #pragma GCC unroll 4
+                for (size_t k = 0; k < 4; ++k) {
+                    acc[r][k] = _mm256_dpbusd_epi32(acc[r][k], xu, wv[k]);
+                }
+            }
+        }
+        const __m128i offset = _mm_loadu_si128(reinterpret_cast<const __m128i*>(offsets));
+        #pragma GCC unroll 4
+        for (size_t r = 0; r < R; ++r) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + r * cols), _mm_sub_epi32(horizontal_sums(acc[r]), offset));
+            if (vector_end < n) {
+                #pragma GCC unroll 4
+                for (size_t k = 0; k < 4; ++k) {
+                    out[r * cols + k] += dot_scalar(x + r * n + vector_end, w + k * n + vector_end, n - vector_end);
+                }
+            }
+        }
+    }
+
+    __attribute__((target("avx2,avx512vnni,avx512vl")))
+    static int32_t dot_vnni(const int8_t* x, const int8_t* w, size_t n) {
+        __m256i acc0 = _mm256_setzero_si256();
+        __m256i acc1 = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 64 <= n; i += 64) {
+            const __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+            const __m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i + 32));
+            const __m256i w0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+            const __m256i w1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i + 32));
+            acc0 = _mm256_dpbusd_epi32(acc0, _mm256_abs_epi8(x0), _mm256_sign_epi8(w0, x0));
+            acc1 = _mm256_dpbusd_epi32(acc1, _mm256_abs_epi8(x1), _mm256_sign_epi8(w1, x1));
+        }
+        if (i + 32 <= n) {
+            const __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+            const __m256i w0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+            acc0 = _mm256_dpbusd_epi32(acc0, _mm256_abs_epi8(x0), _mm256_sign_epi8(w0, x0));
+            i += 32;
+        }
+        return horizontal_sum(_mm256_add_epi32(acc0, acc1)) + dot_scalar(x + i, w + i, n - i);
+    }
+
+    // Walks out in tiles: TILE_ROWS x 4, then single leftover rows of x by 4, then the
+    // leftover rows of w one dot product at a time
+    template <bool Vnni>
+    static void dot_rows_tiled(const int8_t* x, size_t rows, const int8_t* w, size_t cols, size_t n, int32_t* out) {
+        thread_local std::vector<int32_t> offsets;
+        if (Vnni) {
+            const size_t vector_end = n / 32 * 32;
+            offsets.resize(cols);
+            for (size_t j = 0; j < cols; ++j) {
+                int32_t sum = 0;
+                for (size_t i = 0; i < vector_end; ++i) {
+                    sum += w[j * n + i];
+                }
+                offsets[j] = 128 * sum;
+            }
+        }
+        const size_t tiled_cols = cols / 4 * 4;
+        size_t r = 0;
+        for (; r + TILE_ROWS <= rows; r += TILE_ROWS) {
+            for (size_t j = 0; j < tiled_cols; j += 4) {
+                if (Vnni) {
+                    tile_vnni<TILE_ROWS>(x + r * n, n, w + j * n, offsets.data() + j, out + r * cols + j, cols);
+                } else {
+                    tile_avx2<TILE_ROWS>(x + r * n, n, w + j * n, out + r * cols + j, cols);
+                }
+            }
+        }
+        for (; r < rows; ++r) {
+            for (size_t j = 0; j < tiled_cols; j += 4) {
+                if (Vnni) {
+                    tile_vnni<1>(x + r * n, n, w + j * n, offsets.data() + j, out + r * cols + j, cols);
+                } else {
+                    tile_avx2<1>(x + r * n, n, w + j * n, out + r * cols + j, cols);
+                }
+            }
+        }
+        for (r = 0; r < rows; ++r) {
+            for (size_t j = tiled_cols; j < cols; ++j) {
+                out[r * cols + j] = Vnni ? dot_vnni(x + r * n, w + j * n, n) : dot_avx2(x + r * n, w + j * n, n);
+            }
+        }
+    }
+#endif
+
+public:
+    /**
+     * @brief Widest kernel to use: 2 = VNNI, 1 = AVX2, 0 = portable.
+     *
+     * Starts at the best the CPU supports; lowering it selects a narrower kernel, which is
+     * how the benchmarks compare them.
+     */
+    static inline int simd_level = detect_simd_level();
+
+    /**
+     * @brief out[r * cols + j] = dot(row r of x, row j of w) for every pair of rows.
+     * @param x Row-major rows x n matrix, e.g. quantized samples.
+     * @param w Row-major cols x n matrix, e.g. quantized weights with one row per neuron.
+     * @param out Receives the rows x cols int32 results, row-major.
+     */
+    static void dot_rows(const int8_t* x, size_t rows, const int8_t* w, size_t cols, size_t n, int32_t* out) {
+#if INT8_X86_SIMD
+        if (simd_level >= 2) {
+            dot_rows_tiled<true>(x, rows, w, cols, n, out);
+            return;
+        }
+        if (simd_level >= 1) {
+            dot_rows_tiled<false>(x, rows, w, cols, n, out);
+            return;
+        }
+#endif
+        dot_rows_scalar(x, rows, w, cols, n, out);
+    }
+
+    /**
+     * @brief The scale that maps [-max_abs, max_abs] onto [-127, 127].
+     */
+    static double scale_for(double max_abs) {
+        return max_abs > 0.0 ? max_abs / 127.0 : 1.0;
+    }
+
+    /**
+     * @brief Rounds values[0..count) / scale to int8 (halves away from zero), saturating at +-127.
+     *
+     * Sits between every pair of layers, so it avoids std::nearbyint, a library call per
+     * value, in favour of arithmetic the compiler can vectorize.
+     */
+    static void quantize(const double* values, size_t count, double scale, int8_t* out) {
+        const double inverse = 1.0 / scale;
+        for (size_t i = 0; i < count; ++i) {
+            const double q = std::min(127.0, std::max(-127.0, values[i] * inverse));
+            out[i] = static_cast<int8_t>(static_cast<int>(q + (q >= 0.0 ? 0.5 : -0.5)));
+        }
+    }
+
+    static double max_abs(const double* values, size_t count) {
+        double m = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            m = std::max(m, std::fabs(values[i]));
+        }
+        return m;
+    }
+};
+
+/**
+ * @class QuantizedPerceptron
+ * @brief An int8 copy of a trained Perceptron for scoring.
+ *
+ * Post-training quantization: the weights become int8 with one scale, and the inputs are
+ * expected as int8 too, quantized with a scale fixed from calibration data. A sample then
+ * costs one integer dot product and a multiply by the two scales, and reads one byte per
+ * feature instead of eight.
+ */
+class QuantizedPerceptron {
+private:
+    std::vector<int8_t> weights; // Quantized weights.
+    double weight_scale;         // Real weight = weights[i] * weight_scale.
+    double input_scale;          // Real input = quantized input * input_scale.
+    double bias;                 // Kept in double; it is added once per sample.
+    std::vector<int32_t> sums;   // Scratch for predict_batch's dot products.
+
+public:
+    /**
+     * @brief Quantizes a trained perceptron.
+     * @param model The trained model; it is not modified and may be discarded afterwards.
+     * @param calibration Row-major sample matrix whose largest magnitude sets the input scale.
+     * @param rows Number of calibration samples; representative data, not necessarily labeled.
+     */
+    QuantizedPerceptron(const Perceptron& model, const double* calibration, size_t rows)
+        : weights(model.num_inputs()), bias(model.get_bias()) {
+        const std::vector<double>& w = model.get_weights();
+        weight_scale = Int8Dot::scale_for(Int8Dot::max_abs(w.data(), w.size()));
+        Int8Dot::quantize(w.data(), w.size(), weight_scale, weights.data());
+        input_scale = Int8Dot::scale_for(Int8Dot::max_abs(calibration, rows * w.size()));
+    }
+
+    size_t num_inputs() const { return weights.size(); }
+
+    /**
+     * @brief Converts samples to the int8 inputs predict_batch expects.
+     * @param features Row-major matrix of rows rows with num_inputs() values each.
+     * @param out Receives rows x num_inputs() quantized values; values beyond the
+     *            calibration range saturate.
+     */
+    void quantize_inputs(const double* features, size_t rows, int8_t* out) const {
+        Int8Dot::quantize(features, rows * weights.size(), input_scale, out);
+    }
+
+    /**
+     * @brief Predicts the outputs (0 or 1) of a batch of quantized samples.
+     * @param features Row-major int8 matrix from quantize_inputs.
+     * @param out Receives one prediction per sample.
+     */
+    void predict_batch(const int8_t* features, size_t rows, int* out) {
+        sums.resize(rows);
+        Int8Dot::dot_rows(features, rows, weights.data(), 1, weights.size(), sums.data());
+        const double scale = weight_scale * input_scale;
+        for (size_t r = 0; r < rows; ++r) {
+            out[r] = (sums[r] * scale + bias >= 0) ? 1 : 0;
+        }
+    }
+};
+
+/**
+ * @class QuantizedMLP
+ * @brief An int8 copy of a trained MLP for scoring.
+ *
+ * Weights are quantized per output neuron (per channel), which keeps small neurons from
+ * losing all their precision to one large one. Activations are quantized per layer with
+ * scales calibrated by running representative data through the double-precision model.
+ * Each layer is an int8 matrix product into int32, rescaled to real values, biased and
+ * activated in double, then requantized for the next layer; the output layer's sigmoid
+ * gives probabilities as the MLP does.
+ */
+class QuantizedMLP {
+private:
+    struct Layer {
+        size_t inputs;
+        size_t outputs;
+        MLP::Activation activation;
+        std::vector<int8_t> weights;        // outputs x inputs, one row per neuron.
+        std::vector<double> weight_scales;  // One scale per neuron (row).
+        std::vector<double> bias;
+        double input_scale;                 // Scale of the int8 values this layer reads.
+    };
+
+    std::vector<Layer> layers;
+
+    // Scratch space for predict_batch, kept between calls so scoring does not allocate.
+    std::vector<int32_t> sums;
+    std::vector<double> activations;
+    std::vector<int8_t> quantized[2]; // Ping-pong buffers for the int8 activations between layers.
+
+public:
+    /**
+     * @brief Quantizes a trained MLP.
+     * @param model The trained model; it is used for one calibration forward pass.
+     * @param calibration Row-major sample matrix that sets the input and activation scales.
+     * @param rows Number of calibration samples.
+     */
+    QuantizedMLP(MLP& model, const double* calibration, size_t rows) {
+        std::vector<double> probabilities(rows * model.num_outputs());
+        model.predict_batch(calibration, rows, probabilities.data());
+
+        double input_max = Int8Dot::max_abs(calibration, rows * model.num_inputs());
+        for (size_t l = 0; l < model.num_layers(); ++l) {
+            const std::vector<double>& w = model.layer_weights(l);
+            Layer layer;
+            layer.outputs = model.layer_bias(l).size();
+            layer.inputs = w.size() / layer.outputs;
+            layer.activation = model.layer_activation(l);
+            layer.bias = model.layer_bias(l);
+            layer.input_scale = Int8Dot::scale_for(input_max);
+            layer.weights.resize(w.size());
+            layer.weight_scales.resize(layer.outputs);
+            for (size_t j = 0; j < layer.outputs; ++j) {
+                const double* row = w.data() + j * layer.inputs;
+                layer.weight_scales[j] = Int8Dot::scale_for(Int8Dot::max_abs(row, layer.inputs));
+                Int8Dot::quantize(row, layer.inputs, layer.weight_scales[j], layer.weights.data() + j * layer.inputs);
+            }
+            const std::vector<double>& output = model.layer_output(l);
+            input_max = Int8Dot::max_abs(output.data(), output.size());
+            layers.push_back(std::move(layer));
+        }
+    }
+
+    size_t num_inputs() const { return layers.front().inputs; }
+    size_t num_outputs() const { return layers.back().outputs; }
+
+    /**
+     * @brief Converts samples to the int8 inputs predict_batch expects.
+     * @param features Row-major matrix of rows rows with num_inputs() values each.
+     * @param out Receives rows x num_inputs() quantized values.
+     */
+    void quantize_inputs(const double* features, size_t rows, int8_t* out) const {
+        Int8Dot::quantize(features, rows * num_inputs(), layers.front().input_scale, out);
+    }
+
+    /**
+     * @brief Computes the output probabilities for a batch of quantized samples.
+     * @param features Row-major int8 matrix from quantize_inputs.
+     * @param out Receives rows x num_outputs() probabilities, row-major.
+     */
+    void predict_batch(const int8_t* features, size_t rows, double* out) {
+        const int8_t* in = features;
+        for (size_t l = 0; l < layers.size(); ++l) {
+            const Layer& layer = layers[l];
+            const bool last = (l + 1 == layers.size());
+            sums.resize(rows * layer.outputs);
+            Int8Dot::dot_rows(in, rows, layer.weights.data(), layer.outputs, layer.inputs, sums.data());
+
+            if (!last) {
+                activations.resize(rows * layer.outputs);
+            }
+            double* real = last ? out : activations.data();
+            for (size_t r = 0; r < rows; ++r) {
+                for (size_t j = 0; j < layer.outputs; ++j) {
+                    const size_t k = r * layer.outputs + j;
+                    const double z = sums[k] * layer.input_scale * layer.weight_scales[j] + layer.bias[j];
+                    real[k] = (layer.activation == MLP::Activation::ReLU) ? std::max(z, 0.0) : 1.0 / (1.0 + std::exp(-z));
+                }
+            }
+            if (!last) {
+                std::vector<int8_t>& next = quantized[l % 2];
+                next.resize(rows * layer.outputs);
+                Int8Dot::quantize(real, rows * layer.outputs, layers[l + 1].input_scale, next.data());
+                in = next.data();
+            }
+        }
+    }
+};
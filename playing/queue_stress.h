@@ -0,0 +1,393 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Counts latencies in log-linear buckets: 16 per power of two, so any value is
+ * known to within 1/16 of itself, from nanoseconds to hours, in a fixed 8 KB.
+ *
+ * Each consumer thread fills its own histogram; merge() adds them up afterwards.
+ */
+class LatencyHistogram {
+public:
+    void record(uint64_t nanoseconds) {
+        ++counts[bucket_of(nanoseconds)];
+        ++total;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+    }
+
+    uint64_t count() const {
+        return total;
+    }
+
+    /**
+     * @brief The latency below which a fraction q of the recorded values fall
+     * @param q A fraction in [0, 1], e.g. 0.99 for p99
+     * @return The upper edge of the bucket holding that value, or 0 if nothing was recorded
+     */
+    uint64_t percentile(double q) const {
+        if (total == 0) {
+            return 0;
+        }
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * static_cast<double>(total) + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return upper_edge(i);
+            }
+        }
+        return upper_edge(BUCKETS - 1);
+    }
+
+private:
+    static constexpr int SUB_BITS = 4;
+    static constexpr size_t SUB = size_t{1} << SUB_BITS;
+    static constexpr size_t BUCKETS = 64 * SUB;
+
+    std::array<uint64_t, BUCKETS> counts{};
+    uint64_t total = 0;
+
+    // Values below 16 get a bucket each; above that, the top five significant bits pick one
+    static size_t bucket_of(uint64_t v) {
+        if (v < SUB) {
+            return static_cast<size_t>(v);
+        }
+        const int shift = (63 - __builtin_clzll(v)) - SUB_BITS;
+        return static_cast<size_t>(shift + 1) * SUB + static_cast<size_t>((v >> shift) & (SUB - 1));
+    }
+
+    static uint64_t upper_edge(size_t bucket) {
+        if (bucket < SUB) {
+            return bucket;
+        }
+        const int shift = static_cast<int>(bucket / SUB) - 1;
+        return ((SUB + bucket % SUB + 1) << shift) - 1;
+    }
+};
+
+/**
+ * @brief What run_queue_stress should do
+ */
+struct StressConfig {
+    int producers = 1;
+    int consumers = 1;
+    double seconds = 0.5;            ///< How long the producers keep pushing
+    uint64_t items_per_producer = 1 << 22; ///< Producers also stop after this many elements
+    size_t max_in_flight = 1024;     ///< Producers wait while about this many elements are queued
+    size_t pop_batch = 0;            ///< 0: consumers poll try_pop; N: they block in pop_up_to(out, N)
+};
+
+/**
+ * @brief What run_queue_stress saw. A correct queue has lost, duplicated, corrupted and
+ * reordered all zero.
+ */
+struct StressResult {
+    uint64_t produced = 0;
+    uint64_t consumed = 0;
+    uint64_t lost = 0;       ///< Pushed but never popped intact (corrupted elements count here too)
+    uint64_t duplicated = 0; ///< Popped more than once
+    uint64_t corrupted = 0;  ///< Popped with a payload that does not match its sequence number
+    uint64_t reordered = 0;  ///< Popped before an element its producer pushed earlier, by the same consumer
+    double seconds = 0;      ///< From the first push to the last pop
+    LatencyHistogram latency; ///< Enqueue-to-dequeue time of every element, in nanoseconds
+
+    double throughput() const {
+        return seconds > 0 ? static_cast<double>(consumed) / seconds : 0;
+    }
+
+    bool ok() const {
+        return lost == 0 && duplicated == 0 && corrupted == 0 && reordered == 0 && consumed == produced;
+    }
+};
+
+/**
+ * @brief The element the harness pushes: who produced it, when, and PayloadBytes of data
+ * filled with a byte derived from the sequence number so torn copies show up
+ */
+template<size_t PayloadBytes>
+struct StressElement {
+    uint64_t sequence = 0; ///< Producer id in the top 24 bits, its running index below
+    int64_t enqueued_ns = 0;
+    std::array<unsigned char, PayloadBytes> payload{};
+
+    static unsigned char fill_byte(uint64_t sequence) {
+        return static_cast<unsigned char>(sequence * 0x9Du + (sequence >> 40));
+    }
+
+    void fill() {
+        if constexpr (PayloadBytes > 0) {
+            std::memset(payload.data(), fill_byte(sequence), PayloadBytes);
+        }
+    }
+
+    // Checks every byte, so a copy that mixed two elements or caught one half-written
+    // fails wherever the two halves meet
+    bool intact() const {
+        const unsigned char expected = fill_byte(sequence);
+        return std::all_of(payload.begin(), payload.end(), [expected](unsigned char b) { return b == expected; });
+    }
+};
+
+namespace queue_stress_detail {
+
+constexpr int PRODUCER_SHIFT = 40;
+
+inline int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// The running totals producers and consumers publish every FLUSH elements so producers can
+// bound how much is queued without touching a shared counter per element
+constexpr uint64_t FLUSH = 64;
+
+struct alignas(64) SharedCounter {
+    std::atomic<uint64_t> value{0};
+};
+
+// Whether Queue has the blocking, closable batch interface of ThreadSafeQueue
+template<typename Queue, typename Element, typename = void>
+struct has_batched_pop : std::false_type {};
+
+template<typename Queue, typename Element>
+struct has_batched_pop<Queue, Element,
+                       std::void_t<decltype(std::declval<Queue&>().pop_up_to(std::declval<std::vector<Element>&>(),
+                                                                              size_t{})),
+                                   decltype(std::declval<Queue&>().close())>> : std::true_type {};
+
+} // namespace queue_stress_detail
+
+/**
+ * @brief Runs producers and consumers against one queue and checks and times every element
+ *
+ * Any queue with `push(Element)` (waiting while full, if it is bounded) and a non-blocking
+ * `bool try_pop(Element&)` can be measured: ThreadSafeQueue, BoundedMpmcQueue and, with one
+ * producer and one consumer, SpscQueue. By default consumers poll with try_pop and yield
+ * when it fails, so blocking and lock-free queues are driven the same way.
+ *
+ * With config.pop_batch set, consumers instead block in `pop_up_to(out, pop_batch)` and
+ * the harness calls `close()` once the producers are done, which is how an ingest pipeline
+ * drains a ThreadSafeQueue. Only queues with that interface accept the option.
+ *
+ * Each producer stamps an element, fills its payload and pushes it, until the time is up
+ * or it has pushed items_per_producer elements. Each consumer records the latency of
+ * every element it pops and marks it in a per-producer bitmap; a bit that is already set
+ * is a duplicate and a bit never set is a lost element. The bitmap costs one bit per
+ * element and one atomic OR, the same for every queue.
+ *
+ * Producers also hold back while about max_in_flight elements are queued. A bounded queue
+ * does that by itself; for an unbounded one it keeps the latency about the queue rather
+ * than about a backlog that grows for the whole run.
+ *
+ * @param queue An empty queue; it is empty again afterwards, and closed if pop_batch is set
+ * @param config Thread counts, duration and limits
+ * @throws std::invalid_argument if there are no producers or consumers, more producers than
+ *         the element tag can number, or a pop_batch for a queue without pop_up_to and close
+ */
+template<size_t PayloadBytes, typename Queue>
+StressResult run_queue_stress(Queue& queue, const StressConfig& config) {
+    using namespace queue_stress_detail;
+    using Element = StressElement<PayloadBytes>;
+    constexpr bool batched_pop = has_batched_pop<Queue, Element>::value;
+    if (config.producers < 1 || config.consumers < 1) {
+        throw std::invalid_argument("run_queue_stress needs at least one producer and one consumer");
+    }
+    // The producer id lives in the bits of the sequence above PRODUCER_SHIFT
+    if (config.producers >= (1 << (64 - PRODUCER_SHIFT - 1))) {
+        throw std::invalid_argument("run_queue_stress takes fewer than " +
+                                    std::to_string(1 << (64 - PRODUCER_SHIFT - 1)) + " producers");
+    }
+    if (config.pop_batch > 0 && !batched_pop) {
+        throw std::invalid_argument("pop_batch needs a queue with pop_up_to and close");
+    }
+    const uint64_t items = std::min<uint64_t>(config.items_per_producer, uint64_t{1} << PRODUCER_SHIFT);
+    const size_t words = static_cast<size_t>((items + 63) / 64);
+
+    std::vector<std::unique_ptr<std::atomic<uint64_t>[]>> seen(config.producers);
+    for (auto& bits : seen) {
+        bits.reset(new std::atomic<uint64_t>[words]);
+        for (size_t w = 0; w < words; ++w) {
+            bits[w].store(0, std::memory_order_relaxed);
+        }
+    }
+    std::vector<uint64_t> produced(config.producers, 0);
+    SharedCounter pushed_total, popped_total;
+    std::atomic<bool> producers_done(false);
+
+    // Aligned so consumers updating their own counters do not share cache lines
+    struct alignas(64) ConsumerState {
+        LatencyHistogram latency;
+        uint64_t consumed = 0, duplicated = 0, corrupted = 0, reordered = 0;
+        int64_t last_pop_ns = 0;
+    };
+    std::vector<ConsumerState> consumers(config.consumers);
+
+    // Both running totals lag the truth by up to FLUSH per thread, so the throttle allows
+    // that much on top of max_in_flight
+    const uint64_t in_flight_limit =
+        config.max_in_flight + static_cast<uint64_t>(config.producers + config.consumers) * FLUSH;
+
+    const int64_t start = now_ns();
+    const int64_t deadline = start + static_cast<int64_t>(config.seconds * 1e9);
+
+    std::vector<std::thread> threads;
+    for (int c = 0; c < config.consumers; ++c) {
+        threads.emplace_back([&, c] {
+            ConsumerState& state = consumers[c];
+            std::vector<int64_t> last_index(config.producers, -1);
+            uint64_t unflushed = 0;
+            auto consume = [&](const Element& element, int64_t popped_at) {
+                state.latency.record(static_cast<uint64_t>(std::max<int64_t>(0, popped_at - element.enqueued_ns)));
+                state.last_pop_ns = popped_at;
+                ++state.consumed;
+
+                const uint64_t producer = element.sequence >> PRODUCER_SHIFT;
+                const uint64_t index = element.sequence & ((uint64_t{1} << PRODUCER_SHIFT) - 1);
+                if (producer >= static_cast<uint64_t>(config.producers) || index >= items || !element.intact()) {
+                    ++state.corrupted;
+                } else {
+                    const uint64_t bit = uint64_t{1} << (index % 64);
+                    if (seen[producer][index / 64].fetch_or(bit, std::memory_order_relaxed) & bit) {
+                        ++state.duplicated;
+                    }
+                    if (static_cast<int64_t>(index) < last_index[producer]) {
+                        ++state.reordered;
+                    }
+                    last_index[producer] = std::max(last_index[producer], static_cast<int64_t>(index));
+                }
+                ++unflushed;
+            };
+
+            if constexpr (batched_pop) {
+                if (config.pop_batch > 0) {
+                    // pop_up_to waits for the first element and returns 0 only once the queue
+                    // is closed and drained. The count is published after every batch, since
+                    // the next call may block.
+                    std::vector<Element> batch;
+                    batch.reserve(config.pop_batch);
+                    while (queue.pop_up_to(batch, config.pop_batch) > 0) {
+                        const int64_t popped_at = now_ns();
+                        for (const Element& element : batch) {
+                            consume(element, popped_at);
+                        }
+                        batch.clear();
+                        popped_total.value.fetch_add(unflushed, std::memory_order_relaxed);
+                        unflushed = 0;
+                    }
+                    return;
+                }
+            }
+
+            Element element;
+            for (;;) {
+                if (!queue.try_pop(element)) {
+                    // Publish what we have popped before waiting: producers throttle on
+                    // popped_total and would otherwise wait on pops only we know about
+                    if (unflushed > 0) {
+                        popped_total.value.fetch_add(unflushed, std::memory_order_relaxed);
+                        unflushed = 0;
+                    }
+                    if (!producers_done.load(std::memory_order_acquire)) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    // Every push has happened; one more look tells drained from not yet seen
+                    if (!queue.try_pop(element)) {
+                        break;
+                    }
+                }
+                consume(element, now_ns());
+                if (unflushed == FLUSH) {
+                    popped_total.value.fetch_add(unflushed, std::memory_order_relaxed);
+                    unflushed = 0;
+                }
+            }
+            popped_total.value.fetch_add(unflushed, std::memory_order_relaxed);
+        });
+    }
+    for (int p = 0; p < config.producers; ++p) {
+        threads.emplace_back([&, p] {
+            uint64_t index = 0, unflushed = 0;
+            bool out_of_time = false;
+            while (index < items && !out_of_time) {
+                // Hold back while the queue is deep, but never past the deadline
+                while (pushed_total.value.load(std::memory_order_relaxed) >
+                       popped_total.value.load(std::memory_order_relaxed) + in_flight_limit) {
+                    if (now_ns() >= deadline) {
+                        out_of_time = true;
+                        break;
+                    }
+                    std::this_thread::yield();
+                }
+                if (out_of_time || now_ns() >= deadline) {
+                    break;
+                }
+                Element element;
+                element.sequence = (uint64_t(p) << PRODUCER_SHIFT) | index;
+                element.fill();
+                element.enqueued_ns = now_ns();
+                queue.push(std::move(element));
+                ++index;
+                if (++unflushed == FLUSH) {
+                    pushed_total.value.fetch_add(unflushed, std::memory_order_relaxed);
+                    unflushed = 0;
+                }
+            }
+            pushed_total.value.fetch_add(unflushed, std::memory_order_relaxed);
+            produced[p] = index;
+        });
+    }
+    for (size_t i = config.consumers; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+    producers_done.store(true, std::memory_order_release);
+    if constexpr (batched_pop) {
+        if (config.pop_batch > 0) {
+            queue.close(); // Wakes the consumers blocked in pop_up_to once the queue is drained
+        }
+    }
+    for (int c = 0; c < config.consumers; ++c) {
+        threads[c].join();
+    }
+
+    StressResult result;
+    int64_t end = start;
+    for (const ConsumerState& state : consumers) {
+        result.latency.merge(state.latency);
+        result.consumed += state.consumed;
+        result.duplicated += state.duplicated;
+        result.corrupted += state.corrupted;
+        result.reordered += state.reordered;
+        end = std::max(end, state.last_pop_ns);
+    }
+    for (int p = 0; p < config.producers; ++p) {
+        result.produced += produced[p];
+        for (uint64_t index = 0; index < produced[p]; ++index) {
+            if (!(seen[p][index / 64].load(std::memory_order_relaxed) & (uint64_t{1} << (index % 64)))) {
+                ++result.lost;
+            }
+        }
+    }
+    result.seconds = static_cast<double>(end - start) / 1e9;
+    return result;
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+template<typename T>
+class ThreadSafeQueue {
+private:
+    // The underlying queue data structure
+    std::queue<T> data_queue;
+    
+    // Mutex to protect access to the queue
+    mutable std::mutex mutex;
+    
+    // Condition variable for waiting for data
+    std::condition_variable data_cond;
+    
+    // Set by close(): no more pushes are accepted and waiting consumers give up once the
+    // queue is drained
+    bool closed = false;
+
+public:
+    ThreadSafeQueue() {
+        // No additional initialization needed
+    }
+    
+    // Add an element to the queue
+    // Returns false (and drops the value) if the queue has been closed
+    bool push(T value) {
+        {
+            // Lock the mutex to protect the queue
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed) {
+                return false;
+            }
+        
+            // Add the value to the queue
+            data_queue.push(std::move(value));
+        }
+        
+        // Notify one waiting thread that data is available. Done after unlocking, so the
+        // woken thread does not immediately block on the mutex we still hold
+        data_cond.notify_one();
+        return true;
+    }
+
+    // Add every element of [first, last) under a single lock, moving them out of the range
+    // Returns the number of elements added: all of them, or 0 if the queue has been closed
+    template<typename InputIt>
+    size_t push_bulk(InputIt first, InputIt last) {
+        size_t count = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed) {
+                return 0;
+            }
+            for (; first != last; ++first, ++count) {
+                data_queue.push(std::move(*first));
+            }
+        }
+
+        // One wakeup per batch instead of one per element
+        if (count == 1) {
+            data_cond.notify_one();
+        } else if (count > 1) {
+            data_cond.notify_all();
+        }
+        return count;
+    }
+    
+    // Try to pop an element from the queue
+    // Returns true if successful, false if queue was empty
+    bool try_pop(T& value) {
+        // Lock the mutex to protect the queue
+        std::lock_guard<std::mutex> lock(mutex);
+        
+        // Check if the queue is empty
+        if (data_queue.empty()) {
+            return false;
+        }
+        
+        // Get the value from the front of the queue
+        value = std::move(data_queue.front());
+        data_queue.pop();
+        
+        return true;
+    }
+    
+    // Pop up to max_count elements under a single lock, appending them to out
+    // Returns the number popped, which is 0 if the queue was empty
+    size_t try_pop_bulk(std::vector<T>& out, size_t max_count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return take(out, max_count);
+    }
+
+    // Wait until an element is available and then pop it
+    // Returns false without a value once the queue is closed and empty
+    bool wait_and_pop(T& value) {
+        // Use a unique_lock since we need to unlock it in the wait
+        std::unique_lock<std::mutex> lock(mutex);
+        
+        // Wait until the queue is not empty (or will never be again)
+        // This releases the lock while waiting and reacquires it when notified
+        data_cond.wait(lock, [this]{ return !data_queue.empty() || closed; });
+        if (data_queue.empty()) {
+            return false;
+        }
+        
+        // Get the value from the front of the queue
+        value = std::move(data_queue.front());
+        data_queue.pop();
+        return true;
+    }
+
+    // Like wait_and_pop, but gives up after timeout
+    // Returns false if nothing arrived in time or the queue is closed and empty
+    template<typename Rep, typename Period>
+    bool wait_and_pop_for(T& value, const std::chrono::duration<Rep, Period>& timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!data_cond.wait_for(lock, timeout, [this]{ return !data_queue.empty() || closed; }) ||
+            data_queue.empty()) {
+            return false;
+        }
+        value = std::move(data_queue.front());
+        data_queue.pop();
+        return true;
+    }
+
+    // Wait until at least one element is available, then pop up to max_count of them under
+    // the same lock, appending them to out
+    // Returns the number popped, which is 0 only once the queue is closed and empty, or
+    // straight away if max_count is 0 (there is nothing to wait for)
+    size_t pop_up_to(std::vector<T>& out, size_t max_count) {
+        if (max_count == 0) {
+            return 0;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        data_cond.wait(lock, [this]{ return !data_queue.empty() || closed; });
+        return take(out, max_count);
+    }
+
+    // Stop accepting elements and wake every waiting thread. Elements already queued can
+    // still be popped; after that the waiting pops return empty-handed instead of blocking
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        data_cond.notify_all();
+    }
+
+    // Check if close() has been called
+    bool is_closed() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return closed;
+    }
+    
+    // Check if the queue is empty
+    bool empty() const {
+        // Lock the mutex to protect the queue
+        std::lock_guard<std::mutex> lock(mutex);
+        
+        // Check if the queue is empty
+        return data_queue.empty();
+    }
+
+private:
+    // Moves up to max_count elements from the front of the queue to out; the caller holds
+    // the lock
+    size_t take(std::vector<T>& out, size_t max_count) {
+        size_t count = 0;
+        for (; count < max_count && !data_queue.empty(); ++count) {
+            out.push_back(std::move(data_queue.front()));
+            data_queue.pop();
+        }
+        return count;
+    }
+};
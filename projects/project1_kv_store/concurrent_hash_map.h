@@ -0,0 +1,428 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Control bytes and group probing for an open-addressing table in the Swiss-table style
+ * (the layout of Abseil's flat_hash_map).
+ *
+ * Every slot has one control byte: EMPTY, DELETED (a tombstone), or, for a full slot, the
+ * low 7 bits of its key's hash (h2). Slots are probed 16 at a time: one SIMD compare of a
+ * group's control bytes against h2 yields a bitmask of the few slots whose keys are worth
+ * comparing, and another finds the empty slots that end the probe. Most lookups touch one
+ * group of control bytes and one slot.
+ */
+namespace swiss {
+
+constexpr size_t GROUP = 16;
+constexpr int8_t EMPTY = -128;  // 0b10000000
+constexpr int8_t DELETED = -2;  // 0b11111110; full slots hold 0..127, so only these two have the sign bit
+
+// Bit i is set where group[i] == h2
+inline uint32_t match(const int8_t* group, int8_t h2) {
+#if defined(__SSE2__)
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(h2))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < GROUP; ++i) {
+        mask |= uint32_t(group[i] == h2) << i;
+    }
+    return mask;
+#endif
+}
+
+// Bit i is set where group[i] is EMPTY or DELETED, i.e. has its sign bit set
+inline uint32_t match_free(const int8_t* group) {
+#if defined(__SSE2__)
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < GROUP; ++i) {
+        mask |= uint32_t(group[i] < 0) << i;
+    }
+    return mask;
+#endif
+}
+
+inline uint32_t match_empty(const int8_t* group) {
+    return match(group, EMPTY);
+}
+
+inline int lowest_bit(uint32_t mask) {
+    return __builtin_ctz(mask);
+}
+
+} // namespace swiss
+
+/**
+ * A single-threaded Swiss table; ConcurrentHashMap keeps one per shard, under the shard's lock.
+ *
+ * Hasher maps a key to a well-mixed 64-bit hash. Callers pass the hash in, so it is
+ * computed once per operation; the table only calls Hasher itself when it rehashes.
+ *
+ * The capacity is a power of two and a multiple of the group size. Probing visits whole
+ * groups in triangular order (+1, +2, +3, ... groups), which reaches every group of a
+ * power-of-two table, and stops at the first group with an EMPTY byte.
+ *
+ * The table grows (doubling) when full and deleted slots together pass 7/8 of the
+ * capacity; if tombstones are most of that, it is rebuilt at the same size instead.
+ */
+template<typename Key, typename Value, typename Hasher>
+class SwissTable {
+public:
+    using Entry = std::pair<Key, Value>;
+
+    explicit SwissTable(size_t capacity = swiss::GROUP) {
+        allocate(round_capacity(capacity));
+    }
+
+    ~SwissTable() {
+        destroy_all();
+    }
+
+    SwissTable(const SwissTable&) = delete;
+    SwissTable& operator=(const SwissTable&) = delete;
+
+    size_t size() const {
+        return count;
+    }
+
+    // The entry for key, or nullptr
+    const Entry* find(const Key& key, uint64_t hash) const {
+        const size_t index = find_index(key, hash);
+        return index == NOT_FOUND ? nullptr : slot(index);
+    }
+
+    // Insert key with value, or replace the value if key is present
+    // Returns true if the key was inserted, false if it was already there
+    template<typename V>
+    bool insert_or_assign(const Key& key, V&& value, uint64_t hash) {
+        const size_t existing = find_index(key, hash);
+        if (existing != NOT_FOUND) {
+            slot(existing)->second = std::forward<V>(value);
+            return false;
+        }
+        if ((used + 1) * 8 > capacity * 7) {
+            // When live entries fill less than half the table, the load is mostly
+            // tombstones; rebuilding at the same size clears them
+            rehash(count * 2 < capacity ? capacity : capacity * 2);
+        }
+        const size_t index = find_free(hash);
+        // The slot is only marked full once its entry exists, so a throwing copy leaves the
+        // table as it was
+        new (&slots[index]) Entry(key, std::forward<V>(value));
+        if (ctrl[index] == swiss::EMPTY) {
+            ++used;
+        }
+        ctrl[index] = static_cast<int8_t>(hash & 0x7F);
+        ++count;
+        return true;
+    }
+
+    // Returns true if key was present
+    bool erase(const Key& key, uint64_t hash) {
+        const size_t index = find_index(key, hash);
+        if (index == NOT_FOUND) {
+            return false;
+        }
+        slot(index)->~Entry();
+        --count;
+        // A probe only moves past a group with no EMPTY byte, so if this group already has
+        // one, nothing can be looking beyond it and the slot can go straight back to EMPTY
+        if (swiss::match_empty(&ctrl[index - index % swiss::GROUP]) != 0) {
+            ctrl[index] = swiss::EMPTY;
+            --used;
+        } else {
+            ctrl[index] = swiss::DELETED;
+        }
+        return true;
+    }
+
+private:
+    struct Slot {
+        alignas(Entry) unsigned char storage[sizeof(Entry)];
+    };
+
+    std::unique_ptr<int8_t[]> ctrl;
+    std::unique_ptr<Slot[]> slots;
+    size_t capacity = 0;
+    size_t group_mask = 0;
+    size_t count = 0; // Full slots
+    size_t used = 0;  // Full and DELETED slots: what the load factor counts
+
+    static constexpr size_t NOT_FOUND = ~size_t{0};
+
+    static size_t round_capacity(size_t wanted) {
+        size_t size = swiss::GROUP;
+        while (size < wanted) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    size_t group_of(uint64_t hash) const {
+        return static_cast<size_t>(hash >> 7) & group_mask;
+    }
+
+    Entry* slot(size_t index) const {
+        return std::launder(reinterpret_cast<Entry*>(slots[index].storage));
+    }
+
+    // Both arrays are allocated before either member changes, so a failed allocation
+    // leaves the table as it was
+    void allocate(size_t new_capacity) {
+        std::unique_ptr<int8_t[]> new_ctrl(new int8_t[new_capacity]);
+        std::unique_ptr<Slot[]> new_slots(new Slot[new_capacity]);
+        std::fill(new_ctrl.get(), new_ctrl.get() + new_capacity, swiss::EMPTY);
+        ctrl = std::move(new_ctrl);
+        slots = std::move(new_slots);
+        capacity = new_capacity;
+        group_mask = capacity / swiss::GROUP - 1;
+        count = 0;
+        used = 0;
+    }
+
+    void swap(SwissTable& other) noexcept {
+        std::swap(ctrl, other.ctrl);
+        std::swap(slots, other.slots);
+        std::swap(capacity, other.capacity);
+        std::swap(group_mask, other.group_mask);
+        std::swap(count, other.count);
+        std::swap(used, other.used);
+    }
+
+    size_t find_index(const Key& key, uint64_t hash) const {
+        const int8_t h2 = static_cast<int8_t>(hash & 0x7F);
+        size_t group = group_of(hash);
+        for (size_t step = 1;; ++step) {
+            const int8_t* bytes = &ctrl[group * swiss::GROUP];
+            for (uint32_t candidates = swiss::match(bytes, h2); candidates != 0; candidates &= candidates - 1) {
+                const size_t index = group * swiss::GROUP + swiss::lowest_bit(candidates);
+                if (slot(index)->first == key) {
+                    return index;
+                }
+            }
+            if (swiss::match_empty(bytes) != 0) {
+                return NOT_FOUND;
+            }
+            group = (group + step) & group_mask;
+        }
+    }
+
+    // First EMPTY or DELETED slot on the probe sequence of hash
+    size_t find_free(uint64_t hash) const {
+        size_t group = group_of(hash);
+        for (size_t step = 1;; ++step) {
+            const uint32_t free = swiss::match_free(&ctrl[group * swiss::GROUP]);
+            if (free != 0) {
+                return group * swiss::GROUP + swiss::lowest_bit(free);
+            }
+            group = (group + step) & group_mask;
+        }
+    }
+
+    // Builds the new table next to this one and swaps it in at the end. If the allocation
+    // or a copy throws, this table still holds every entry; entries are moved rather than
+    // copied only when their move constructor cannot throw.
+    void rehash(size_t new_capacity) {
+        SwissTable rebuilt(new_capacity);
+        for (size_t i = 0; i < capacity; ++i) {
+            if (ctrl[i] >= 0) {
+                Entry* entry = slot(i);
+                // The control byte only keeps 7 bits of the hash; the group needs the rest
+                const size_t index = rebuilt.find_free(Hasher{}(entry->first));
+                new (&rebuilt.slots[index]) Entry(std::move_if_noexcept(*entry));
+                rebuilt.ctrl[index] = ctrl[i];
+                ++rebuilt.count;
+                ++rebuilt.used;
+            }
+        }
+        // rebuilt now holds the old arrays, and its destructor destroys the old entries
+        swap(rebuilt);
+    }
+
+    void destroy_all() {
+        if (!ctrl) {
+            return;
+        }
+        for (size_t i = 0; i < capacity; ++i) {
+            if (ctrl[i] >= 0) {
+                slot(i)->~Entry();
+            }
+        }
+    }
+};
+
+/**
+ * A hash map for many threads, striped into shards that each hold a SwissTable behind a
+ * std::shared_mutex.
+ *
+ * The top bits of a key's hash pick its shard, so threads working on different keys
+ * almost always take different locks, and readers of the same shard share its lock.
+ * Every shard sits on its own cache lines, so taking one lock does not slow down threads
+ * using the neighbouring one. With read-mostly traffic the cost of a get is one shared
+ * lock on a lock that few other threads are touching, plus one or two cache lines of table.
+ *
+ * Values are copied out under the lock, so get() never hands out a reference another
+ * thread could change or free. A seqlock would save readers the lock's atomic write, but
+ * optimistic readers copy values that may be mid-update, which is only safe for trivially
+ * copyable values; a store whose values are strings needs the reader lock.
+ *
+ * std::hash is the identity for integers in libstdc++, so hashes are mixed before use: the
+ * shard, the group and the 7-bit control byte all come from different bits of the result.
+ */
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class ConcurrentHashMap {
+private:
+    struct MixedHash {
+        uint64_t operator()(const Key& key) const {
+            uint64_t h = static_cast<uint64_t>(Hash{}(key));
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDull;
+            h ^= h >> 33;
+            h *= 0xC4CEB9FE1A85EC53ull;
+            h ^= h >> 33;
+            return h;
+        }
+    };
+
+    using Table = SwissTable<Key, Value, MixedHash>;
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        Table table;
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    size_t shard_count_;
+    int shard_shift; // 64 - log2(shard count): hash >> shard_shift is the shard index
+
+    Shard& shard_for(uint64_t hash) const {
+        return shards[shard_shift == 64 ? 0 : hash >> shard_shift];
+    }
+
+public:
+    /**
+     * @param shard_count Number of stripes, rounded up to a power of two. More shards mean
+     *        less lock contention; a few times the number of threads is plenty
+     */
+    explicit ConcurrentHashMap(size_t shard_count = 64) {
+        if (shard_count == 0) {
+            throw std::invalid_argument("ConcurrentHashMap needs at least one shard");
+        }
+        size_t count = 1;
+        int bits = 0;
+        while (count < shard_count) {
+            count <<= 1;
+            ++bits;
+        }
+        shards.reset(new Shard[count]);
+        shard_count_ = count;
+        shard_shift = 64 - bits;
+    }
+
+    ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+    ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+    size_t shard_count() const {
+        return shard_count_;
+    }
+
+    // A copy of the value stored for key, if there is one
+    std::optional<Value> get(const Key& key) const {
+        const uint64_t hash = MixedHash{}(key);
+        const Shard& shard = shard_for(hash);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        if (const auto* entry = shard.table.find(key, hash)) {
+            return entry->second;
+        }
+        return std::nullopt;
+    }
+
+    // Store value for key, replacing any value already there
+    // Returns true if the key is new
+    template<typename V>
+    bool put(const Key& key, V&& value) {
+        const uint64_t hash = MixedHash{}(key);
+        Shard& shard = shard_for(hash);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.table.insert_or_assign(key, std::forward<V>(value), hash);
+    }
+
+    // Returns true if key was present
+    bool erase(const Key& key) {
+        const uint64_t hash = MixedHash{}(key);
+        Shard& shard = shard_for(hash);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.table.erase(key, hash);
+    }
+
+    /**
+     * @brief Look up many keys, taking each shard's lock once for all of its keys
+     *
+     * The keys are bucketed by shard first, so a batch of n keys costs one shared lock per
+     * shard it touches instead of n. Each shard's keys are looked up under one lock, which
+     * makes them consistent with each other; keys in different shards are read at
+     * slightly different moments.
+     *
+     * @return One entry per key, in the order of keys
+     */
+    std::vector<std::optional<Value>> multi_get(const std::vector<Key>& keys) const {
+        std::vector<std::optional<Value>> values(keys.size());
+        std::vector<uint64_t> hashes(keys.size());
+        // Counting sort of the key indices by shard
+        std::vector<uint32_t> starts(shard_count_ + 1, 0);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            hashes[i] = MixedHash{}(keys[i]);
+            ++starts[(shard_shift == 64 ? 0 : hashes[i] >> shard_shift) + 1];
+        }
+        for (size_t s = 0; s < shard_count_; ++s) {
+            starts[s + 1] += starts[s];
+        }
+        std::vector<uint32_t> order(keys.size());
+        std::vector<uint32_t> next(starts.begin(), starts.end() - 1);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            order[next[shard_shift == 64 ? 0 : hashes[i] >> shard_shift]++] = static_cast<uint32_t>(i);
+        }
+        for (size_t s = 0; s < shard_count_; ++s) {
+            if (starts[s] == starts[s + 1]) {
+                continue;
+            }
+            const Shard& shard = shards[s];
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            for (uint32_t k = starts[s]; k < starts[s + 1]; ++k) {
+                const uint32_t i = order[k];
+                if (const auto* entry = shard.table.find(keys[i], hashes[i])) {
+                    values[i] = entry->second;
+                }
+            }
+        }
+        return values;
+    }
+
+    // Total number of keys; only a snapshot while other threads write
+    size_t size() const {
+        size_t total = 0;
+        for (size_t s = 0; s < shard_count_; ++s) {
+            std::shared_lock<std::shared_mutex> lock(shards[s].mutex);
+            total += shards[s].table.size();
+        }
+        return total;
+    }
+};
@@ -0,0 +1,201 @@
+// In-memory key-value store engine: a lock-striped Swiss-table hash map
+// (concurrent_hash_map.h), checked against std::unordered_map and benchmarked on a
+// read-mostly mix.
+//
+// Usage: kv_store [--bench [max threads] [seconds per run]]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "concurrent_hash_map.h"
+
+// Random puts, gets, erases and multi_gets over a small key range, so keys are reused,
+// tables grow, tombstones pile up and get cleaned, compared step by step with
+// std::unordered_map. Returns the number of operations that agreed.
+int runDifferentialTest(int operations, size_t shards) {
+    ConcurrentHashMap<uint64_t, std::string> map(shards);
+    std::unordered_map<uint64_t, std::string> reference;
+    std::mt19937_64 rng(7);
+    int matches = 0;
+    for (int op = 0; op < operations; ++op) {
+        const uint64_t key = rng() % 5000;
+        const int kind = static_cast<int>(rng() % 10);
+        bool ok = true;
+        if (kind < 4) {
+            const std::string value = "value-" + std::to_string(rng());
+            const bool inserted = reference.insert_or_assign(key, value).second;
+            ok = map.put(key, value) == inserted;
+        } else if (kind < 7) {
+            ok = map.erase(key) == (reference.erase(key) == 1);
+        } else if (kind < 9) {
+            const auto found = map.get(key);
+            const auto expected = reference.find(key);
+            ok = found.has_value() == (expected != reference.end()) && (!found || *found == expected->second);
+        } else {
+            std::vector<uint64_t> keys(1 + rng() % 64);
+            for (uint64_t& k : keys) {
+                k = rng() % 5000;
+            }
+            const auto found = map.multi_get(keys);
+            for (size_t i = 0; i < keys.size(); ++i) {
+                const auto expected = reference.find(keys[i]);
+                ok = ok && found[i].has_value() == (expected != reference.end()) &&
+                     (!found[i] || *found[i] == expected->second);
+            }
+        }
+        ok = ok && (op % 1000 != 0 || map.size() == reference.size());
+        matches += ok ? 1 : 0;
+    }
+    return matches;
+}
+
+// Writers own disjoint key ranges and put, overwrite and erase in them while readers
+// multi_get across all of them. A value is always its key times 3, plus 1 once overwritten,
+// so a reader can tell a torn or misplaced value. Afterwards every range must hold exactly
+// what its writer left there.
+bool runConcurrentTest(int writers, int readers, uint64_t keys_per_writer) {
+    ConcurrentHashMap<uint64_t, uint64_t> map(16);
+    std::atomic<bool> writing(true), reads_ok(true);
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < writers; ++w) {
+        threads.emplace_back([&map, w, keys_per_writer] {
+            const uint64_t base = w * keys_per_writer;
+            for (uint64_t k = base; k < base + keys_per_writer; ++k) {
+                map.put(k, k * 3);
+            }
+            for (uint64_t k = base; k < base + keys_per_writer; k += 2) {
+                map.put(k, k * 3 + 1);
+            }
+            for (uint64_t k = base; k < base + keys_per_writer; k += 3) {
+                map.erase(k);
+            }
+        });
+    }
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r] {
+            std::mt19937_64 rng(r);
+            std::vector<uint64_t> keys(32);
+            while (writing.load(std::memory_order_relaxed)) {
+                for (uint64_t& k : keys) {
+                    k = rng() % (writers * keys_per_writer);
+                }
+                const auto found = map.multi_get(keys);
+                for (size_t i = 0; i < keys.size(); ++i) {
+                    if (found[i] && (*found[i] / 3 != keys[i] || *found[i] % 3 > 1)) {
+                        reads_ok = false;
+                    }
+                }
+            }
+        });
+    }
+    for (int w = 0; w < writers; ++w) {
+        threads[w].join();
+    }
+    writing = false;
+    for (size_t t = writers; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+
+    bool ok = reads_ok;
+    uint64_t expected_size = 0;
+    for (uint64_t k = 0; k < writers * keys_per_writer && ok; ++k) {
+        const uint64_t offset = k % keys_per_writer;
+        const auto value = map.get(k);
+        if (offset % 3 == 0) {
+            ok = !value;
+        } else {
+            ok = value && *value == k * 3 + (offset % 2 == 0 ? 1 : 0);
+            ++expected_size;
+        }
+    }
+    return ok && map.size() == expected_size;
+}
+
+// Operations per second with `threads` threads doing 90% get / 10% put on random keys of a
+// preloaded map
+double measureMix(ConcurrentHashMap<uint64_t, uint64_t>& map, uint64_t key_count, int threads, double seconds) {
+    std::atomic<bool> running(true);
+    std::atomic<uint64_t> total(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            uint64_t state = 0x9E3779B97F4A7C15ull * (t + 1), operations = 0, found = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 256; ++i) {
+                    state ^= state << 13;
+                    state ^= state >> 7;
+                    state ^= state << 17;
+                    // The key comes from the high bits and the operation from the low ones,
+                    // so puts land on every key, not only on keys that are multiples of 10
+                    const uint64_t key = (state >> 32) % key_count;
+                    if (state % 10 == 0) {
+                        map.put(key, state);
+                    } else {
+                        found += map.get(key).has_value() ? 1 : 0;
+                    }
+                }
+                operations += 256;
+            }
+            total += operations + (found == 0 ? 1 : 0); // Keeps the gets from being optimized out
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    running = false;
+    for (std::thread& t : workers) {
+        t.join();
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total.load() / elapsed;
+}
+
+void run_bench(int max_threads, double seconds) {
+    const uint64_t key_count = 1 << 20;
+    ConcurrentHashMap<uint64_t, uint64_t> striped(256);
+    ConcurrentHashMap<uint64_t, uint64_t> single_lock(1);
+    for (uint64_t k = 0; k < key_count; ++k) {
+        striped.put(k, k);
+        single_lock.put(k, k);
+    }
+    std::cout << "\n--- 90% get / 10% put on " << key_count << " keys (Mops/s) ---" << std::endl;
+    std::cout << "threads   256 shards   scaling   1 shard" << std::endl;
+    double base = 0;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        const double rate = measureMix(striped, key_count, threads, seconds);
+        const double locked = measureMix(single_lock, key_count, threads, seconds);
+        if (threads == 1) {
+            base = rate;
+        }
+        std::cout << "  " << std::setw(2) << threads << std::fixed << std::setprecision(2) << std::setw(13)
+                  << rate / 1e6 << std::setw(9) << rate / base << "x" << std::setw(10) << locked / 1e6 << std::endl;
+    }
+    std::cout << "(" << std::thread::hardware_concurrency() << " hardware threads)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    std::cout << "--- Differential test against std::unordered_map ---" << std::endl;
+    const int operations = 200000;
+    for (size_t shards : {1, 8}) {
+        std::cout << runDifferentialTest(operations, shards) << "/" << operations << " operations agree with "
+                  << shards << " shard(s)" << std::endl;
+    }
+    std::cout << "Concurrent writers and readers: " << (runConcurrentTest(4, 4, 50000) ? "ok" : "FAILED")
+              << std::endl;
+
+    if (!args.empty() && args[0] == "--bench") {
+        run_bench(args.size() > 1 ? std::stoi(args[1]) : 32, args.size() > 2 ? std::stod(args[2]) : 0.5);
+    }
+    return 0;
+}
@@ -0,0 +1,620 @@
+#pragma once
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "model_file.h"
+
+/**
+ * @struct BatchingOptions
+ * @brief Limits on how requests are grouped into micro-batches.
+ *
+ * A batch runs as soon as it holds max_batch_size requests, or once its oldest request has
+ * waited max_delay, whichever comes first. max_batch_size = 1 turns batching off.
+ */
+struct BatchingOptions {
+    size_t max_batch_size = 64;
+    std::chrono::microseconds max_delay{500};
+};
+
+/**
+ * @class LatencyStats
+ * @brief Request latencies and throughput of a running server.
+ *
+ * Keeps the latencies of the last WINDOW requests, so the percentiles follow the current
+ * load rather than the whole uptime, plus running totals for throughput and batch size.
+ */
+class LatencyStats {
+public:
+    static constexpr size_t WINDOW = 1 << 16;
+
+    struct Snapshot {
+        uint64_t requests = 0;
+        uint64_t batches = 0;
+        double mean_batch_size = 0.0;
+        double p50_us = 0.0;
+        double p99_us = 0.0;
+        double requests_per_second = 0.0; // Over the time since the server started.
+    };
+
+    LatencyStats() : start(std::chrono::steady_clock::now()) { window.reserve(WINDOW); }
+
+    // Records one batch: the latency of each request from its arrival to completion
+    void record(const std::chrono::steady_clock::time_point* arrivals, size_t count,
+                std::chrono::steady_clock::time_point completed) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < count; ++i) {
+            const double us = std::chrono::duration<double, std::micro>(completed - arrivals[i]).count();
+            if (window.size() < WINDOW) {
+                window.push_back(us);
+            } else {
+                window[next] = us;
+            }
+            next = (next + 1) % WINDOW;
+        }
+        requests += count;
+        ++batches;
+    }
+
+    Snapshot snapshot() const {
+        std::vector<double> sorted;
+        Snapshot s;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            sorted = window;
+            s.requests = requests;
+            s.batches = batches;
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        s.mean_batch_size = s.batches ? static_cast<double>(s.requests) / s.batches : 0.0;
+        s.requests_per_second = seconds > 0 ? s.requests / seconds : 0.0;
+        if (!sorted.empty()) {
+            s.p50_us = percentile(sorted, 0.50);
+            s.p99_us = percentile(sorted, 0.99);
+        }
+        return s;
+    }
+
+    // The snapshot as one line of key=value pairs, as the STATS request returns it
+    std::string to_string() const {
+        const Snapshot s = snapshot();
+        std::ostringstream out;
+        out << "requests=" << s.requests << " batches=" << s.batches << " mean_batch=" << s.mean_batch_size
+            << " p50_us=" << s.p50_us << " p99_us=" << s.p99_us << " throughput_rps=" << s.requests_per_second;
+        return out.str();
+    }
+
+private:
+    static double percentile(std::vector<double>& values, double q) {
+        const size_t k = std::min(values.size() - 1, static_cast<size_t>(q * values.size()));
+        std::nth_element(values.begin(), values.begin() + k, values.end());
+        return values[k];
+    }
+
+    mutable std::mutex mutex;
+    std::vector<double> window; // Ring buffer of the last WINDOW latencies in microseconds.
+    size_t next = 0;
+    uint64_t requests = 0;
+    uint64_t batches = 0;
+    std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * @class DynamicBatcher
+ * @brief Collects concurrent predict requests into micro-batches for one batched predict.
+ *
+ * Any number of threads call predict(); each blocks until its result is ready. A single
+ * batcher thread takes the waiting requests, up to max_batch_size at a time, gathers their
+ * features into one contiguous matrix and runs MappedModel::predict_batch on it, so the
+ * model's weights are streamed through the caches once per batch instead of once per
+ * request. When requests arrive faster than one predict takes, batches fill up on their
+ * own and no request waits for the delay; under light load a request waits at most
+ * max_delay for company.
+ */
+class DynamicBatcher {
+public:
+    DynamicBatcher(const MappedModel& model, BatchingOptions options)
+        : model(model), options(options) {
+        this->options.max_batch_size = std::max<size_t>(this->options.max_batch_size, 1);
+        worker = std::thread([this] { batch_loop(); });
+    }
+
+    ~DynamicBatcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        work_ready.notify_one();
+        worker.join();
+    }
+
+    DynamicBatcher(const DynamicBatcher&) = delete;
+    DynamicBatcher& operator=(const DynamicBatcher&) = delete;
+
+    /**
+     * @brief Runs one sample through the model as part of the next batch.
+     * @param features model.num_inputs() values.
+     * @param out Receives model.num_outputs() values.
+     * @return false if the batcher is shutting down and the request was not run.
+     */
+    bool predict(const double* features, double* out) {
+        Request request;
+        request.features = features;
+        request.out = out;
+        request.arrival = std::chrono::steady_clock::now();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (stopping) {
+            return false;
+        }
+        pending.push_back(&request);
+        // The batcher only needs waking for the first request and for a full batch
+        if (pending.size() == 1 || pending.size() >= options.max_batch_size) {
+            work_ready.notify_one();
+        }
+        request.finished.wait(lock, [&request] { return request.done; });
+        return true;
+    }
+
+    const LatencyStats& stats() const { return latency; }
+
+private:
+    // Lives on the stack of the thread that called predict until done is set
+    struct Request {
+        const double* features;
+        double* out;
+        std::chrono::steady_clock::time_point arrival;
+        bool done = false;
+        std::condition_variable finished;
+    };
+
+    void batch_loop() {
+        const size_t n_in = model.num_inputs();
+        const size_t n_out = model.num_outputs();
+        std::vector<Request*> batch;
+        std::vector<double> inputs, outputs;
+        std::vector<std::chrono::steady_clock::time_point> arrivals;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            work_ready.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) {
+                return; // Stopping, and every accepted request has been answered
+            }
+            // Give the batch until its oldest request's deadline to fill up
+            const auto deadline = pending.front()->arrival + options.max_delay;
+            work_ready.wait_until(lock, deadline,
+                                  [this] { return stopping || pending.size() >= options.max_batch_size; });
+
+            const size_t rows = std::min(pending.size(), options.max_batch_size);
+            batch.assign(pending.begin(), pending.begin() + rows);
+            pending.erase(pending.begin(), pending.begin() + rows);
+            lock.unlock();
+
+            inputs.resize(rows * n_in);
+            outputs.resize(rows * n_out);
+            arrivals.resize(rows);
+            for (size_t r = 0; r < rows; ++r) {
+                std::copy(batch[r]->features, batch[r]->features + n_in, inputs.data() + r * n_in);
+                arrivals[r] = batch[r]->arrival;
+            }
+            model.predict_batch(inputs.data(), rows, outputs.data());
+            for (size_t r = 0; r < rows; ++r) {
+                std::copy(outputs.data() + r * n_out, outputs.data() + (r + 1) * n_out, batch[r]->out);
+            }
+            latency.record(arrivals.data(), rows, std::chrono::steady_clock::now());
+
+            lock.lock();
+            for (Request* request : batch) {
+                request->done = true;
+                request->finished.notify_one();
+            }
+        }
+    }
+
+    const MappedModel& model;
+    BatchingOptions options;
+    LatencyStats latency;
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::deque<Request*> pending;
+    bool stopping = false;
+    std::thread worker;
+};
+
+/**
+ * Wire protocol shared by InferenceServer and InferenceClient. Every message is a frame of
+ * two little-endian 32-bit words followed by a payload:
+ *
+ *     request:  type (PREDICT or STATS), count, then count doubles for PREDICT
+ *     response: status (OK or ERROR), count, then count doubles for PREDICT or count bytes
+ *               of text for STATS and for errors
+ *
+ * A connection carries any number of requests one after another.
+ */
+namespace inference_protocol {
+
+constexpr uint32_t PREDICT = 0;
+constexpr uint32_t STATS = 1;
+constexpr uint32_t OK = 0;
+constexpr uint32_t ERROR = 1;
+
+// Largest payload accepted, so a bad count cannot make the server allocate without bound
+constexpr uint32_t MAX_PAYLOAD_BYTES = 64 << 20;
+
+// Reads exactly size bytes; false on end of stream or error
+inline bool read_full(int fd, void* data, size_t size) {
+    char* p = static_cast<char*>(data);
+    while (size > 0) {
+        const ssize_t got = ::recv(fd, p, size, 0);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        p += got;
+        size -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+// Writes exactly size bytes; false if the peer has gone
+inline bool write_full(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t sent = ::send(fd, p, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        p += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+// Sends a frame header and its payload with one write
+inline bool write_frame(int fd, uint32_t word0, uint32_t count, const void* payload, size_t payload_bytes) {
+    thread_local std::vector<char> frame;
+    frame.resize(8 + payload_bytes);
+    std::memcpy(frame.data(), &word0, 4);
+    std::memcpy(frame.data() + 4, &count, 4);
+    if (payload_bytes > 0) {
+        std::memcpy(frame.data() + 8, payload, payload_bytes);
+    }
+    return write_full(fd, frame.data(), frame.size());
+}
+
+} // namespace inference_protocol
+
+/**
+ * @class InferenceServer
+ * @brief Serves a MappedModel over loopback TCP or a Unix socket, batching requests.
+ *
+ * One thread accepts connections and each connection gets a thread that reads requests
+ * and hands them to a shared DynamicBatcher, so concurrent clients end up in the same
+ * batches. Connections are expected to be few and long-lived (one per client process or
+ * worker), which is what makes a thread per connection affordable here.
+ */
+class InferenceServer {
+public:
+    /**
+     * @brief Starts serving on 127.0.0.1:port. Port 0 picks a free port; see port().
+     *
+     * Throws std::runtime_error if the socket cannot be set up.
+     */
+    static std::unique_ptr<InferenceServer> listen_tcp(const MappedModel& model, uint16_t port,
+                                                       BatchingOptions options) {
+        const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw std::runtime_error(std::string("Cannot create socket: ") + std::strerror(errno));
+        }
+        const int yes = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        bind_and_listen(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address), "127.0.0.1:" + std::to_string(port));
+        socklen_t length = sizeof(address);
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+        return std::unique_ptr<InferenceServer>(new InferenceServer(model, options, fd, ntohs(address.sin_port), ""));
+    }
+
+    /**
+     * @brief Starts serving on a Unix socket at path, replacing a stale socket file.
+     *
+     * Throws std::runtime_error if the socket cannot be set up.
+     */
+    static std::unique_ptr<InferenceServer> listen_unix(const MappedModel& model, const std::string& path,
+                                                        BatchingOptions options) {
+        sockaddr_un address{};
+        if (path.size() >= sizeof(address.sun_path)) {
+            throw std::runtime_error("Socket path too long: " + path);
+        }
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw std::runtime_error(std::string("Cannot create socket: ") + std::strerror(errno));
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        ::unlink(path.c_str());
+        bind_and_listen(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address), path);
+        return std::unique_ptr<InferenceServer>(new InferenceServer(model, options, fd, 0, path));
+    }
+
+    // Stops accepting, closes every connection and waits for the threads to finish
+    ~InferenceServer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            for (const Connection& connection : connections) {
+                ::shutdown(connection.fd, SHUT_RDWR);
+            }
+        }
+        ::shutdown(listen_fd, SHUT_RDWR);
+        acceptor.join();
+        ::close(listen_fd);
+        for (Connection& connection : connections) {
+            connection.thread.join();
+            ::close(connection.fd);
+        }
+        if (!unix_path.empty()) {
+            ::unlink(unix_path.c_str());
+        }
+    }
+
+    InferenceServer(const InferenceServer&) = delete;
+    InferenceServer& operator=(const InferenceServer&) = delete;
+
+    uint16_t port() const { return tcp_port; }
+    const LatencyStats& stats() const { return batcher.stats(); }
+
+private:
+    struct Connection {
+        int fd;
+        std::thread thread;
+        bool finished = false; // Set by the connection's thread as it exits.
+    };
+
+    static void bind_and_listen(int fd, const sockaddr* address, socklen_t length, const std::string& name) {
+        if (::bind(fd, address, length) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+            const int error = errno;
+            ::close(fd);
+            throw std::runtime_error("Cannot listen on " + name + ": " + std::strerror(error));
+        }
+    }
+
+    InferenceServer(const MappedModel& model, BatchingOptions options, int listen_fd, uint16_t tcp_port,
+                    std::string unix_path)
+        : model(model), batcher(model, options), listen_fd(listen_fd), tcp_port(tcp_port),
+          unix_path(std::move(unix_path)) {
+        acceptor = std::thread([this] { accept_loop(); });
+    }
+
+    void accept_loop() {
+        for (;;) {
+            const int fd = ::accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                return; // The listening socket was shut down
+            }
+            const int yes = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes)); // Fails harmlessly on Unix sockets
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                ::close(fd);
+                return;
+            }
+            // Clean up after clients that have hung up, so their sockets do not pile up
+            for (auto it = connections.begin(); it != connections.end();) {
+                if (it->finished) {
+                    it->thread.join();
+                    ::close(it->fd);
+                    it = connections.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            connections.emplace_back();
+            Connection& connection = connections.back();
+            connection.fd = fd;
+            connection.thread = std::thread([this, &connection] {
+                serve(connection.fd);
+                std::lock_guard<std::mutex> lock(mutex);
+                connection.finished = true;
+            });
+        }
+    }
+
+    // Answers requests on one connection until the client hangs up or the server stops
+    void serve(int fd) {
+        namespace protocol = inference_protocol;
+        const size_t n_in = model.num_inputs();
+        const size_t n_out = model.num_outputs();
+        std::vector<double> features, out(n_out);
+        uint32_t header[2];
+        while (protocol::read_full(fd, header, sizeof(header))) {
+            if (header[0] == protocol::STATS) {
+                const std::string text = batcher.stats().to_string();
+                if (!protocol::write_frame(fd, protocol::OK, static_cast<uint32_t>(text.size()), text.data(),
+                                           text.size())) {
+                    return;
+                }
+                continue;
+            }
+            if (header[0] != protocol::PREDICT || header[1] > protocol::MAX_PAYLOAD_BYTES / sizeof(double)) {
+                const std::string text = "malformed request";
+                protocol::write_frame(fd, protocol::ERROR, static_cast<uint32_t>(text.size()), text.data(),
+                                      text.size());
+                return; // The stream cannot be resynchronised
+            }
+            features.resize(header[1]);
+            if (!protocol::read_full(fd, features.data(), features.size() * sizeof(double))) {
+                return;
+            }
+            if (features.size() != n_in) {
+                const std::string text = "expected " + std::to_string(n_in) + " features";
+                if (!protocol::write_frame(fd, protocol::ERROR, static_cast<uint32_t>(text.size()), text.data(),
+                                           text.size())) {
+                    return;
+                }
+                continue;
+            }
+            if (!batcher.predict(features.data(), out.data()) ||
+                !protocol::write_frame(fd, protocol::OK, static_cast<uint32_t>(n_out), out.data(),
+                                       n_out * sizeof(double))) {
+                return;
+            }
+        }
+    }
+
+    const MappedModel& model;
+    DynamicBatcher batcher;
+    int listen_fd;
+    uint16_t tcp_port;
+    std::string unix_path;
+    std::mutex mutex; // Guards connections and stopping.
+    std::list<Connection> connections; // A list, so the references the threads hold stay valid.
+    bool stopping = false;
+    std::thread acceptor;
+};
+
+/**
+ * @class InferenceClient
+ * @brief A blocking client for InferenceServer: one connection, one request at a time.
+ *
+ * Throws std::runtime_error if the connection fails or breaks, and when the server answers
+ * a request with an error.
+ */
+class InferenceClient {
+public:
+    static InferenceClient connect_tcp(uint16_t port) {
+        const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            const int error = errno;
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            throw std::runtime_error("Cannot connect to 127.0.0.1:" + std::to_string(port) + ": " + std::strerror(error));
+        }
+        const int yes = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        return InferenceClient(fd);
+    }
+
+    static InferenceClient connect_unix(const std::string& path) {
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            const int error = errno;
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            throw std::runtime_error("Cannot connect to " + path + ": " + std::strerror(error));
+        }
+        return InferenceClient(fd);
+    }
+
+    ~InferenceClient() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    InferenceClient(InferenceClient&& other) noexcept : fd(other.fd) { other.fd = -1; }
+    InferenceClient& operator=(InferenceClient&& other) noexcept {
+        if (this != &other) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            fd = other.fd;
+            other.fd = -1;
+        }
+        return *this;
+    }
+
+    // Sends one sample and returns the model's outputs for it
+    std::vector<double> predict(const std::vector<double>& features) {
+        namespace protocol = inference_protocol;
+        if (!protocol::write_frame(fd, protocol::PREDICT, static_cast<uint32_t>(features.size()), features.data(),
+                                   features.size() * sizeof(double))) {
+            throw std::runtime_error("Connection to the inference server lost");
+        }
+        const uint32_t count = read_response_header();
+        std::vector<double> out(count);
+        if (!protocol::read_full(fd, out.data(), count * sizeof(double))) {
+            throw std::runtime_error("Connection to the inference server lost");
+        }
+        return out;
+    }
+
+    // The server's LatencyStats line
+    std::string stats() {
+        namespace protocol = inference_protocol;
+        if (!protocol::write_frame(fd, protocol::STATS, 0, nullptr, 0)) {
+            throw std::runtime_error("Connection to the inference server lost");
+        }
+        return read_text(read_response_header());
+    }
+
+private:
+    explicit InferenceClient(int fd) : fd(fd) {}
+
+    // Reads a response header, turning an error response into an exception
+    uint32_t read_response_header() {
+        namespace protocol = inference_protocol;
+        uint32_t header[2];
+        if (!protocol::read_full(fd, header, sizeof(header))) {
+            throw std::runtime_error("Connection to the inference server lost");
+        }
+        if (header[0] != protocol::OK) {
+            throw std::runtime_error("Inference server error: " + read_text(header[1]));
+        }
+        return header[1];
+    }
+
+    std::string read_text(uint32_t size) {
+        if (size > inference_protocol::MAX_PAYLOAD_BYTES) {
+            throw std::runtime_error("Malformed response from the inference server");
+        }
+        std::string text(size, '\0');
+        if (!inference_protocol::read_full(fd, &text[0], size)) {
+            throw std::runtime_error("Connection to the inference server lost");
+        }
+        return text;
+    }
+
+    int fd;
+};
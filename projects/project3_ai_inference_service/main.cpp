@@ -0,0 +1,204 @@
+#include <chrono>
+#include <csignal>
+#include <cstdio>     // For std::remove
+#include <filesystem> // For std::filesystem::temp_directory_path
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "inference_server.h"
+#include "mlp.h"
+#include "model_file.h"
+
+// Load test (run with --bench [clients] [requests per client]): serves a random
+// 64-256-256-1 MLP on a Unix socket and has every client send its requests back to back,
+// with batching off and with batches of up to 16 and 64. Every response is checked against the
+// model's own prediction for that sample.
+void run_bench(size_t clients, size_t requests) {
+    const size_t num_inputs = 64;
+    MLP mlp({num_inputs, 256, 256, 1}, MLP::Activation::ReLU, 0.1, 21);
+    const std::string dir = std::filesystem::temp_directory_path().string();
+    const std::string model_path = dir + "/inference_bench.pmf";
+    const std::string socket_path = dir + "/inference_bench.sock";
+    MappedModel::write(model_path, mlp);
+    MappedModel model(model_path);
+
+    std::mt19937 gen(4);
+    std::uniform_real_distribution<> dis(-1.0, 1.0);
+    const size_t samples = 256;
+    std::vector<double> features(samples * num_inputs), expected(samples);
+    for (double& x : features) x = dis(gen);
+    model.predict_batch(features.data(), samples, expected.data());
+
+    std::cout << clients << " clients x " << requests << " requests, model " << num_inputs << "-256-256-1"
+              << std::endl;
+    std::cout << std::setw(9) << "max_batch" << std::setw(14) << "max_delay_us" << std::setw(12) << "requests/s"
+              << std::setw(12) << "mean_batch" << std::setw(8) << "p50_us" << std::setw(8) << "p99_us" << std::setw(12)
+              << "correct" << std::endl;
+    for (size_t max_batch : {size_t{1}, size_t{16}, size_t{64}}) {
+        BatchingOptions options;
+        options.max_batch_size = max_batch;
+        options.max_delay = std::chrono::microseconds(200);
+        auto server = InferenceServer::listen_unix(model, socket_path, options);
+
+        std::vector<size_t> correct(clients, 0);
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t c = 0; c < clients; ++c) {
+            threads.emplace_back([&, c] {
+                InferenceClient client = InferenceClient::connect_unix(socket_path);
+                for (size_t i = 0; i < requests; ++i) {
+                    const size_t s = (c * requests + i) % samples;
+                    const std::vector<double> row(features.begin() + s * num_inputs,
+                                                  features.begin() + (s + 1) * num_inputs);
+                    correct[c] += client.predict(row)[0] == expected[s];
+                }
+            });
+        }
+        for (std::thread& t : threads) {
+            t.join();
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const LatencyStats::Snapshot s = server->stats().snapshot();
+        size_t total_correct = 0;
+        for (size_t n : correct) {
+            total_correct += n;
+        }
+        std::cout << std::setw(9) << max_batch << std::setw(14) << options.max_delay.count() << std::setw(12)
+                  << static_cast<long long>(clients * requests / seconds) << std::setw(12) << std::fixed
+                  << std::setprecision(2) << s.mean_batch_size << std::defaultfloat << std::setw(8)
+                  << static_cast<long long>(s.p50_us) << std::setw(8) << static_cast<long long>(s.p99_us)
+                  << std::setw(12)
+                  << (std::to_string(total_correct) + "/" + std::to_string(clients * requests)) << std::endl;
+    }
+    std::remove(model_path.c_str());
+}
+
+void print_usage() {
+    std::cerr << "Usage:\n"
+              << "  inference_server --model FILE [--tcp PORT | --unix PATH] [--max-batch N] [--max-delay-us N]\n"
+              << "  inference_server --bench [clients] [requests per client]\n"
+              << "FILE is a model saved with MappedModel::write. Serves on 127.0.0.1:8500 by default\n"
+              << "(--tcp 0 picks a free port) and prints its statistics when stopped with Ctrl-C.\n"
+              << "PORT is 0-65535, --max-batch at least 1, --max-delay-us at least 0, and the\n"
+              << "--bench counts at least 1." << std::endl;
+}
+
+// Command-line settings of the server, as parsed; main checks their ranges
+struct ServerOptions {
+    std::string model_path;
+    std::string unix_path;
+    long port = 8500;
+    long max_batch = 64;
+    long max_delay_us = 500;
+};
+
+// Fills options from --name value pairs. Returns false on an unknown option, a missing
+// value or a value that is not a number
+bool parse_args(const std::vector<std::string>& args, ServerOptions& options) {
+    if (args.size() % 2 != 0) {
+        return false;
+    }
+    try {
+        for (size_t i = 0; i + 1 < args.size(); i += 2) {
+            if (args[i] == "--model") {
+                options.model_path = args[i + 1];
+            } else if (args[i] == "--tcp") {
+                options.port = std::stol(args[i + 1]);
+            } else if (args[i] == "--unix") {
+                options.unix_path = args[i + 1];
+            } else if (args[i] == "--max-batch") {
+                options.max_batch = std::stol(args[i + 1]);
+            } else if (args[i] == "--max-delay-us") {
+                options.max_delay_us = std::stol(args[i + 1]);
+            } else {
+                return false;
+            }
+        }
+    } catch (const std::invalid_argument&) {
+        return false;
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+    return true;
+}
+
+// Reads the optional counts after --bench. Returns false if there are too many or one is
+// not a positive number
+bool parse_bench_args(const std::vector<std::string>& args, long& clients, long& requests) {
+    if (args.size() > 3) {
+        return false;
+    }
+    try {
+        if (args.size() > 1) {
+            clients = std::stol(args[1]);
+        }
+        if (args.size() > 2) {
+            requests = std::stol(args[2]);
+        }
+    } catch (const std::invalid_argument&) {
+        return false;
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+    return clients > 0 && requests > 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (!args.empty() && args[0] == "--bench") {
+        long clients = 32, requests = 2000;
+        if (!parse_bench_args(args, clients, requests)) {
+            print_usage();
+            return 1;
+        }
+        run_bench(static_cast<size_t>(clients), static_cast<size_t>(requests));
+        return 0;
+    }
+
+    ServerOptions settings;
+    if (!parse_args(args, settings) || settings.model_path.empty() || settings.port < 0 || settings.port > 65535 ||
+        settings.max_batch < 1 || settings.max_delay_us < 0) {
+        print_usage();
+        return 1;
+    }
+    const std::string& model_path = settings.model_path;
+    const std::string& unix_path = settings.unix_path;
+    const uint16_t port = static_cast<uint16_t>(settings.port);
+    BatchingOptions options;
+    options.max_batch_size = static_cast<size_t>(settings.max_batch);
+    options.max_delay = std::chrono::microseconds(settings.max_delay_us);
+
+    // Block the stop signals before any thread starts, so only sigwait below receives them
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+
+    try {
+        auto load_start = std::chrono::steady_clock::now();
+        MappedModel model(model_path);
+        const double load_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load_start).count();
+        auto server = unix_path.empty() ? InferenceServer::listen_tcp(model, port, options)
+                                        : InferenceServer::listen_unix(model, unix_path, options);
+        std::cout << "Serving " << model_path << " (" << model.num_inputs() << " inputs, " << model.num_layers()
+                  << " layers, loaded in " << load_ms << " ms) on "
+                  << (unix_path.empty() ? "127.0.0.1:" + std::to_string(server->port()) : unix_path)
+                  << ", max batch " << options.max_batch_size << ", max delay " << options.max_delay.count()
+                  << " us" << std::endl;
+
+        int signal = 0;
+        sigwait(&stop_signals, &signal);
+        std::cout << server->stats().to_string() << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
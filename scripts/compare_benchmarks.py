@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""Compares two Google Benchmark JSON files and fails on regressions.
+
+Usage: compare_benchmarks.py BASELINE CURRENT [--threshold PERCENT]
+
+Benchmarks are matched by name. When the runs were repeated, the median aggregate is
+compared; otherwise the single measurement. A benchmark whose real time grew by more than
+the threshold counts as a regression and makes the script exit with status 1. Benchmarks
+that exist on only one side are listed but do not fail the comparison.
+"""
+
+import argparse
+import json
+import sys
+
+TO_NANOSECONDS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path):
+    with open(path) as f:
+        entries = json.load(f)["benchmarks"]
+    medians = {}
+    singles = {}
+    for entry in entries:
+        if entry.get("error_occurred"):
+            continue
+        time = entry["real_time"] * TO_NANOSECONDS[entry.get("time_unit", "ns")]
+        if entry.get("run_type") == "aggregate":
+            if entry.get("aggregate_name") == "median":
+                medians[entry["run_name"]] = time
+        else:
+            singles.setdefault(entry.get("run_name", entry["name"]), time)
+    singles.update(medians)
+    return singles
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed slowdown in percent (default 10)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    regressions = []
+    width = max((len(name) for name in list(current) + list(baseline)), default=10)
+    print(f"{'benchmark':<{width}}  {'baseline':>12}  {'current':>12}  {'change':>8}")
+    for name, time in current.items():
+        if name not in baseline:
+            print(f"{name:<{width}}  {'-':>12}  {time:>10.0f}ns  {'new':>8}")
+            continue
+        change = (time / baseline[name] - 1.0) * 100.0
+        marker = ""
+        if change > args.threshold:
+            regressions.append(name)
+            marker = "  REGRESSION"
+        print(f"{name:<{width}}  {baseline[name]:>10.0f}ns  {time:>10.0f}ns  {change:>+7.1f}%{marker}")
+    for name in baseline:
+        if name not in current:
+            print(f"{name:<{width}}  missing from the current run")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) slower than the baseline by more than "
+              f"{args.threshold:g}%:", file=sys.stderr)
+        for name in regressions:
+            print(f"  {name}", file=sys.stderr)
+        return 1
+    print(f"\nNo regressions beyond {args.threshold:g}%.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
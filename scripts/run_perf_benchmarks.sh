@@ -0,0 +1,48 @@
+#!/usr/bin/env bash
+# Builds the benchmarks target in Release mode, runs it with JSON output and compares the
+# result against a stored baseline. Exits non-zero when any benchmark got slower than the
+# threshold allows.
+#
+# Usage: scripts/run_perf_benchmarks.sh [--update-baseline] [extra Google Benchmark flags]
+#
+# Environment:
+#   BUILD_DIR         build directory                     (default: build-perf)
+#   BASELINE          baseline JSON to compare against    (default: benchmarks/baseline.json)
+#   PERF_THRESHOLD    allowed slowdown in percent         (default: 10)
+#   PERF_REPETITIONS  repetitions per benchmark; the median is compared (default: 5)
+#
+# The first run, or a run with --update-baseline, stores its results as the baseline.
+# Baselines only compare meaningfully on the machine that recorded them.
+
+set -euo pipefail
+
+ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BUILD_DIR="${BUILD_DIR:-$ROOT/build-perf}"
+BASELINE="${BASELINE:-$ROOT/benchmarks/baseline.json}"
+PERF_THRESHOLD="${PERF_THRESHOLD:-10}"
+PERF_REPETITIONS="${PERF_REPETITIONS:-5}"
+
+UPDATE_BASELINE=0
+if [[ "${1:-}" == "--update-baseline" ]]; then
+    UPDATE_BASELINE=1
+    shift
+fi
+
+cmake -S "$ROOT" -B "$BUILD_DIR" -DCMAKE_BUILD_TYPE=Release >/dev/null
+cmake --build "$BUILD_DIR" --target benchmarks -j"$(nproc)"
+
+RESULT="$BUILD_DIR/benchmark_results.json"
+"$BUILD_DIR/benchmarks/benchmarks" \
+    --benchmark_out="$RESULT" \
+    --benchmark_out_format=json \
+    --benchmark_repetitions="$PERF_REPETITIONS" \
+    --benchmark_report_aggregates_only=true \
+    "$@"
+
+if [[ $UPDATE_BASELINE -eq 1 || ! -f "$BASELINE" ]]; then
+    cp "$RESULT" "$BASELINE"
+    echo "Stored baseline in $BASELINE"
+    exit 0
+fi
+
+python3 "$ROOT/scripts/compare_benchmarks.py" "$BASELINE" "$RESULT" --threshold "$PERF_THRESHOLD"